@@ -0,0 +1,236 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <functional>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/bench_harness.hpp"
+#include "utils/device_peaks.hpp"
+#include "utils/cpu_gemm.hpp"
+
+using namespace std;
+
+// Usage: bench [--device <spec>] [--filter matmul] [--sizes 512,1024] [--reps 20] [--warmup 3]
+//              [--json run.json] [--csv history.csv] [--label $(git rev-parse --short HEAD)] [--list]
+// One entry point for the kernel benchmarks. Matmul sizes are N for an N x N x N problem;
+// memory sizes are float element counts (suffixes K / M allowed). A --sizes entry a benchmark
+// can't take (e.g. 16M as a matmul N) is skipped for that benchmark with the reason.
+// With no OpenCL device (or --backend host) only matmul/cpu is registered, so the run still
+// produces a checked, comparable row on GPU-less machines.
+
+static void printDetails(const DeviceInfo& info, const BenchOptions& opt) {
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << info.name << endl;
+    cout << "Driver Version     : " << info.driver << endl;
+    cout << "Max Compute Units  : " << info.computeUnits << endl;
+    cout << "Warmup / Reps      : " << opt.warmup << " / " << opt.reps << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+}
+
+// Host backend on the matmul problems (utils/cpu_gemm.hpp); %Roof is against the OpenCL device, if any
+static void addCpuMatmul(BenchRegistry& registry, const vector<size_t>& sizes, function<string(size_t)> valid) {
+    registry.add("matmul/cpu", sizes, [](size_t size, const BenchOptions& o) {
+        int N = (int)size;
+        vector<float> A((size_t)N * N), B((size_t)N * N), C((size_t)N * N);
+        fillGemmInputs(A, B);
+
+        BenchResult r;
+        r.stats = timeHost(o, [&] { cpuGemm(A.data(), B.data(), C.data(), N, N, N); });
+        r.flops = 2.0 * N * N * N;
+        r.bytes = 3.0 * sizeof(float) * N * N;
+        if (!spotCheckGemm(A.data(), B.data(), C.data(), N, N, N)) r.result = "FAIL";
+        return r;
+    }, valid);
+}
+
+// --list, or run everything selected and write the JSON / CSV records. Exit code 1 on any FAIL.
+static int runAndReport(BenchRegistry& registry, const BenchOptions& opt, const DeviceInfo& info) {
+    if (opt.list) {
+        for (const auto& b : registry.benchmarks()) cout << b.name << endl;
+        return 0;
+    }
+
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    vector<BenchResult> results = registry.run(opt);
+
+    if (!opt.jsonPath.empty() && writeBenchJSON(opt.jsonPath, opt.label, info, opt, results))
+        cout << "JSON written to " << opt.jsonPath << endl;
+    if (!opt.csvPath.empty() && writeBenchCSV(opt.csvPath, opt.label, info, results))
+        cout << "CSV appended to " << opt.csvPath << endl;
+
+    bool failed = any_of(results.begin(), results.end(), [](const BenchResult& r) { return r.result == "FAIL"; });
+    return failed ? 1 : 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions opt = parseBenchOptions(argc, argv);
+    vector<size_t> matmulSizes = {256, 512, 1024, 2048};
+
+    // --- Host Backend: no OpenCL device to measure, so only the host GEMM runs ---
+    if (selectGemmBackend(argc, argv) == GemmBackend::Host) {
+        DeviceInfo host;
+        host.name = string("Host CPU (cpuGemm, ") + cpuIsaName(detectCpuIsa()) + ")";
+        host.driver = "-";
+        host.key = "host";
+        host.computeUnits = (cl_uint)defaultThreadPool().size();
+        printDetails(host, opt);
+
+        BenchRegistry registry;
+        addCpuMatmul(registry, matmulSizes, [](size_t N) -> string { return N == 0 ? "matmul N must be positive" : ""; });
+        return runAndReport(registry, opt, host);
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+    DeviceInfo info = describeDevice(device);
+    size_t maxWGSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    size_t maxAlloc = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+    printDetails(info, opt);
+
+    // --- Build Section ---
+    string naiveSrc = readKernelFile("Vector_Foundations/kernels/naive_matmul.cl");
+    string sramSrc = readKernelFile("Vector_Foundations/kernels/matmul.cl");
+    string regSrc = readKernelFile("Vector_Foundations/kernels/register_matmul.cl");
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl");
+    string memSrc = readKernelFile("Hardware/kernels/memory_bench.cl");
+    cl::Program naiveProgram = buildProgram(context, device, naiveSrc);
+    cl::Program memProgram = buildProgram(context, device, memSrc);
+    TuningDB tuningDB;
+
+    BenchRegistry registry;
+
+    // Roofline from stream_probes (bandwidth alone from memory_benchmarking leaves %Roof blank)
+    DevicePeaks peaks;
+    if (loadDevicePeaks(info.key, peaks)) registry.setPeaks(peaks);
+
+    // --- Matmul: naive / SRAM tiled / register tiled (tiled kernels use the tuning database) ---
+    auto matmulValid = [maxAlloc](size_t N) -> string {
+        if (N == 0) return "matmul N must be positive";
+        if (N > 65536 || sizeof(float) * N * N > maxAlloc) return "N x N matrix exceeds CL_DEVICE_MAX_MEM_ALLOC_SIZE";
+        return "";
+    };
+    // gemm_nt takes B as [N][K]; it is uploaded transposed so every variant computes the same C = A * B
+    auto addMatmul = [&](const string& benchName, const string& kernelName, const string* src) {
+        registry.add(benchName, matmulSizes, [&, kernelName, src](size_t size, const BenchOptions& o) {
+            int N = (int)size;
+            vector<float> A((size_t)N * N), B((size_t)N * N), C((size_t)N * N);
+            fillGemmInputs(A, B);
+            cl::Buffer bufA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * A.size(), A.data());
+            vector<float> Bdev = B;
+            if (kernelName == "gemm_nt") {
+                for (int k = 0; k < N; k++)
+                    for (int n = 0; n < N; n++) Bdev[(size_t)n * N + k] = B[(size_t)k * N + n];
+            }
+            cl::Buffer bufB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * Bdev.size(), Bdev.data());
+            cl::Buffer bufC(context, CL_MEM_WRITE_ONLY, sizeof(float) * C.size());
+
+            cl::Kernel kernel;
+            cl::NDRange global(N, N), local = cl::NullRange;
+            if (src) {
+                TuneParams p = matmulParams(tuningDB, device, kernelName, N, N, N);
+                kernel = cl::Kernel(buildProgram(context, device, *src, buildOptions(p)), kernelName.c_str());
+                global = matmulGlobalSize(kernelName, p, N, N);
+                local = cl::NDRange(p.localX, p.localY);
+            } else {
+                kernel = cl::Kernel(naiveProgram, "naive_matmul");
+            }
+            kernel.setArg(0, bufA); kernel.setArg(1, bufB); kernel.setArg(2, bufC);
+            kernel.setArg(3, N); kernel.setArg(4, N); kernel.setArg(5, N);
+
+            BenchResult r;
+            r.stats = timeEvents(o, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &ev[0]);
+                return ev;
+            }, kernelName);
+            r.flops = 2.0 * N * N * N;
+            r.bytes = 3.0 * sizeof(float) * N * N;
+
+            queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+            if (!spotCheckGemm(A.data(), B.data(), C.data(), N, N, N)) r.result = "FAIL";
+            return r;
+        }, matmulValid);
+    };
+    addMatmul("matmul/naive", "naive_matmul", nullptr);
+    addMatmul("matmul/sram", "matmul", &sramSrc);
+    addMatmul("matmul/register", "register_matmul", &regSrc);
+    addMatmul("matmul/gemm", "gemm", &gemmSrc);
+    addMatmul("matmul/gemm_nt", "gemm_nt", &gemmSrc);
+
+    addCpuMatmul(registry, matmulSizes, matmulValid);
+
+    // --- Memory Tiers (memory_bench.cl): dependent-access loops, then streaming copy bandwidth ---
+    const int iterations = 1000;
+    size_t wg = min<size_t>(256, maxWGSize);
+    vector<size_t> memSizes = {1 << 20, 10000000 / wg * wg};
+    // Launches are rounded up to whole work-groups, so a size below one group measures something else
+    auto memValid = [maxAlloc](size_t group) {
+        return [maxAlloc, group](size_t n) -> string {
+            if (n < group) return "memory sizes are element counts, at least " + to_string(group);
+            if (sizeof(float) * n > maxAlloc) return "buffer exceeds CL_DEVICE_MAX_MEM_ALLOC_SIZE";
+            return "";
+        };
+    };
+    auto addMemoryTier = [&](const string& benchName, const string& kernelName, bool useLocal, double bytesPerIter) {
+        registry.add(benchName, memSizes, [&, kernelName, useLocal, bytesPerIter](size_t size, const BenchOptions& o) {
+            size_t n = roundUp(size, wg);
+            cl::Buffer data(context, CL_MEM_READ_WRITE, sizeof(float) * n);
+            queue.enqueueFillBuffer(data, 1.0f, 0, sizeof(float) * n);
+
+            cl::Kernel kernel(memProgram, kernelName.c_str());
+            kernel.setArg(0, data);
+            if (useLocal) {
+                kernel.setArg(1, cl::Local(wg * sizeof(float)));
+                kernel.setArg(2, iterations);
+            } else {
+                kernel.setArg(1, iterations);
+            }
+
+            BenchResult r;
+            r.stats = timeEvents(o, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(n), cl::NDRange(wg), nullptr, &ev[0]);
+                return ev;
+            }, kernelName);
+            r.flops = (double)n * iterations;  // One add per iteration
+            r.bytes = bytesPerIter * n * iterations;
+            r.result = "-";
+            return r;
+        }, memValid(wg));
+    };
+    addMemoryTier("memory/global", "benchmark_global", false, 3 * sizeof(float));   // 2 reads + 1 write
+    addMemoryTier("memory/local", "benchmark_local", true, 3 * sizeof(float));
+    addMemoryTier("memory/private", "benchmark_private", false, 0.0);
+
+    registry.add("memory/bandwidth", {1 << 20, 1 << 24, 1 << 26}, [&](size_t size, const BenchOptions& o) {
+        size_t n = roundUp(size, 4 * wg);
+        cl::Buffer in(context, CL_MEM_READ_ONLY, sizeof(float) * n);
+        cl::Buffer out(context, CL_MEM_WRITE_ONLY, sizeof(float) * n);
+        queue.enqueueFillBuffer(in, 1.0f, 0, sizeof(float) * n);
+
+        cl::Kernel kernel(memProgram, "benchmark_bandwidth");
+        kernel.setArg(0, in);
+        kernel.setArg(1, out);
+
+        BenchResult r;
+        r.stats = timeEvents(o, [&] {
+            vector<cl::Event> ev(1);
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(n / 4), cl::NullRange, nullptr, &ev[0]);
+            return ev;
+        }, "benchmark_bandwidth");
+        r.bytes = 2.0 * sizeof(float) * n;  // Read + write
+
+        vector<float> check(n);
+        queue.enqueueReadBuffer(out, CL_TRUE, 0, sizeof(float) * n, check.data());
+        r.result = all_of(check.begin(), check.end(), [](float v) { return v == 1.0f; }) ? "PASS" : "FAIL";
+        return r;
+    }, memValid(4 * wg));
+
+    return runAndReport(registry, opt, info);
+}
@@ -45,4 +45,12 @@ __kernel void benchmark_private(__global volatile float* data, int iterations) {
         val1 = force_math; 
     }
     data[id] = new_location;
-}
\ No newline at end of file
+}
+
+// 4. HRAM Bandwidth (STREAM-style copy, one float4 per work-item)
+// Unlike the loops above this is a single pass of independent, coalesced accesses,
+// so it measures sustainable bandwidth rather than dependent-access latency.
+__kernel void benchmark_bandwidth(__global const float4* in, __global float4* out) {
+    int id = get_global_id(0);
+    out[id] = in[id];
+}
@@ -0,0 +1,97 @@
+// Throughput and latency probes. Unlike memory_bench.cl (dependent read-modify-write loops, which
+// measure latency), every STREAM kernel here is one independent, coalesced pass, so the result
+// is sustainable bandwidth and can feed a roofline.
+//
+// Build options: -DVTYPE=float|float4|float8   element type of the STREAM kernels (default float4)
+//                -DHALF_STORAGE                arrays hold half, moved four at a time with
+//                                              vload_half4 / vstore_half4 (no cl_khr_fp16 needed)
+#ifdef HALF_STORAGE
+typedef half elem_t;
+#define LOAD(p, i) vload_half4(i, p)
+#define STORE(v, p, i) vstore_half4(v, i, p)
+#else
+#ifndef VTYPE
+#define VTYPE float4
+#endif
+typedef VTYPE elem_t;
+#define LOAD(p, i) ((p)[i])
+#define STORE(v, p, i) ((p)[i] = (v))
+#endif
+
+// 1. STREAM: one element (or four halfs) per work-item
+__kernel void stream_copy(__global const elem_t* a, __global elem_t* c) {
+    size_t i = get_global_id(0);
+    STORE(LOAD(a, i), c, i);
+}
+
+__kernel void stream_scale(__global elem_t* b, __global const elem_t* c, float s) {
+    size_t i = get_global_id(0);
+    STORE(s * LOAD(c, i), b, i);
+}
+
+__kernel void stream_add(__global const elem_t* a, __global const elem_t* b, __global elem_t* c) {
+    size_t i = get_global_id(0);
+    STORE(LOAD(a, i) + LOAD(b, i), c, i);
+}
+
+__kernel void stream_triad(__global elem_t* a, __global const elem_t* b, __global const elem_t* c, float s) {
+    size_t i = get_global_id(0);
+    STORE(LOAD(b, i) + s * LOAD(c, i), a, i);
+}
+
+// 2. Strided gather: neighbouring work-items read 'stride' floats apart (n = mask + 1, a power of two).
+// Past one cache line per work-item every access drags in a full line for 4 useful bytes.
+__kernel void strided_copy(__global const float* in, __global float* out, int stride, uint mask) {
+    size_t i = get_global_id(0);
+    out[i] = in[(i * stride) & mask];
+}
+
+// 3. Pointer chase: a single work-item follows a random cyclic permutation, so every load depends
+// on the previous one and nothing can be prefetched. Time / steps = load-to-use latency.
+__kernel void pointer_chase(__global const uint* next, __global uint* out, int steps) {
+    uint p = 0;
+    for (int i = 0; i < steps; i++) p = next[p];
+    out[0] = p;
+}
+
+// 4. Local-memory bank conflicts: work-item 'lid' reads word (lid * stride) of a local array.
+// Stride 1 is conflict-free; stride 2^k puts 2^k work-items of a wavefront on one bank; an odd
+// stride (e.g. the +1 padding in matmul.cl) spreads them out again.
+#ifndef LOCAL_WORDS
+#define LOCAL_WORDS 2048
+#endif
+__kernel void local_bank(__global float* out, int stride, int iterations) {
+    __local float buf[LOCAL_WORDS];
+    int lid = get_local_id(0);
+    for (int i = lid; i < LOCAL_WORDS; i += get_local_size(0)) buf[i] = (float)i;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // Every work-item advances by one word per step, which keeps the conflict degree constant
+    int idx = (lid * stride) & (LOCAL_WORDS - 1);
+    float acc = 0.0f;
+    for (int i = 0; i < iterations; i++) {
+        acc += buf[idx];
+        idx = (idx + 1) & (LOCAL_WORDS - 1);
+    }
+    out[get_global_id(0)] = acc;
+}
+
+// 5. Peak FP32: eight independent float4 mad chains per work-item, no memory traffic in the loop.
+// FLOPs per work-item = FLOP_ITERS * 8 chains * 4 lanes * 2.
+#ifndef FLOP_ITERS
+#define FLOP_ITERS 256
+#endif
+__kernel void peak_flops(__global float* out, float seed) {
+    float4 a0 = (float4)(seed + get_global_id(0) * 1.0e-7f);
+    float4 a1 = a0 + 0.1f, a2 = a0 + 0.2f, a3 = a0 + 0.3f;
+    float4 a4 = a0 + 0.4f, a5 = a0 + 0.5f, a6 = a0 + 0.6f, a7 = a0 + 0.7f;
+    float4 m = (float4)(0.999f), c = (float4)(0.001f);  // Converges to 1.0, never overflows
+
+    for (int i = 0; i < FLOP_ITERS; i++) {
+        a0 = mad(a0, m, c); a1 = mad(a1, m, c); a2 = mad(a2, m, c); a3 = mad(a3, m, c);
+        a4 = mad(a4, m, c); a5 = mad(a5, m, c); a6 = mad(a6, m, c); a7 = mad(a7, m, c);
+    }
+
+    float4 s = (a0 + a1) + (a2 + a3) + (a4 + a5) + (a6 + a7);
+    out[get_global_id(0)] = s.x + s.y + s.z + s.w;
+}
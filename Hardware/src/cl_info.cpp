@@ -4,6 +4,9 @@
 #include <vector>
 #include <string>
 #include <iomanip>
+#include "utils/cl_runtime.hpp"
+#include "utils/kernel_registry.hpp"
+#include "utils/shared_buffer.hpp"
 
 using namespace std;
 
@@ -12,7 +15,15 @@ void printRow(string label, string value) {
     cout << left << setw(32) << label << ": " << value << endl;
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // --kernels: list the kernel sources compiled into the binary and exit
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--kernels") {
+            printKernelRegistry();
+            return 0;
+        }
+    }
+
     // 1. Setup Platform
     vector<cl::Platform> platforms;
     cl::Platform::get(&platforms);
@@ -21,15 +32,8 @@ int main() {
         return 1;
     }
 
-    // 2. Setup Device (Selecting the first available GPU)
-    vector<cl::Device> devices;
-    platforms[0].getDevices(CL_DEVICE_TYPE_GPU, &devices);
-    if (devices.empty()) {
-        cout << "Error: No GPU Device Found on this platform!" << endl;
-        return 1;
-    }
-
-    cl::Device device = devices[0];
+    // 2. Setup Device (First GPU unless --device / OCL_DEVICE says otherwise)
+    cl::Device device = selectDevice(argc, argv);
 
     // --- Header ---
     cout << "==========================================================" << endl;
@@ -70,6 +74,10 @@ int main() {
     printRow("SRAM (Local Memory/Tile)", to_string(localMem / 1024) + " KB");
     printRow("Max Single Buffer Size", to_string(maxAlloc / (1024 * 1024)) + " MB");
     printRow("Unified Memory (UMA)", (unifiedMem ? "YES (Shared Host RAM)" : "NO (Discrete VRAM)"));
+    cl_device_svm_capabilities svmCaps = svmCapabilities(device);
+    printRow("Shared Virtual Memory (SVM)", (svmCaps & CL_DEVICE_SVM_FINE_GRAIN_BUFFER) ? "Fine-Grained"
+                                            : (svmCaps & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER) ? "Coarse-Grained" : "NO");
+    printRow("Host Buffer Mode", bufferModeName(chooseBufferMode(device)));
 
     // --- [3] VECTORIZATION & DATA TYPES ---
     cl_uint prefVecFloat = device.getInfo<CL_DEVICE_PREFERRED_VECTOR_WIDTH_FLOAT>();
@@ -5,33 +5,25 @@
 #include <fstream>
 #include <iomanip>
 #include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/device_peaks.hpp"
 using namespace std;
 
-int main(){
+int main(int argc, char** argv){
     //1. Platform setup
-    vector<cl::Platform> platforms;
-    cl::Platform::get(&platforms);
-    
-    vector<cl::Device> devices;
-    platforms[0].getDevices(CL_DEVICE_TYPE_GPU, &devices);
-    cl::Device device = devices[0];
+    cl::Device device = selectDevice(argc, argv);
 
     cl::Context context(device);
     cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
 
     //2. Load Kernels
-    string sourceCode = readKernelFile("Hardware\\kernels\\memory_bench.cl");
-    cl::Program::Sources sources(1, {sourceCode.c_str(), sourceCode.length()});
-    cl::Program program(context, sources);
-
-    if (program.build("-cl-std=CL2.0") != CL_SUCCESS) {
-        cout << "Error building: " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << endl;
-        return 1;
-    }
+    string sourceCode = readKernelFile("Hardware/kernels/memory_bench.cl");
+    cl::Program program = buildProgram(context, device, sourceCode);
 
     cl::Kernel k_global(program,"benchmark_global");
     cl::Kernel k_local(program,"benchmark_local");
     cl::Kernel k_private(program,"benchmark_private");
+    cl::Kernel k_bandwidth(program,"benchmark_bandwidth");
 
     // 3. Setup Data (10 Million Floats = ~40MB)
     int numElements = 10000000;
@@ -100,6 +92,15 @@ int main(){
     double t_sram = run_and_time(k_local,   "[2] SRAM (Local)",    "Shared Memory (On-Chip)", true);
     double t_priv = run_and_time(k_private, "[3] Registers (Priv)","ALU Registers (No Fetch)");
 
+    // --- Sustained Bandwidth (saved for the kernel benchmarks' "% of peak") ---
+    DevicePeaks peaks;
+    loadDevicePeaks(deviceKey(device), peaks);  // Keep the FLOP/s peak from stream_probes, if any
+    peaks.bandwidthGBs = measureCopyBandwidth(context, queue, k_bandwidth, numElements);
+    cout << left << setw(22) << "[4] HRAM Bandwidth" << " | "
+         << right << setw(8) << fixed << setprecision(2) << peaks.bandwidthGBs << " GB/s"
+         << "  ->  " << "Peak for memory-bound kernels" << endl;
+    saveDevicePeaks(deviceKey(device), peaks);
+
     // --- Print Dynamic Performance Analysis ---
     cout << "\n=====================================================================" << endl;
     cout << "  PERFORMANCE ANALYSIS:" << endl;
@@ -4,29 +4,22 @@
 #include <vector>
 #include <fstream>
 #include <iomanip>
+#include <algorithm>
 #include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/device_arena.hpp"
 
 using namespace std;
 
-int main() {
+int main(int argc, char** argv) {
     // 1. Platform & Device Setup
-    vector<cl::Platform> platforms;
-    cl::Platform::get(&platforms);
-    vector<cl::Device> devices;
-    platforms[0].getDevices(CL_DEVICE_TYPE_GPU, &devices);
-    cl::Device device = devices[0];
+    cl::Device device = selectDevice(argc, argv);
     cl::Context context(device);
     cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
 
     // 2. Load Kernels
-    string sourceCode = readKernelFile("Hardware\\kernels\\memory_bench.cl");
-    cl::Program::Sources sources(1, {sourceCode.c_str(), sourceCode.length()});
-    cl::Program program(context, sources);
-
-    if (program.build("-cl-std=CL2.0") != CL_SUCCESS) {
-        cout << "Error building: " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << endl;
-        return 1;
-    }
+    string sourceCode = readKernelFile("Hardware/kernels/memory_bench.cl");
+    cl::Program program = buildProgram(context, device, sourceCode);
 
     cl::Kernel k_global(program, "benchmark_global");
     cl::Kernel k_local(program, "benchmark_local");
@@ -38,6 +31,9 @@ int main() {
     vector<int> testSizes = {256000, 1024000, 2560000, 5120000, 10240000, 20480000}; 
     cl::NDRange localSize(256);
 
+    // One slab sized for the largest test; every size is carved out of it and handed back
+    DeviceArena arena(context, device, *max_element(testSizes.begin(), testSizes.end()) * sizeof(float));
+
     // 4. Setup CSV Output
     ofstream csvFile("benchmark_results.csv");
     csvFile << "Elements,HRAM_ms,SRAM_ms,Registers_ms\n";
@@ -78,7 +74,9 @@ int main() {
 
         // Allocate host and device memory for this specific size
         vector<float> hostData(numElements, 1.0f);
-        cl::Buffer deviceBuffer(context, CL_MEM_READ_WRITE | CL_MEM_COPY_HOST_PTR, bufferSize, hostData.data());
+        DeviceArena::Block block = arena.allocate(bufferSize);
+        cl::Buffer& deviceBuffer = block.buffer;
+        queue.enqueueWriteBuffer(deviceBuffer, CL_TRUE, 0, bufferSize, hostData.data());
         cl::NDRange globalSize(numElements);
 
         // Run benchmarks
@@ -90,10 +88,12 @@ int main() {
 
         // Write to CSV
         csvFile << numElements << "," << t_hram << "," << t_sram << "," << t_priv << "\n";
+        arena.release(block);
     }
 
     csvFile.close();
     cout << "\n> Experiments complete. Data saved to 'benchmark_results.csv'." << endl;
+    arena.printStats();
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <numeric>
+#include <random>
+#include <cstdint>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/bench_harness.hpp"
+#include "utils/device_peaks.hpp"
+#include "utils/quantize.hpp"
+
+using namespace std;
+
+// Usage: stream_probes [--device <spec>] [--sizes 32M] [--reps N] [--warmup N]
+// Bandwidth / latency probe suite (kernels/stream_probes.cl) and the device roofline derived
+// from it. --sizes sets the floats per STREAM array (default 32M, capped by max alloc).
+// The measured peaks are saved to device_peaks.csv for bench, gemv_bench and quant_matmul.
+
+int main(int argc, char** argv) {
+    BenchOptions opt = parseBenchOptions(argc, argv);
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+    cl_uint computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    size_t maxWGSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    cl_ulong maxAlloc = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+    cl_ulong localMem = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+
+    size_t n = opt.sizes.empty() ? ((size_t)1 << 25) : opt.sizes[0];
+    n = min<size_t>(n, maxAlloc / sizeof(float));
+    n = max<size_t>(n / 1024, 1) * 1024;  // Whole float8 / half4 items
+    size_t wg = min<size_t>(256, maxWGSize);
+
+    cout << "=====================================================================" << endl;
+    cout << "       BANDWIDTH & LATENCY PROBES                                    " << endl;
+    cout << "=====================================================================" << endl;
+    cout << "  Device       : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "  Array Size   : " << n / (1024 * 1024) << " M floats per STREAM array" << endl;
+    cout << "  Warmup/Reps  : " << opt.warmup << " / " << opt.reps << " (median reported)" << endl;
+    cout << "=====================================================================\n" << endl;
+
+    string src = readKernelFile("Hardware/kernels/stream_probes.cl");
+
+    // --- [1] STREAM: copy / scale / add / triad per element width ---
+    struct Width {
+        string name, options;
+        size_t elemBytes;  // Bytes per array element
+        size_t perItem;    // Array elements per work-item
+    };
+    vector<Width> widths = {{"float", "-DVTYPE=float", 4, 1},
+                            {"float4", "-DVTYPE=float4", 4, 4},
+                            {"float8", "-DVTYPE=float8", 4, 8},
+                            {"half", "-DHALF_STORAGE", 2, 4}};
+    double peakGBs = 0.0;
+
+    cout << "[1] STREAM" << endl;
+    cout << left << setw(10) << "Width" << setw(10) << "Kernel" << setw(12) << "Median(ms)"
+         << setw(10) << "GB/s" << "Result" << endl;
+    cout << string(50, '-') << endl;
+
+    for (const Width& w : widths) {
+        cl::Program program = buildProgram(context, device, src, "-cl-std=CL2.0 " + w.options);
+        size_t bytes = n * w.elemBytes;
+        cl::Buffer a(context, CL_MEM_READ_WRITE, bytes), b(context, CL_MEM_READ_WRITE, bytes), c(context, CL_MEM_READ_WRITE, bytes);
+        auto fill = [&](cl::Buffer& buf, float v) {
+            if (w.elemBytes == 2) queue.enqueueFillBuffer(buf, floatToHalf(v), 0, bytes);
+            else queue.enqueueFillBuffer(buf, v, 0, bytes);
+        };
+        fill(a, 1.0f); fill(b, 2.0f); fill(c, 0.0f);
+
+        float s = 3.0f;
+        cl::Kernel kCopy(program, "stream_copy"), kScale(program, "stream_scale"), kAdd(program, "stream_add"), kTriad(program, "stream_triad");
+        kCopy.setArg(0, a); kCopy.setArg(1, c);
+        kScale.setArg(0, b); kScale.setArg(1, c); kScale.setArg(2, s);
+        kAdd.setArg(0, a); kAdd.setArg(1, b); kAdd.setArg(2, c);
+        kTriad.setArg(0, a); kTriad.setArg(1, b); kTriad.setArg(2, c); kTriad.setArg(3, s);
+
+        // Run in STREAM order; each kernel is idempotent, so after triad a = 15, b = 3, c = 4
+        struct Op { const char* name; cl::Kernel* kernel; int arrays; };
+        vector<double> gbs;
+        for (Op op : {Op{"Copy", &kCopy, 2}, Op{"Scale", &kScale, 2}, Op{"Add", &kAdd, 3}, Op{"Triad", &kTriad, 3}}) {
+            BenchStats st = timeEvents(opt, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(*op.kernel, cl::NullRange, cl::NDRange(n / w.perItem), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            }, op.name);
+            gbs.push_back(op.arrays * (double)bytes / (st.medianMs * 1.0e6));
+            peakGBs = max(peakGBs, gbs.back());
+            cout << left << setw(10) << (gbs.size() == 1 ? w.name : "") << setw(10) << op.name
+                 << setw(12) << fixed << setprecision(3) << st.medianMs
+                 << setw(10) << setprecision(1) << gbs.back();
+            if (gbs.size() < 4) cout << endl;
+        }
+
+        // Check the first 1024 elements of each array
+        bool match = true;
+        vector<float> expect = {15.0f, 3.0f, 4.0f};
+        vector<cl::Buffer*> arrays = {&a, &b, &c};
+        for (int k = 0; k < 3; k++) {
+            if (w.elemBytes == 2) {
+                vector<uint16_t> h(1024);
+                queue.enqueueReadBuffer(*arrays[k], CL_TRUE, 0, h.size() * 2, h.data());
+                for (uint16_t v : h) match = match && halfToFloat(v) == expect[k];
+            } else {
+                vector<float> f(1024);
+                queue.enqueueReadBuffer(*arrays[k], CL_TRUE, 0, f.size() * 4, f.data());
+                for (float v : f) match = match && v == expect[k];
+            }
+        }
+        cout << (match ? "PASS" : "FAIL") << endl;
+    }
+    cout << string(50, '-') << endl;
+
+    // --- [2] Strided Gather: useful bytes only ---
+    size_t nPow2 = 1;
+    while (nPow2 * 2 <= n) nPow2 *= 2;
+    cl::Program probes = buildProgram(context, device, src);
+    {
+        cl::Buffer in(context, CL_MEM_READ_ONLY, nPow2 * sizeof(float)), out(context, CL_MEM_WRITE_ONLY, nPow2 * sizeof(float));
+        queue.enqueueFillBuffer(in, 1.0f, 0, nPow2 * sizeof(float));
+        cl::Kernel k(probes, "strided_copy");
+        k.setArg(0, in); k.setArg(1, out); k.setArg(3, (cl_uint)(nPow2 - 1));
+
+        cout << "\n[2] STRIDED ACCESS" << endl;
+        cout << left << setw(10) << "Stride" << setw(12) << "Median(ms)" << setw(10) << "GB/s" << "vs Stride 1" << endl;
+        cout << string(50, '-') << endl;
+        double base = 0.0;
+        for (int stride : {1, 2, 4, 8, 16, 32, 64}) {
+            k.setArg(2, stride);
+            BenchStats st = timeEvents(opt, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(nPow2), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            });
+            double gbs = 2.0 * nPow2 * sizeof(float) / (st.medianMs * 1.0e6);
+            if (stride == 1) base = gbs;
+            cout << left << setw(10) << stride << setw(12) << fixed << setprecision(3) << st.medianMs
+                 << setw(10) << setprecision(1) << gbs << setprecision(2) << gbs / base << "x" << endl;
+        }
+        cout << string(50, '-') << endl;
+    }
+
+    // --- [3] Pointer Chase: dependent-load latency per working-set size ---
+    {
+        const int steps = 1 << 16;
+        cl::Kernel k(probes, "pointer_chase");
+        cl::Buffer out(context, CL_MEM_WRITE_ONLY, sizeof(cl_uint));
+        k.setArg(1, out); k.setArg(2, steps);
+
+        cout << "\n[3] POINTER CHASE (random, dependent loads)" << endl;
+        cout << left << setw(14) << "Working Set" << "Latency(ns)" << endl;
+        cout << string(50, '-') << endl;
+        mt19937 rng(42);
+        for (size_t kb = 4; kb * 1024 <= min<size_t>(maxAlloc, (size_t)256 << 20); kb *= 4) {
+            // Sattolo's algorithm: a single cycle through every slot, so the chase never short-circuits
+            size_t count = kb * 1024 / sizeof(cl_uint);
+            vector<cl_uint> next(count);
+            iota(next.begin(), next.end(), 0);
+            for (size_t i = count - 1; i > 0; i--) swap(next[i], next[uniform_int_distribution<size_t>(0, i - 1)(rng)]);
+
+            cl::Buffer chain(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, count * sizeof(cl_uint), next.data());
+            k.setArg(0, chain);
+            BenchStats st = timeEvents(opt, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(1), cl::NDRange(1), nullptr, &ev[0]);
+                return ev;
+            });
+            string label = kb < 1024 ? to_string(kb) + " KB" : to_string(kb / 1024) + " MB";
+            cout << left << setw(14) << label << fixed << setprecision(1) << st.medianMs * 1.0e6 / steps << endl;
+        }
+        cout << string(50, '-') << endl;
+    }
+
+    // --- [4] Local-Memory Bank Conflicts ---
+    if (localMem >= 2048 * sizeof(float)) {
+        const int iterations = 4096;
+        size_t groups = (size_t)computeUnits * 4;
+        cl::Buffer out(context, CL_MEM_WRITE_ONLY, groups * wg * sizeof(float));
+        cl::Kernel k(probes, "local_bank");
+        k.setArg(0, out); k.setArg(2, iterations);
+
+        cout << "\n[4] LOCAL MEMORY BANK CONFLICTS" << endl;
+        cout << left << setw(10) << "Stride" << setw(12) << "Median(ms)" << "Slowdown" << endl;
+        cout << string(50, '-') << endl;
+        double base = 0.0;
+        for (int stride : {1, 2, 4, 8, 16, 32, 33}) {
+            k.setArg(1, stride);
+            BenchStats st = timeEvents(opt, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(groups * wg), cl::NDRange(wg), nullptr, &ev[0]);
+                return ev;
+            });
+            if (stride == 1) base = st.medianMs;
+            cout << left << setw(10) << (stride == 33 ? "33 (pad)" : to_string(stride)) << setw(12) << fixed << setprecision(3)
+                 << st.medianMs << setprecision(2) << st.medianMs / base << "x" << endl;
+        }
+        cout << string(50, '-') << endl;
+    }
+
+    // --- [5] Peak FP32 Throughput ---
+    double peakGFLOPs = 0.0;
+    {
+        size_t items = (size_t)1 << 18;
+        cl::Buffer out(context, CL_MEM_WRITE_ONLY, items * sizeof(float));
+        cl::Kernel k(probes, "peak_flops");
+        k.setArg(0, out); k.setArg(1, 0.5f);
+        BenchStats st = timeEvents(opt, [&] {
+            vector<cl::Event> ev(1);
+            queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(items), cl::NDRange(wg), nullptr, &ev[0]);
+            return ev;
+        });
+        peakGFLOPs = items * 256.0 * 8 * 4 * 2 / (st.medianMs * 1.0e6);  // FLOP_ITERS * chains * lanes * mad
+    }
+
+    // --- Roofline ---
+    DevicePeaks peaks;
+    peaks.bandwidthGBs = peakGBs;
+    peaks.gflops = peakGFLOPs;
+    saveDevicePeaks(deviceKey(device), peaks);
+
+    cout << "\n=====================================================================" << endl;
+    cout << "  ROOFLINE (saved to " << devicePeaksPath() << ")" << endl;
+    cout << "  > Peak Bandwidth : " << fixed << setprecision(1) << peaks.bandwidthGBs << " GB/s (best STREAM)" << endl;
+    cout << "  > Peak FP32      : " << peaks.gflops << " GFLOP/s" << endl;
+    cout << "  > Ridge Point    : " << setprecision(2) << peaks.ridgePoint() << " FLOP/byte" << endl;
+    cout << "---------------------------------------------------------------------" << endl;
+    cout << left << setw(34) << "  Kernel (intensity)" << "Attainable GFLOP/s" << endl;
+    struct Point { string name; double intensity; };
+    for (const Point& p : {Point{"GEMV fp32 (0.5 FLOP/B)", 0.5}, Point{"GEMV int8 (2 FLOP/B)", 2.0},
+                           Point{"GEMM 1024, no reuse (0.25)", 0.25}, Point{"GEMM 1024, ideal (170.7)", 1024 / 6.0}}) {
+        cout << left << setw(34) << ("  " + p.name) << setprecision(1) << peaks.roofline(p.intensity) << endl;
+    }
+    cout << "=====================================================================" << endl;
+
+    return 0;
+}
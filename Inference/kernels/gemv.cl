@@ -0,0 +1,107 @@
+// Matrix-vector product y = W x for batch-1 decode. W is [M][K] row-major (one output per row).
+//
+// At batch 1 every weight is used exactly once, so GEMV is bound purely by how fast W streams
+// from global memory. The kernels below keep the whole work-group on one row: consecutive
+// work-items read consecutive vectors of that row (coalesced), and the row is reduced in __local memory.
+#ifndef WG_SIZE
+#define WG_SIZE 256
+#endif
+#ifndef VEC
+#define VEC 4
+#endif
+
+#if VEC == 8
+#define VLOAD(i, p) vload8(i, p)
+typedef float8 floatV;
+inline float hsum(float8 v) {
+    float4 s = v.lo + v.hi;
+    return s.x + s.y + s.z + s.w;
+}
+#elif VEC == 4
+#define VLOAD(i, p) vload4(i, p)
+typedef float4 floatV;
+inline float hsum(float4 v) {
+    return v.x + v.y + v.z + v.w;
+}
+#else
+#define VLOAD(i, p) ((p)[i])
+typedef float floatV;
+inline float hsum(float v) {
+    return v;
+}
+#endif
+
+// Partial dot product of w[begin, end) and x[begin, end) for this work-item.
+// 'begin' must be a multiple of VEC; the tail past the last full vector is handled in scalars.
+inline float rowDot(__global const float* w, __global const float* x, int begin, int end, int lid) {
+    float sum = 0.0f;
+    int vecBegin = begin / VEC;
+    int vecEnd = end / VEC;
+    for (int i = vecBegin + lid; i < vecEnd; i += WG_SIZE) {
+        sum += hsum(VLOAD(i, w) * VLOAD(i, x));
+    }
+    for (int i = vecEnd * VEC + lid; i < end; i += WG_SIZE) {
+        sum += w[i] * x[i];
+    }
+    return sum;
+}
+
+// Tree reduction of one value per work-item; the result is valid in work-item 0.
+inline float groupReduce(__local float* partial, float v, int lid) {
+    partial[lid] = v;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int stride = WG_SIZE / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) partial[lid] += partial[lid + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    return partial[0];
+}
+
+// 1. Baseline: one work-item per row. Neighbouring work-items read rows K floats apart (uncoalesced).
+__kernel void gemv_naive(__global const float* W, __global const float* x, __global float* y, int M, int K) {
+    int row = get_global_id(0);
+    if (row >= M) return;
+    float sum = 0.0f;
+    for (int k = 0; k < K; k++) {
+        sum += W[(size_t)row * K + k] * x[k];
+    }
+    y[row] = sum;
+}
+
+// 2. Row per work-group. Grid: (M * WG_SIZE), work-group (WG_SIZE).
+__kernel void gemv(__global const float* W, __global const float* x, __global float* y, int M, int K) {
+    int row = get_group_id(0);
+    int lid = get_local_id(0);
+    __local float partial[WG_SIZE];
+
+    float sum = rowDot(W + (size_t)row * K, x, 0, K, lid);
+    sum = groupReduce(partial, sum, lid);
+    if (lid == 0) y[row] = sum;
+}
+
+// 3. Split-K: each work-group reduces a kChunk-wide slice of one row, so short-and-wide matrices
+// (few rows, large K) still fill the device. Grid: (M * WG_SIZE, splits), work-group (WG_SIZE, 1).
+// kChunk must be a multiple of VEC. Partial sums go to partial[split][M]; gemv_splitk_reduce finishes.
+__kernel void gemv_splitk(__global const float* W, __global const float* x, __global float* partialOut,
+                          int M, int K, int kChunk) {
+    int row = get_group_id(0);
+    int split = get_group_id(1);
+    int lid = get_local_id(0);
+    __local float partial[WG_SIZE];
+
+    int begin = split * kChunk;
+    int end = min(K, begin + kChunk);
+    float sum = rowDot(W + (size_t)row * K, x, begin, end, lid);
+    sum = groupReduce(partial, sum, lid);
+    if (lid == 0) partialOut[(size_t)split * M + row] = sum;
+}
+
+__kernel void gemv_splitk_reduce(__global const float* partial, __global float* y, int M, int splits) {
+    int row = get_global_id(0);
+    if (row >= M) return;
+    float sum = 0.0f;
+    for (int s = 0; s < splits; s++) {
+        sum += partial[(size_t)s * M + row];
+    }
+    y[row] = sum;
+}
@@ -0,0 +1,218 @@
+// Row-wise transformer layer ops: RMSNorm, LayerNorm, softmax, RoPE and residual add.
+// x is [rows][D] row-major. The normalizations and softmax give each row one work-group (like
+// gemv.cl): work-items stride through the row so every pass is coalesced, and the row statistics
+// are reduced in __local memory.
+//
+// Build options (see utils/layer_ops.hpp):
+//   -DWG_SIZE=256        work-group size, a power of two
+//   -DUSE_SUBGROUPS      reduce within each sub-group first (sub_group_reduce_*), then across
+//                        sub-groups in __local memory; -DSUBGROUPS_KHR enables cl_khr_subgroups
+//   -DROW_CACHE=D        stage the row in __local memory (like the A/B tiles in matmul.cl) so the
+//                        second and third passes never touch global memory again; 0 = off
+#ifndef WG_SIZE
+#define WG_SIZE 256
+#endif
+#ifndef ROW_CACHE
+#define ROW_CACHE 0
+#endif
+#ifdef SUBGROUPS_KHR
+#pragma OPENCL EXTENSION cl_khr_subgroups : enable
+#endif
+
+// Work-item 'lid' owns elements lid, lid + WG_SIZE, ... of the row, so the cache is private to
+// it in practice: no barrier is needed between writing a cached element and reading it back.
+#if ROW_CACHE
+#define CACHE_DECL __local float cache[ROW_CACHE]
+#define CACHE_PUT(i, v) (cache[i] = (v))
+#define CACHED(i, fallback) cache[i]
+#else
+#define CACHE_DECL
+#define CACHE_PUT(i, v)
+#define CACHED(i, fallback) (fallback)
+#endif
+
+// Sum / max of one value per work-item, returned to every work-item. 'scratch' holds WG_SIZE floats
+// and may be reused by the next reduction as soon as this one returns.
+inline float groupSum(__local float* scratch, float v) {
+    int lid = get_local_id(0);
+#ifdef USE_SUBGROUPS
+    v = sub_group_reduce_add(v);
+    if (get_sub_group_local_id() == 0) scratch[get_sub_group_id()] = v;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    float total = 0.0f;
+    for (uint i = 0; i < get_num_sub_groups(); i++) total += scratch[i];
+#else
+    scratch[lid] = v;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int stride = WG_SIZE / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) scratch[lid] += scratch[lid + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    float total = scratch[0];
+#endif
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return total;
+}
+
+inline float groupMax(__local float* scratch, float v) {
+    int lid = get_local_id(0);
+#ifdef USE_SUBGROUPS
+    v = sub_group_reduce_max(v);
+    if (get_sub_group_local_id() == 0) scratch[get_sub_group_id()] = v;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    float total = -INFINITY;
+    for (uint i = 0; i < get_num_sub_groups(); i++) total = fmax(total, scratch[i]);
+#else
+    scratch[lid] = v;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int stride = WG_SIZE / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) scratch[lid] = fmax(scratch[lid], scratch[lid + stride]);
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    float total = scratch[0];
+#endif
+    barrier(CLK_LOCAL_MEM_FENCE);
+    return total;
+}
+
+// 1. RMSNorm: y = x / sqrt(mean(x^2) + eps) * weight. Grid: (rows * WG_SIZE), work-group (WG_SIZE).
+__kernel void rmsnorm(__global const float* x, __global const float* weight, __global float* y, int D, float eps) {
+    __local float scratch[WG_SIZE];
+    CACHE_DECL;
+    int lid = get_local_id(0);
+    __global const float* xr = x + (size_t)get_group_id(0) * D;
+    __global float* yr = y + (size_t)get_group_id(0) * D;
+
+    float ss = 0.0f;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float v = xr[i];
+        CACHE_PUT(i, v);
+        ss += v * v;
+    }
+    float inv = rsqrt(groupSum(scratch, ss) / D + eps);
+    for (int i = lid; i < D; i += WG_SIZE) yr[i] = CACHED(i, xr[i]) * inv * weight[i];
+}
+
+// 2. Residual add fused into the next norm: h = x + residual is written back to x (the residual
+// stream) and y = rmsnorm(h). Saves a full read and write of h against residual_add + rmsnorm.
+__kernel void add_rmsnorm(__global float* x, __global const float* residual, __global const float* weight,
+                          __global float* y, int D, float eps) {
+    __local float scratch[WG_SIZE];
+    CACHE_DECL;
+    int lid = get_local_id(0);
+    size_t offset = (size_t)get_group_id(0) * D;
+
+    float ss = 0.0f;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float h = x[offset + i] + residual[offset + i];
+        x[offset + i] = h;
+        CACHE_PUT(i, h);
+        ss += h * h;
+    }
+    float inv = rsqrt(groupSum(scratch, ss) / D + eps);
+    for (int i = lid; i < D; i += WG_SIZE) y[offset + i] = CACHED(i, x[offset + i]) * inv * weight[i];
+}
+
+// 3. LayerNorm: y = (x - mean) / sqrt(var + eps) * gamma + beta. The variance is taken around the
+// mean in a second pass (not E[x^2] - E[x]^2), which stays accurate when |mean| >> stddev.
+__kernel void layernorm(__global const float* x, __global const float* gamma, __global const float* beta,
+                        __global float* y, int D, float eps) {
+    __local float scratch[WG_SIZE];
+    CACHE_DECL;
+    int lid = get_local_id(0);
+    __global const float* xr = x + (size_t)get_group_id(0) * D;
+    __global float* yr = y + (size_t)get_group_id(0) * D;
+
+    float sum = 0.0f;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float v = xr[i];
+        CACHE_PUT(i, v);
+        sum += v;
+    }
+    float mean = groupSum(scratch, sum) / D;
+
+    float var = 0.0f;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float d = CACHED(i, xr[i]) - mean;
+        var += d * d;
+    }
+    float inv = rsqrt(groupSum(scratch, var) / D + eps);
+    for (int i = lid; i < D; i += WG_SIZE) yr[i] = (CACHED(i, xr[i]) - mean) * inv * gamma[i] + beta[i];
+}
+
+// 4. Softmax: y = exp(x - max) / sum(exp(x - max)). Subtracting the row max keeps exp() <= 1,
+// so large logits (e.g. a 32000-entry vocabulary) cannot overflow.
+__kernel void softmax(__global const float* x, __global float* y, int D) {
+    __local float scratch[WG_SIZE];
+    CACHE_DECL;
+    int lid = get_local_id(0);
+    __global const float* xr = x + (size_t)get_group_id(0) * D;
+    __global float* yr = y + (size_t)get_group_id(0) * D;
+
+    float m = -INFINITY;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float v = xr[i];
+        CACHE_PUT(i, v);
+        m = fmax(m, v);
+    }
+    m = groupMax(scratch, m);
+
+    float sum = 0.0f;
+    for (int i = lid; i < D; i += WG_SIZE) {
+        float e = exp(CACHED(i, xr[i]) - m);
+        CACHE_PUT(i, e);
+        sum += e;
+    }
+    float inv = 1.0f / groupSum(scratch, sum);
+    for (int i = lid; i < D; i += WG_SIZE) yr[i] = CACHED(i, exp(xr[i] - m)) * inv;
+}
+
+// 5. Baselines: one work-item per row. Each work-item walks its row serially, and neighbouring
+// work-items are D floats apart, so no load coalesces. Grid: (rows).
+__kernel void rmsnorm_naive(__global const float* x, __global const float* weight, __global float* y, int rows, int D,
+                            float eps) {
+    int row = get_global_id(0);
+    if (row >= rows) return;
+    __global const float* xr = x + (size_t)row * D;
+    float ss = 0.0f;
+    for (int i = 0; i < D; i++) ss += xr[i] * xr[i];
+    float inv = rsqrt(ss / D + eps);
+    for (int i = 0; i < D; i++) y[(size_t)row * D + i] = xr[i] * inv * weight[i];
+}
+
+__kernel void softmax_naive(__global const float* x, __global float* y, int rows, int D) {
+    int row = get_global_id(0);
+    if (row >= rows) return;
+    __global const float* xr = x + (size_t)row * D;
+    float m = -INFINITY;
+    for (int i = 0; i < D; i++) m = fmax(m, xr[i]);
+    float sum = 0.0f;
+    for (int i = 0; i < D; i++) sum += exp(xr[i] - m);
+    for (int i = 0; i < D; i++) y[(size_t)row * D + i] = exp(xr[i] - m) / sum;
+}
+
+// 6. Rotary position embedding, in place. x is [tokens][heads][headDim]; token t sits at
+// position pos[t]. Pair (2i, 2i + 1) of each head is rotated by pos * theta^(-2i / headDim)
+// (the interleaved layout of the original LLaMA weights). Grid: (headDim / 2, heads, tokens).
+__kernel void rope(__global float* x, __global const int* pos, int heads, int headDim, float theta) {
+    int i = get_global_id(0);
+    int h = get_global_id(1);
+    int t = get_global_id(2);
+    float freq = exp2(-2.0f * i / headDim * log2(theta));
+    float angle = pos[t] * freq;
+    float c, s = sincos(angle, &c);
+
+    __global float* p = x + ((size_t)t * heads + h) * headDim + 2 * i;
+    float2 v = vload2(0, p);
+    vstore2((float2)(v.x * c - v.y * s, v.x * s + v.y * c), 0, p);
+}
+
+// 7. Residual add y = x + residual over n floats, four per work-item. Grid: (ceil(n / 4)).
+__kernel void residual_add(__global const float* x, __global const float* residual, __global float* y, int n) {
+    int i = get_global_id(0);
+    if (4 * i + 3 < n) {
+        vstore4(vload4(i, x) + vload4(i, residual), i, y);
+    } else {
+        for (int j = 4 * i; j < n; j++) y[j] = x[j] + residual[j];
+    }
+}
@@ -0,0 +1,104 @@
+// Paged KV-cache kernels for autoregressive decode.
+//
+// The cache is a pool of fixed-size blocks: KPool/VPool are [numBlocks][numKVHeads][BLOCK_SIZE][HEAD_DIM].
+// Each sequence owns a row of blockTables ([maxSeqs][maxBlocksPerSeq]) mapping its logical block i
+// to a physical pool block, so a sequence grows by claiming one more block, never by copying history.
+#ifndef HEAD_DIM
+#define HEAD_DIM 64
+#endif
+#ifndef BLOCK_SIZE
+#define BLOCK_SIZE 16
+#endif
+
+#if BLOCK_SIZE > HEAD_DIM
+#error "BLOCK_SIZE must be <= HEAD_DIM (one work-item scores each token of a block)"
+#endif
+
+// Scatter new K/V rows into their cache slots (slot = block * BLOCK_SIZE + offset).
+// KNew/VNew: [numRows][numKVHeads][HEAD_DIM]. Grid: (HEAD_DIM, numKVHeads, numRows).
+__kernel void paged_kv_append(__global const float* KNew, __global const float* VNew,
+                              __global float* KPool, __global float* VPool,
+                              __global const int* slots, int numKVHeads) {
+    int d = get_global_id(0);
+    int head = get_global_id(1);
+    int r = get_global_id(2);
+
+    int slot = slots[r];
+    int block = slot / BLOCK_SIZE;
+    int offset = slot % BLOCK_SIZE;
+
+    size_t src = ((size_t)r * numKVHeads + head) * HEAD_DIM + d;
+    size_t dst = (((size_t)block * numKVHeads + head) * BLOCK_SIZE + offset) * HEAD_DIM + d;
+    KPool[dst] = KNew[src];
+    VPool[dst] = VNew[src];
+}
+
+// Single-token decode attention: O = Softmax(q K^T * scale) V over each sequence's cached history.
+// Q/O: [numSeqs][numHeads][HEAD_DIM]. Grid: (HEAD_DIM, numHeads, numSeqs), work-group (HEAD_DIM, 1, 1).
+// Work-item d owns output dimension d. Query heads map onto KV heads in groups (GQA/MQA when
+// numKVHeads < numHeads).
+__kernel void paged_attention_decode(__global const float* Q,
+                                     __global const float* KPool, __global const float* VPool,
+                                     __global const int* blockTables, __global const int* contextLens,
+                                     __global float* O, int numHeads, int numKVHeads,
+                                     int maxBlocksPerSeq, float scale) {
+    // 1. Identifiers
+    int d = get_local_id(0);
+    int head = get_group_id(1);
+    int seq = get_group_id(2);
+    int kvHead = head / (numHeads / numKVHeads);
+
+    int ctxLen = contextLens[seq];
+    __global const int* table = blockTables + (size_t)seq * maxBlocksPerSeq;
+
+    // 2. Local Memory (SRAM): the query, one K block and its scores
+    __local float q[HEAD_DIM];
+    __local float TileK[BLOCK_SIZE][HEAD_DIM];
+    __local float scores[BLOCK_SIZE];
+
+    q[d] = Q[((size_t)seq * numHeads + head) * HEAD_DIM + d] * scale;
+
+    // 3. Private Memory (Registers): this dimension's accumulator and the softmax state
+    float acc = 0.0f;
+    float m = -INFINITY;
+    float l = 0.0f;
+
+    int numBlocks = (ctxLen + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    for (int b = 0; b < numBlocks; b++) {
+        size_t base = ((size_t)table[b] * numKVHeads + kvHead) * BLOCK_SIZE * HEAD_DIM;
+        int tokens = min(BLOCK_SIZE, ctxLen - b * BLOCK_SIZE);
+
+        // Load the K block (coalesced along HEAD_DIM)
+        for (int t = 0; t < BLOCK_SIZE; t++) {
+            TileK[t][d] = KPool[base + (size_t)t * HEAD_DIM + d];
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // One work-item per token computes its score
+        if (d < BLOCK_SIZE) {
+            float dot = 0.0f;
+            for (int i = 0; i < HEAD_DIM; i++) {
+                dot += q[i] * TileK[d][i];
+            }
+            scores[d] = (d < tokens) ? dot : -INFINITY;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // Online softmax update (every work-item tracks the same m and l), then accumulate P V
+        float blockMax = -INFINITY;
+        for (int t = 0; t < tokens; t++) blockMax = fmax(blockMax, scores[t]);
+        float mNew = fmax(m, blockMax);
+        float correction = exp(m - mNew);
+        l *= correction;
+        acc *= correction;
+        for (int t = 0; t < tokens; t++) {
+            float p = exp(scores[t] - mNew);
+            l += p;
+            acc += p * VPool[base + (size_t)t * HEAD_DIM + d];
+        }
+        m = mNew;
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    O[((size_t)seq * numHeads + head) * HEAD_DIM + d] = (l > 0.0f) ? acc / l : 0.0f;
+}
@@ -0,0 +1,154 @@
+// Weight-only quantized matmul: weights are stored as int8 or packed int4 with a scale and
+// zero point per group of GROUP_SIZE consecutive K values, and dequantized inside the kernel.
+//
+//   W (logical) : [N][K], one row per output feature (so C = A * W^T)
+//   Wq          : QBITS == 8 -> uchar [N][K];  QBITS == 4 -> uchar [N][K / 2], low nibble = even k
+//   scales      : float [N][K / GROUP_SIZE]
+//   zeros       : uchar [N][K / GROUP_SIZE]
+//   w[n][k]     = (q[n][k] - zeros[n][g]) * scales[n][g],  g = k / GROUP_SIZE
+//
+// Build options: -DQBITS=8|4 -DGROUP_SIZE=G (multiple of 8, K % G == 0)
+//                -DHALF_ACT  activations (A / x) are stored as half (vload_half, no extension needed)
+//                -DHAS_FP16  with HALF_ACT, do the GEMV products in native half (needs cl_khr_fp16)
+#ifndef QBITS
+#define QBITS 8
+#endif
+#ifndef GROUP_SIZE
+#define GROUP_SIZE 64
+#endif
+#ifndef WG_SIZE
+#define WG_SIZE 256
+#endif
+#ifndef TileSize
+#define TileSize 16
+#endif
+
+#if defined(HAS_FP16)
+#pragma OPENCL EXTENSION cl_khr_fp16 : enable
+#endif
+
+#ifdef HALF_ACT
+typedef half act_t;
+#define LOAD_ACT(i, p) vload_half(i, p)
+#define LOAD_ACT8(i, p) vload_half8(i, p)
+#else
+typedef float act_t;
+#define LOAD_ACT(i, p) ((p)[i])
+#define LOAD_ACT8(i, p) vload8(i, p)
+#endif
+
+#if QBITS == 4
+#define ROW_BYTES(K) ((K) / 2)
+#else
+#define ROW_BYTES(K) (K)
+#endif
+
+// Raw quantized value of W[n][k] (before zero point and scale). 'row' points at row n of Wq.
+inline int loadQ(__global const uchar* row, int k) {
+#if QBITS == 4
+    uchar b = row[k >> 1];
+    return (k & 1) ? (b >> 4) : (b & 0xF);
+#else
+    return row[k];
+#endif
+}
+
+// Eight consecutive quantized values starting at k = 8 * i.
+inline float8 loadQ8(__global const uchar* row, int i) {
+#if QBITS == 4
+    uchar4 b = vload4(i, row);
+    uchar4 lo = b & (uchar4)(0xF);
+    uchar4 hi = b >> (uchar4)(4);
+    return convert_float8((uchar8)(lo.s0, hi.s0, lo.s1, hi.s1, lo.s2, hi.s2, lo.s3, hi.s3));
+#else
+    return convert_float8(vload8(i, row));
+#endif
+}
+
+inline float hsum8(float8 v) {
+    float4 s = v.lo + v.hi;
+    return s.x + s.y + s.z + s.w;
+}
+
+// 1. GEMV (batch-1 decode): y[n] = sum_k W[n][k] * x[k].
+// One work-group per output row, eight weights per work-item step. Grid: (N * WG_SIZE), work-group (WG_SIZE).
+__kernel void qgemv(__global const uchar* Wq, __global const float* scales, __global const uchar* zeros,
+                    __global const act_t* x, __global float* y, int N, int K) {
+    int n = get_group_id(0);
+    int lid = get_local_id(0);
+    int groups = K / GROUP_SIZE;
+
+    __global const uchar* row = Wq + (size_t)n * ROW_BYTES(K);
+    __global const float* s = scales + (size_t)n * groups;
+    __global const uchar* z = zeros + (size_t)n * groups;
+
+    float sum = 0.0f;
+    for (int i = lid; i < K / 8; i += WG_SIZE) {
+        int g = (i * 8) / GROUP_SIZE;  // GROUP_SIZE % 8 == 0, so all eight share a group
+#if defined(HALF_ACT) && defined(HAS_FP16)
+        half8 w = convert_half8(loadQ8(row, i) - (float)z[g]) * (half)s[g];
+        sum += hsum8(convert_float8(w * vload8(i, x)));
+#else
+        float8 w = (loadQ8(row, i) - (float8)((float)z[g])) * s[g];
+        sum += hsum8(w * LOAD_ACT8(i, x));
+#endif
+    }
+
+    __local float partial[WG_SIZE];
+    partial[lid] = sum;
+    barrier(CLK_LOCAL_MEM_FENCE);
+    for (int stride = WG_SIZE / 2; stride > 0; stride >>= 1) {
+        if (lid < stride) partial[lid] += partial[lid + stride];
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+    if (lid == 0) y[n] = partial[0];
+}
+
+// 2. GEMM (prefill / batched): C[M][N] = A[M][K] * W^T.
+// Tiled like matmul.cl; the W tile is dequantized once while it is staged into local memory,
+// so the inner product loop runs on plain floats. Grid: (roundUp(N), roundUp(M)), work-group (TileSize, TileSize).
+__kernel void qgemm(__global const act_t* A, __global const uchar* Wq, __global const float* scales,
+                    __global const uchar* zeros, __global float* C, int M, int N, int K) {
+    // 1. Thread Identifiers
+    int row = get_global_id(1);
+    int col = get_global_id(0);
+    int localrow = get_local_id(1);
+    int localcol = get_local_id(0);
+    int groups = K / GROUP_SIZE;
+
+    // 2. Local Memory: TileW[j][k] holds W[colBase + j][k]; +1 padding avoids bank conflicts on column reads
+    __local float TileA[TileSize][TileSize];
+    __local float TileW[TileSize][TileSize + 1];
+
+    int wRow = get_group_id(0) * TileSize + localrow;  // Output feature this thread loads
+    __global const uchar* wq = Wq + (size_t)wRow * ROW_BYTES(K);
+
+    float acc = 0.0f;
+    int numTiles = (K + TileSize - 1) / TileSize;
+
+    for (int t = 0; t < numTiles; t++) {
+        int k = t * TileSize + localcol;
+
+        TileA[localrow][localcol] = (row < M && k < K) ? LOAD_ACT((size_t)row * K + k, A) : 0.0f;
+
+        if (wRow < N && k < K) {
+            int g = k / GROUP_SIZE;
+            size_t gi = (size_t)wRow * groups + g;
+            TileW[localrow][localcol] = (float)(loadQ(wq, k) - zeros[gi]) * scales[gi];
+        } else {
+            TileW[localrow][localcol] = 0.0f;
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int k_inner = 0; k_inner < TileSize; ++k_inner) {
+            acc += TileA[localrow][k_inner] * TileW[localcol][k_inner];
+        }
+
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    if (row < M && col < N) {
+        C[row * N + col] = acc;
+    }
+}
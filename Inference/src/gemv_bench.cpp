@@ -0,0 +1,191 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <cstdio>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/device_peaks.hpp"
+
+using namespace std;
+
+// Usage: gemv_bench [--device <spec>] [--shapes 4096x4096,11008x4096] [--reps N]
+// Batch-1 decode GEMV (y = W x, W is M x K) across kernel variants, reported as achieved GB/s
+// and as a percentage of the device's measured copy bandwidth (see memory_benchmarking.cpp).
+
+int main(int argc, char** argv) {
+    vector<pair<int, int>> shapes = {{4096, 4096}, {11008, 4096}, {4096, 11008}, {32000, 4096}};
+    int reps = 10;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--reps") reps = stoi(argv[++i]);
+        else if (arg == "--shapes") {
+            shapes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) {
+                int M, K;
+                if (sscanf(item.c_str(), "%dx%d", &M, &K) == 2) shapes.push_back({M, K});
+            }
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+    cl_uint computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    size_t maxWGSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+
+    int wgSize = 256;
+    while ((size_t)wgSize > maxWGSize) wgSize /= 2;
+
+    // --- Peak Bandwidth: reuse the memory benchmark's measurement, or take it now ---
+    DevicePeaks peaks;
+    string devKey = deviceKey(device);
+    if (!loadDevicePeaks(devKey, peaks)) {
+        string benchSrc = readKernelFile("Hardware/kernels/memory_bench.cl");
+        cl::Program benchProgram = buildProgram(context, device, benchSrc);
+        cl::Kernel k_bandwidth(benchProgram, "benchmark_bandwidth");
+        peaks.bandwidthGBs = measureCopyBandwidth(context, queue, k_bandwidth, 1 << 24);
+        saveDevicePeaks(devKey, peaks);
+    }
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Max Compute Units  : " << computeUnits << endl;
+    cout << "Work-Group Size    : " << wgSize << endl;
+    cout << "Peak Bandwidth     : " << fixed << setprecision(2) << peaks.bandwidthGBs << " GB/s (copy)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    // --- Build Section: one program per vector width ---
+    string gemvSrc = readKernelFile("Inference/kernels/gemv.cl");
+    map<int, cl::Program> programs;
+    for (int vec : {1, 4, 8}) {
+        string options = "-cl-std=CL2.0 -DWG_SIZE=" + to_string(wgSize) + " -DVEC=" + to_string(vec);
+        programs[vec] = buildProgram(context, device, gemvSrc, options);
+    }
+    string sramSrc = readKernelFile("Vector_Foundations/kernels/matmul.cl");
+    TuneParams pSRAM = matmulDefaults("matmul", queryLimits(device));
+    cl::Program sramProgram = buildProgram(context, device, sramSrc, buildOptions(pSRAM));
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(14) << "Shape"
+         << setw(22) << "Kernel"
+         << setw(12) << "Median(ms)"
+         << setw(10) << "GB/s"
+         << setw(10) << "% Peak"
+         << "Result" << endl;
+    cout << string(85, '-') << endl;
+
+    for (auto [M, K] : shapes) {
+        vector<float> W((size_t)M * K), x(K), y(M), ref(M);
+        for (size_t i = 0; i < W.size(); i++) W[i] = (float)((i * 7) % 13) * 0.01f - 0.06f;
+        for (int k = 0; k < K; k++) x[k] = sin(0.01f * k);
+        for (int m = 0; m < M; m++) {
+            double acc = 0.0;
+            for (int k = 0; k < K; k++) acc += (double)W[(size_t)m * K + k] * x[k];
+            ref[m] = (float)acc;
+        }
+
+        cl::Buffer bufW(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * W.size(), W.data());
+        cl::Buffer bufX(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * x.size(), x.data());
+        cl::Buffer bufY(context, CL_MEM_WRITE_ONLY, sizeof(float) * y.size());
+
+        // Split-K: enough slices that the grid covers every compute unit several times over
+        int targetGroups = 8 * computeUnits;
+        int splits = max(1, min((targetGroups + M - 1) / M, K / (wgSize * 4)));
+        int kChunk = (int)roundUp((K + splits - 1) / splits, 8);
+        splits = (K + kChunk - 1) / kChunk;
+        cl::Buffer bufPartial(context, CL_MEM_READ_WRITE, sizeof(float) * M * splits);
+
+        // Minimum bytes that must cross the memory bus: W once, x once, y once
+        double bytes = sizeof(float) * ((double)M * K + K + M);
+
+        // Median of 'reps' timed launches after one warmup; 'launch' enqueues and returns the events to time
+        auto run = [&](const string& name, function<vector<cl::Event>()> launch) {
+            vector<double> times;
+            for (int r = 0; r <= reps; r++) {
+                vector<cl::Event> events = launch();
+                double ms = 0.0;
+                for (auto& e : events) {
+                    e.wait();
+                    ms += (e.getProfilingInfo<CL_PROFILING_COMMAND_END>() - e.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+                }
+                if (r > 0) times.push_back(ms);
+            }
+            sort(times.begin(), times.end());
+            double median = times[times.size() / 2];
+
+            queue.enqueueReadBuffer(bufY, CL_TRUE, 0, sizeof(float) * y.size(), y.data());
+            bool match = true;
+            for (int m = 0; m < M && match; m++) {
+                if (std::abs(ref[m] - y[m]) > 1e-3 * (1.0f + std::abs(ref[m]))) match = false;
+            }
+
+            double gbs = bytes / (median * 1.0e6);
+            cout << left << setw(14) << (to_string(M) + "x" + to_string(K))
+                 << setw(22) << name
+                 << setw(12) << fixed << setprecision(3) << median
+                 << setw(10) << setprecision(1) << gbs
+                 << setw(10) << (peaks.bandwidthGBs > 0 ? 100.0 * gbs / peaks.bandwidthGBs : 0.0)
+                 << (match ? "PASS" : "FAIL") << endl;
+        };
+
+        // --- 1. 2D Tiled MatMul with N = 1 (the wrong shape for decode) ---
+        cl::Kernel kSRAM(sramProgram, "matmul");
+        kSRAM.setArg(0, bufW); kSRAM.setArg(1, bufX); kSRAM.setArg(2, bufY);
+        kSRAM.setArg(3, M); kSRAM.setArg(4, 1); kSRAM.setArg(5, K);
+        run("SRAM MatMul (N=1)", [&] {
+            vector<cl::Event> ev(1);
+            queue.enqueueNDRangeKernel(kSRAM, cl::NullRange, matmulGlobalSize("matmul", pSRAM, M, 1),
+                                       cl::NDRange(pSRAM.localX, pSRAM.localY), nullptr, &ev[0]);
+            return ev;
+        });
+
+        // --- 2. One Row per Work-Item ---
+        cl::Kernel kNaive(programs[1], "gemv_naive");
+        kNaive.setArg(0, bufW); kNaive.setArg(1, bufX); kNaive.setArg(2, bufY); kNaive.setArg(3, M); kNaive.setArg(4, K);
+        run("Row/Work-Item", [&] {
+            vector<cl::Event> ev(1);
+            queue.enqueueNDRangeKernel(kNaive, cl::NullRange, cl::NDRange(roundUp(M, 64)), cl::NullRange, nullptr, &ev[0]);
+            return ev;
+        });
+
+        // --- 3. Row per Work-Group, scalar / float4 / float8 loads ---
+        for (int vec : {1, 4, 8}) {
+            cl::Kernel k(programs[vec], "gemv");
+            k.setArg(0, bufW); k.setArg(1, bufX); k.setArg(2, bufY); k.setArg(3, M); k.setArg(4, K);
+            run("Row/WG float" + (vec == 1 ? string("") : to_string(vec)), [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange((size_t)M * wgSize), cl::NDRange(wgSize), nullptr, &ev[0]);
+                return ev;
+            });
+        }
+
+        // --- 4. Split-K (float4) + Reduce ---
+        cl::Kernel kSplit(programs[4], "gemv_splitk");
+        cl::Kernel kReduce(programs[4], "gemv_splitk_reduce");
+        kSplit.setArg(0, bufW); kSplit.setArg(1, bufX); kSplit.setArg(2, bufPartial);
+        kSplit.setArg(3, M); kSplit.setArg(4, K); kSplit.setArg(5, kChunk);
+        kReduce.setArg(0, bufPartial); kReduce.setArg(1, bufY); kReduce.setArg(2, M); kReduce.setArg(3, splits);
+        run("Split-K x" + to_string(splits) + " float4", [&] {
+            vector<cl::Event> ev(2);
+            queue.enqueueNDRangeKernel(kSplit, cl::NullRange, cl::NDRange((size_t)M * wgSize, splits),
+                                       cl::NDRange(wgSize, 1), nullptr, &ev[0]);
+            queue.enqueueNDRangeKernel(kReduce, cl::NullRange, cl::NDRange(roundUp(M, 64)), cl::NullRange, nullptr, &ev[1]);
+            return ev;
+        });
+
+        cout << string(85, '-') << endl;
+    }
+
+    return 0;
+}
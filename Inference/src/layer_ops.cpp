@@ -0,0 +1,286 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <cstdio>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/device_peaks.hpp"
+#include "utils/layer_ops.hpp"
+
+using namespace std;
+
+// Usage: layer_ops [--device <spec>] [--shapes 512x4096,32x32000] [--head-dim 128] [--reps N]
+// Validates every kernel in layer_ops.cl against a double-precision CPU reference and reports
+// achieved GB/s as a percentage of the device's measured copy bandwidth. Shapes are rows x D.
+// The reductions run with __local tree reductions, with the row staged in local memory, and with
+// sub-group reductions when the device has them.
+
+static const float kEps = 1e-5f;
+
+static double maxRelErr(const vector<float>& got, const vector<double>& ref) {
+    double err = 0.0;
+    for (size_t i = 0; i < ref.size(); i++) err = max(err, std::abs(got[i] - ref[i]) / (1.0 + std::abs(ref[i])));
+    return err;
+}
+
+int main(int argc, char** argv) {
+    vector<pair<int, int>> shapes = {{1, 4096}, {512, 4096}, {2048, 4096}, {32, 32000}};
+    int headDim = 128, reps = 10;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--reps") reps = stoi(argv[++i]);
+        else if (arg == "--head-dim") headDim = stoi(argv[++i]);
+        else if (arg == "--shapes") {
+            shapes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) {
+                int R, D;
+                if (sscanf(item.c_str(), "%dx%d", &R, &D) == 2) shapes.push_back({R, D});
+            }
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    // --- Peak Bandwidth: reuse the memory benchmark's measurement, or take it now ---
+    DevicePeaks peaks;
+    string devKey = deviceKey(device);
+    if (!loadDevicePeaks(devKey, peaks)) {
+        cl::Program benchProgram = buildProgram(context, device, readKernelFile("Hardware/kernels/memory_bench.cl"));
+        cl::Kernel k_bandwidth(benchProgram, "benchmark_bandwidth");
+        peaks.bandwidthGBs = measureCopyBandwidth(context, queue, k_bandwidth, 1 << 24);
+        saveDevicePeaks(devKey, peaks);
+    }
+
+    bool khr = false;
+    bool subgroups = hasSubgroups(device, &khr);
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Local Memory (SRAM): " << device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>() / 1024 << " KB per Compute Unit" << endl;
+    cout << "Sub-Groups         : " << (subgroups ? (khr ? "cl_khr_subgroups" : "cl_intel_subgroups") : "Not supported") << endl;
+    cout << "Peak Bandwidth     : " << fixed << setprecision(2) << peaks.bandwidthGBs << " GB/s (copy)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    string src = readKernelFile("Inference/kernels/layer_ops.cl");
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(14) << "Shape"
+         << setw(30) << "Kernel"
+         << setw(12) << "Median(ms)"
+         << setw(10) << "GB/s"
+         << setw(10) << "% Peak"
+         << setw(12) << "MaxErr"
+         << "Result" << endl;
+    cout << string(95, '-') << endl;
+
+    for (auto [R, D] : shapes) {
+        size_t n = (size_t)R * D;
+        vector<float> x(n), res(n), logits(n), w(D), gamma(D), beta(D), out(n), out2(n);
+        for (size_t i = 0; i < n; i++) {
+            x[i] = sin(0.013f * i) * 2.0f + 0.5f;       // Non-zero mean exercises LayerNorm's centering
+            res[i] = cos(0.007f * i);
+            logits[i] = sin(0.003f * i) * 40.0f;        // exp(40) overflows float without the max shift
+        }
+        for (int d = 0; d < D; d++) {
+            w[d] = 1.0f + 0.01f * (d % 11);
+            gamma[d] = 0.5f + 0.02f * (d % 7);
+            beta[d] = 0.01f * (d % 5) - 0.02f;
+        }
+
+        auto upload = [&](const vector<float>& v, cl_mem_flags flags = CL_MEM_READ_ONLY) {
+            return cl::Buffer(context, flags | CL_MEM_COPY_HOST_PTR, sizeof(float) * v.size(), (void*)v.data());
+        };
+        cl::Buffer bufX = upload(x), bufRes = upload(res), bufLogits = upload(logits);
+        cl::Buffer bufW = upload(w), bufGamma = upload(gamma), bufBeta = upload(beta);
+        cl::Buffer bufWork(context, CL_MEM_READ_WRITE, sizeof(float) * n);  // In-place kernels run on a copy of x
+        cl::Buffer bufY(context, CL_MEM_READ_WRITE, sizeof(float) * n);
+
+        // --- CPU References (double) ---
+        vector<double> refRms(n), refAddH(n), refAddRms(n), refLn(n), refSoftmax(n), refRes(n);
+        for (int r = 0; r < R; r++) {
+            size_t o = (size_t)r * D;
+            double ss = 0.0, hs = 0.0, mean = 0.0, var = 0.0, m = -INFINITY, sum = 0.0;
+            for (int d = 0; d < D; d++) {
+                ss += (double)x[o + d] * x[o + d];
+                refAddH[o + d] = (double)x[o + d] + res[o + d];
+                hs += refAddH[o + d] * refAddH[o + d];
+                mean += x[o + d];
+                m = max(m, (double)logits[o + d]);
+                refRes[o + d] = refAddH[o + d];
+            }
+            mean /= D;
+            for (int d = 0; d < D; d++) {
+                var += (x[o + d] - mean) * (x[o + d] - mean);
+                sum += exp(logits[o + d] - m);
+            }
+            double invRms = 1.0 / sqrt(ss / D + kEps), invAdd = 1.0 / sqrt(hs / D + kEps), invLn = 1.0 / sqrt(var / D + kEps);
+            for (int d = 0; d < D; d++) {
+                refRms[o + d] = x[o + d] * invRms * w[d];
+                refAddRms[o + d] = refAddH[o + d] * invAdd * w[d];
+                refLn[o + d] = (x[o + d] - mean) * invLn * gamma[d] + beta[d];
+                refSoftmax[o + d] = exp(logits[o + d] - m) / sum;
+            }
+        }
+
+        // RoPE over [R tokens][D / headDim heads][headDim], positions spread over a 2K context
+        int heads = D % headDim == 0 ? D / headDim : 0;
+        vector<int> pos(R);
+        for (int t = 0; t < R; t++) pos[t] = (t * 37) % 2048;
+        cl::Buffer bufPos(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(int) * R, pos.data());
+        vector<double> refRope(x.begin(), x.end());
+        for (int t = 0; t < R && heads; t++) {
+            for (int h = 0; h < heads; h++) {
+                for (int i = 0; i < headDim / 2; i++) {
+                    double angle = pos[t] * pow(10000.0, -2.0 * i / headDim);
+                    size_t p = ((size_t)t * heads + h) * headDim + 2 * i;
+                    refRope[p] = x[p] * cos(angle) - x[p + 1] * sin(angle);
+                    refRope[p + 1] = x[p] * sin(angle) + x[p + 1] * cos(angle);
+                }
+            }
+        }
+
+        // Median of 'reps' timed launches after one warmup. 'launch' returns the events to time;
+        // 'check' reads the results back and returns the max relative error.
+        string shapeLabel = to_string(R) + "x" + to_string(D);
+        bool firstRow = true;
+        auto run = [&](const string& name, double bytes, function<vector<cl::Event>()> launch, function<double()> check) {
+            vector<double> times;
+            for (int r = 0; r <= reps; r++) {
+                vector<cl::Event> events = launch();
+                double ms = 0.0;
+                for (auto& e : events) {
+                    e.wait();
+                    ms += (e.getProfilingInfo<CL_PROFILING_COMMAND_END>() - e.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+                }
+                if (r > 0) times.push_back(ms);
+            }
+            sort(times.begin(), times.end());
+            double median = times[times.size() / 2];
+            double err = check();
+
+            double gbs = bytes / (median * 1.0e6);
+            cout << left << setw(14) << (firstRow ? shapeLabel : "")
+                 << setw(30) << name
+                 << setw(12) << fixed << setprecision(3) << median
+                 << setw(10) << setprecision(1) << gbs
+                 << setw(10) << (peaks.bandwidthGBs > 0 ? 100.0 * gbs / peaks.bandwidthGBs : 0.0)
+                 << setw(12) << scientific << setprecision(2) << err << fixed
+                 << (err < 1e-3 ? "PASS" : "FAIL") << endl;
+            firstRow = false;
+        };
+        auto readY = [&](const vector<double>& ref) {
+            queue.enqueueReadBuffer(bufY, CL_TRUE, 0, sizeof(float) * n, out.data());
+            return maxRelErr(out, ref);
+        };
+        auto resetWork = [&] { queue.enqueueCopyBuffer(bufX, bufWork, 0, 0, sizeof(float) * n); };
+
+        const double F = sizeof(float);
+        double rowBytes = F * 2.0 * n;  // One read and one write of the activation
+
+        // --- 1. Baselines: one work-item per row ---
+        LayerOpsConfig best = layerOpsConfig(device, D);
+        cl::Program bestProgram = buildProgram(context, device, src, best.buildOptions());
+        size_t rowsGlobal = (R + 63) / 64 * 64;
+        {
+            cl::Kernel k(bestProgram, "rmsnorm_naive");
+            k.setArg(0, bufX); k.setArg(1, bufW); k.setArg(2, bufY); k.setArg(3, R); k.setArg(4, D); k.setArg(5, kEps);
+            run("RMSNorm (row/work-item)", rowBytes + F * D, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(rowsGlobal), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            }, [&] { return readY(refRms); });
+        }
+        {
+            cl::Kernel k(bestProgram, "softmax_naive");
+            k.setArg(0, bufLogits); k.setArg(1, bufY); k.setArg(2, R); k.setArg(3, D);
+            run("Softmax (row/work-item)", rowBytes, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(rowsGlobal), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            }, [&] { return readY(refSoftmax); });
+        }
+
+        // --- 2. Row per Work-Group: local tree, local tree + row cache, sub-groups (+ cache) ---
+        vector<LayerOpsConfig> configs;
+        LayerOpsConfig local = layerOpsConfig(device, D, false);
+        LayerOpsConfig uncached = local;
+        uncached.rowCache = 0;
+        configs.push_back(uncached);
+        if (local.rowCache) configs.push_back(local);
+        if (best.subgroups) configs.push_back(best);
+
+        for (const LayerOpsConfig& cfg : configs) {
+            cl::Program program = buildProgram(context, device, src, cfg.buildOptions());
+            cl::NDRange global((size_t)R * cfg.wgSize), localRange(cfg.wgSize);
+            auto launchRows = [&](cl::Kernel& k) {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, global, localRange, nullptr, &ev[0]);
+                return ev;
+            };
+            string tag = " (" + cfg.name() + ")";
+
+            cl::Kernel kRms(program, "rmsnorm");
+            kRms.setArg(0, bufX); kRms.setArg(1, bufW); kRms.setArg(2, bufY); kRms.setArg(3, D); kRms.setArg(4, kEps);
+            run("RMSNorm" + tag, rowBytes + F * D, [&] { return launchRows(kRms); }, [&] { return readY(refRms); });
+
+            cl::Kernel kAdd(program, "add_rmsnorm");
+            kAdd.setArg(0, bufWork); kAdd.setArg(1, bufRes); kAdd.setArg(2, bufW); kAdd.setArg(3, bufY);
+            kAdd.setArg(4, D); kAdd.setArg(5, kEps);
+            run("Add+RMSNorm" + tag, 2 * rowBytes + F * D, [&] {
+                resetWork();
+                return launchRows(kAdd);
+            }, [&] {
+                queue.enqueueReadBuffer(bufWork, CL_TRUE, 0, F * n, out2.data());
+                return max(readY(refAddRms), maxRelErr(out2, refAddH));
+            });
+
+            cl::Kernel kLn(program, "layernorm");
+            kLn.setArg(0, bufX); kLn.setArg(1, bufGamma); kLn.setArg(2, bufBeta); kLn.setArg(3, bufY);
+            kLn.setArg(4, D); kLn.setArg(5, kEps);
+            run("LayerNorm" + tag, rowBytes + 2 * F * D, [&] { return launchRows(kLn); }, [&] { return readY(refLn); });
+
+            cl::Kernel kSoftmax(program, "softmax");
+            kSoftmax.setArg(0, bufLogits); kSoftmax.setArg(1, bufY); kSoftmax.setArg(2, D);
+            run("Softmax" + tag, rowBytes, [&] { return launchRows(kSoftmax); }, [&] { return readY(refSoftmax); });
+        }
+
+        // --- 3. Elementwise: RoPE (in place) and residual add ---
+        if (heads) {
+            cl::Kernel k(bestProgram, "rope");
+            k.setArg(0, bufWork); k.setArg(1, bufPos); k.setArg(2, heads); k.setArg(3, headDim); k.setArg(4, 10000.0f);
+            run("RoPE (head dim " + to_string(headDim) + ")", rowBytes + sizeof(int) * R, [&] {
+                resetWork();
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(headDim / 2, heads, R), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            }, [&] {
+                queue.enqueueReadBuffer(bufWork, CL_TRUE, 0, F * n, out.data());
+                return maxRelErr(out, refRope);
+            });
+        }
+        {
+            cl::Kernel k(bestProgram, "residual_add");
+            k.setArg(0, bufX); k.setArg(1, bufRes); k.setArg(2, bufY); k.setArg(3, (int)n);
+            run("Residual Add (float4)", 3 * F * n, [&] {
+                vector<cl::Event> ev(1);
+                queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange((n / 4 + 64) / 64 * 64), cl::NullRange, nullptr, &ev[0]);
+                return ev;
+            }, [&] { return readY(refRes); });
+        }
+
+        cout << string(95, '-') << endl;
+    }
+
+    return 0;
+}
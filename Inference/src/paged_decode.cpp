@@ -0,0 +1,186 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/paged_kv_cache.hpp"
+
+using namespace std;
+
+// Usage: paged_decode [--device <spec>] [--seqs S] [--heads H] [--kv-heads KVH] [--dim D] [--block B] [--steps T]
+// Simulates batched autoregressive decode: every sequence gets a prompt of a different length, then
+// each step appends one token per sequence to the paged KV cache and runs decode attention over it.
+
+// CPU reference for one (sequence, head): history is [len][numKVHeads][D]
+static void cpuDecode(const float* q, const vector<float>& kHist, const vector<float>& vHist, int len,
+                      int numKVHeads, int kvHead, int D, float scale, float* out) {
+    vector<double> p(len);
+    double m = -INFINITY, sum = 0.0;
+    for (int t = 0; t < len; t++) {
+        double dot = 0.0;
+        for (int d = 0; d < D; d++) dot += (double)q[d] * kHist[((size_t)t * numKVHeads + kvHead) * D + d];
+        p[t] = dot * scale;
+        m = max(m, p[t]);
+    }
+    for (int t = 0; t < len; t++) {
+        p[t] = exp(p[t] - m);
+        sum += p[t];
+    }
+    for (int d = 0; d < D; d++) {
+        double acc = 0.0;
+        for (int t = 0; t < len; t++) acc += p[t] * vHist[((size_t)t * numKVHeads + kvHead) * D + d];
+        out[d] = (float)(acc / sum);
+    }
+}
+
+int main(int argc, char** argv) {
+    int numSeqs = 8, numHeads = 8, numKVHeads = 8, D = 64, blockSize = 16, steps = 64;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--seqs") numSeqs = stoi(argv[++i]);
+        else if (arg == "--heads") numHeads = stoi(argv[++i]);
+        else if (arg == "--kv-heads") numKVHeads = stoi(argv[++i]);
+        else if (arg == "--dim") D = stoi(argv[++i]);
+        else if (arg == "--block") blockSize = stoi(argv[++i]);
+        else if (arg == "--steps") steps = stoi(argv[++i]);
+    }
+    if (numHeads % numKVHeads != 0) {
+        cout << "Error: --heads must be a multiple of --kv-heads" << endl;
+        return 1;
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    // --- Build Section ---
+    string src = readKernelFile("Inference/kernels/paged_attention.cl");
+    string options = "-cl-std=CL2.0 -DHEAD_DIM=" + to_string(D) + " -DBLOCK_SIZE=" + to_string(blockSize);
+    cl::Program program = buildProgram(context, device, src, options);
+    cl::Kernel kernelAppend(program, "paged_kv_append");
+    cl::Kernel kernelDecode(program, "paged_attention_decode");
+
+    // Prompts of different lengths so sequences cross block boundaries at different steps
+    vector<int> promptLens(numSeqs);
+    int maxLen = 0;
+    for (int s = 0; s < numSeqs; s++) {
+        promptLens[s] = 37 + 23 * s;
+        maxLen = max(maxLen, promptLens[s] + steps);
+    }
+    int maxBlocksPerSeq = (maxLen + blockSize - 1) / blockSize;
+    int numBlocks = numSeqs * maxBlocksPerSeq;
+
+    PagedKVCache cache(context, numKVHeads, D, blockSize, numBlocks, numSeqs, maxBlocksPerSeq);
+    double poolMB = 2.0 * sizeof(float) * cache.blockElements() * numBlocks / (1024.0 * 1024.0);
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Sequences          : " << numSeqs << " (prompts " << promptLens.front() << ".." << promptLens.back() << " tokens)" << endl;
+    cout << "Heads / KV Heads   : " << numHeads << " / " << numKVHeads << " x " << D << endl;
+    cout << "KV Pool            : " << numBlocks << " blocks x " << blockSize << " tokens (" << fixed << setprecision(1) << poolMB << " MB K+V)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    float scale = 1.0f / sqrt((float)D);
+    size_t kvRow = (size_t)numKVHeads * D;
+    auto fill = [](vector<float>& v, float seed) {
+        for (size_t i = 0; i < v.size(); i++) v[i] = sin(seed + 0.013f * i);
+    };
+
+    // --- Prefill: scatter each prompt's K/V into the cache ---
+    vector<vector<float>> kHist(numSeqs), vHist(numSeqs);
+    for (int s = 0; s < numSeqs; s++) {
+        int seq = cache.addSequence();
+        kHist[s].resize(promptLens[s] * kvRow);
+        vHist[s].resize(promptLens[s] * kvRow);
+        fill(kHist[s], 1.0f + s);
+        fill(vHist[s], 2.0f + s);
+        cl::Buffer kNew(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * kHist[s].size(), kHist[s].data());
+        cl::Buffer vNew(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * vHist[s].size(), vHist[s].data());
+        cache.appendTokens(queue, kernelAppend, seq, kNew, vNew, promptLens[s]);
+    }
+    queue.finish();
+
+    // --- Decode Loop ---
+    vector<int> batch(numSeqs);
+    for (int s = 0; s < numSeqs; s++) batch[s] = s;
+
+    vector<float> Q((size_t)numSeqs * numHeads * D), O(Q.size()), kStep(numSeqs * kvRow), vStep(numSeqs * kvRow);
+    cl::Buffer bufQ(context, CL_MEM_READ_ONLY, sizeof(float) * Q.size());
+    cl::Buffer bufO(context, CL_MEM_WRITE_ONLY, sizeof(float) * O.size());
+    cl::Buffer bufK(context, CL_MEM_READ_ONLY, sizeof(float) * kStep.size());
+    cl::Buffer bufV(context, CL_MEM_READ_ONLY, sizeof(float) * vStep.size());
+
+    kernelDecode.setArg(0, bufQ);
+    cache.setDecodeArgs(kernelDecode);
+    kernelDecode.setArg(5, bufO);
+    kernelDecode.setArg(6, numHeads);
+    kernelDecode.setArg(9, scale);
+
+    double kernelMs = 0.0, stepMs = 0.0, maxErr = 0.0;
+    double contiguousCopyMB = 0.0;
+
+    for (int step = 0; step < steps; step++) {
+        fill(Q, 0.1f * step);
+        fill(kStep, 3.0f + 0.1f * step);
+        fill(vStep, 4.0f + 0.1f * step);
+
+        auto t0 = chrono::high_resolution_clock::now();
+        queue.enqueueWriteBuffer(bufQ, CL_FALSE, 0, sizeof(float) * Q.size(), Q.data());
+        queue.enqueueWriteBuffer(bufK, CL_FALSE, 0, sizeof(float) * kStep.size(), kStep.data());
+        queue.enqueueWriteBuffer(bufV, CL_FALSE, 0, sizeof(float) * vStep.size(), vStep.data());
+        if (!cache.appendDecode(queue, kernelAppend, batch, bufK, bufV)) return 1;
+        cache.syncTables(queue);
+
+        cl::Event evDecode;
+        queue.enqueueNDRangeKernel(kernelDecode, cl::NullRange, cl::NDRange(D, numHeads, numSeqs),
+                                   cl::NDRange(D, 1, 1), nullptr, &evDecode);
+        queue.enqueueReadBuffer(bufO, CL_TRUE, 0, sizeof(float) * O.size(), O.data());
+        auto t1 = chrono::high_resolution_clock::now();
+
+        cl_ulong start = evDecode.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        cl_ulong end = evDecode.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        kernelMs += (end - start) * 1.0e-6;
+        stepMs += chrono::duration<double, milli>(t1 - t0).count();
+
+        for (int s = 0; s < numSeqs; s++) {
+            // A contiguous cache that grows by reallocation copies the whole K+V history every step
+            contiguousCopyMB += 2.0 * sizeof(float) * kHist[s].size() / (1024.0 * 1024.0);
+            kHist[s].insert(kHist[s].end(), kStep.begin() + s * kvRow, kStep.begin() + (s + 1) * kvRow);
+            vHist[s].insert(vHist[s].end(), vStep.begin() + s * kvRow, vStep.begin() + (s + 1) * kvRow);
+        }
+
+        // Verify the first and last steps against the CPU
+        if (step == 0 || step == steps - 1) {
+            vector<float> ref(D);
+            for (int s = 0; s < numSeqs; s++) {
+                for (int h = 0; h < numHeads; h++) {
+                    size_t off = ((size_t)s * numHeads + h) * D;
+                    cpuDecode(&Q[off], kHist[s], vHist[s], cache.length(s), numKVHeads, h / (numHeads / numKVHeads), D, scale, ref.data());
+                    for (int d = 0; d < D; d++) maxErr = max(maxErr, (double)std::abs(ref[d] - O[off + d]));
+                }
+            }
+        }
+    }
+
+    // --- Results ---
+    size_t usedBlocks = numBlocks - cache.freeBlockCount();
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(36) << "Decode steps" << ": " << steps << " x " << numSeqs << " sequences" << endl;
+    cout << left << setw(36) << "Avg decode kernel" << ": " << fixed << setprecision(3) << kernelMs / steps << " ms" << endl;
+    cout << left << setw(36) << "Avg step (append + attend + read)" << ": " << stepMs / steps << " ms" << endl;
+    cout << left << setw(36) << "Throughput" << ": " << setprecision(1) << numSeqs * steps / (stepMs / 1000.0) << " tokens/s" << endl;
+    cout << left << setw(36) << "Blocks in use" << ": " << usedBlocks << " / " << numBlocks << endl;
+    cout << left << setw(36) << "Unfilled slots in claimed blocks" << ": " << cache.internalFragmentation() << " tokens" << endl;
+    cout << left << setw(36) << "History copied (paged)" << ": 0.0 MB" << endl;
+    cout << left << setw(36) << "History copied (contiguous realloc)" << ": " << contiguousCopyMB << " MB" << endl;
+    cout << left << setw(36) << "Max error vs CPU" << ": " << scientific << setprecision(2) << maxErr
+         << (maxErr < 1e-3 ? "  PASS" : "  FAIL") << endl;
+    cout << "-----------------------------------------------------------" << endl;
+
+    return maxErr < 1e-3 ? 0 : 1;
+}
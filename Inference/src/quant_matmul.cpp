@@ -0,0 +1,226 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/quantize.hpp"
+
+using namespace std;
+
+// Usage: quant_matmul [--device <spec>] [--shape NxK] [--batch M] [--group G] [--reps R]
+// Weight-only int8 / int4 GEMV and GEMM against the float32 naive_matmul result.
+// "Err vs FP32" is the end-to-end quantization error; "Result" checks each kernel against the
+// exact dequantized weights on the CPU, so it isolates kernel bugs from quantization loss.
+
+int main(int argc, char** argv) {
+    int N = 4096, K = 4096, M = 32, groupSize = 64, reps = 10;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--shape") sscanf(argv[++i], "%dx%d", &N, &K);
+        else if (arg == "--batch") M = stoi(argv[++i]);
+        else if (arg == "--group") groupSize = stoi(argv[++i]);
+        else if (arg == "--reps") reps = stoi(argv[++i]);
+    }
+    if (groupSize % 8 != 0 || K % groupSize != 0) {
+        cout << "Error: group size must be a multiple of 8 and divide K" << endl;
+        return 1;
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    string extensions = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    bool hasFP16 = (extensions.find("cl_khr_fp16") != string::npos);
+    cl_ulong maxAlloc = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+    size_t maxWGSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    int wgSize = 256;
+    while ((size_t)wgSize > maxWGSize) wgSize /= 2;
+
+    // Largest square weight matrix that fits one allocation at each precision
+    auto maxSquare = [&](double bytesPerWeight) { return (long)sqrt(maxAlloc / bytesPerWeight); };
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Native FP16 Support: " << (hasFP16 ? "YES" : "NO (half storage only)") << endl;
+    cout << "Weights (N x K)    : " << N << " x " << K << ", group " << groupSize << ", GEMM batch " << M << endl;
+    cout << "Max Single Buffer  : " << maxAlloc / (1024 * 1024) << " MB -> largest square weight: FP32 "
+         << maxSquare(4.0) << ", INT8 " << maxSquare(1.0) << ", INT4 " << maxSquare(0.5) << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    // --- Data & Host Quantization ---
+    vector<float> W((size_t)N * K), A((size_t)M * K);
+    for (size_t i = 0; i < W.size(); i++) W[i] = 0.05f * sin(0.7f * i) * cos(0.013f * i);
+    for (size_t i = 0; i < A.size(); i++) A[i] = sin(0.01f * i + 0.3f);
+
+    // naive_matmul computes A * B with B = [K][N], so hand it W^T
+    vector<float> WT((size_t)K * N);
+    for (int n = 0; n < N; n++)
+        for (int k = 0; k < K; k++) WT[(size_t)k * N + n] = W[(size_t)n * K + k];
+
+    QuantizedWeights q8 = quantizeWeights(W.data(), N, K, 8, groupSize);
+    QuantizedWeights q4 = quantizeWeights(W.data(), N, K, 4, groupSize);
+
+    // Activations as the half-precision kernels see them
+    vector<uint16_t> A_half = toHalf(A);
+    vector<float> A_rounded(A.size());
+    for (size_t i = 0; i < A.size(); i++) A_rounded[i] = halfToFloat(A_half[i]);
+
+    // --- Build Section ---
+    string naiveSrc = readKernelFile("Vector_Foundations/kernels/naive_matmul.cl");
+    string gemvSrc = readKernelFile("Inference/kernels/gemv.cl");
+    string quantSrc = readKernelFile("Inference/kernels/quant_matmul.cl");
+
+    cl::Program naiveProgram = buildProgram(context, device, naiveSrc);
+    cl::Program gemvProgram = buildProgram(context, device, gemvSrc, "-cl-std=CL2.0 -DVEC=4 -DWG_SIZE=" + to_string(wgSize));
+    auto quantProgram = [&](int bits, bool halfAct) {
+        string options = "-cl-std=CL2.0 -DQBITS=" + to_string(bits) + " -DGROUP_SIZE=" + to_string(groupSize) +
+                         " -DWG_SIZE=" + to_string(wgSize);
+        if (halfAct) options += hasFP16 ? " -DHALF_ACT -DHAS_FP16" : " -DHALF_ACT";
+        return buildProgram(context, device, quantSrc, options);
+    };
+
+    // --- Device Buffers ---
+    auto upload = [&](const void* data, size_t bytes) {
+        return cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, bytes, const_cast<void*>(data));
+    };
+    cl::Buffer bufW = upload(W.data(), sizeof(float) * W.size());
+    cl::Buffer bufWT = upload(WT.data(), sizeof(float) * WT.size());
+    cl::Buffer bufA = upload(A.data(), sizeof(float) * A.size());
+    cl::Buffer bufA_half = upload(A_half.data(), sizeof(uint16_t) * A_half.size());
+    cl::Buffer bufC(context, CL_MEM_WRITE_ONLY, sizeof(float) * M * N);
+    cl::Buffer bufY(context, CL_MEM_WRITE_ONLY, sizeof(float) * N);  // GEMV output, so bufC keeps the GEMM results
+
+    struct QBuffers { cl::Buffer q, scales, zeros; };
+    auto uploadQ = [&](const QuantizedWeights& qw) {
+        return QBuffers{upload(qw.q.data(), qw.q.size()), upload(qw.scales.data(), sizeof(float) * qw.scales.size()),
+                        upload(qw.zeros.data(), qw.zeros.size())};
+    };
+    QBuffers b8 = uploadQ(q8), b4 = uploadQ(q4);
+
+    auto median_ms = [&](cl::Kernel& kernel, cl::NDRange global, cl::NDRange local) {
+        vector<double> times;
+        for (int r = 0; r <= reps; r++) {
+            cl::Event ev;
+            queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &ev);
+            ev.wait();
+            double ms = (ev.getProfilingInfo<CL_PROFILING_COMMAND_END>() - ev.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+            if (r > 0) times.push_back(ms);  // r == 0 is warmup
+        }
+        sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    };
+
+    // --- FP32 Reference: naive_matmul over all M rows (row 0 doubles as the GEMV reference) ---
+    vector<float> C_ref((size_t)M * N);
+    cl::Kernel kNaive(naiveProgram, "naive_matmul");
+    kNaive.setArg(0, bufA); kNaive.setArg(1, bufWT); kNaive.setArg(2, bufC);
+    kNaive.setArg(3, M); kNaive.setArg(4, N); kNaive.setArg(5, K);
+    double tNaive = median_ms(kNaive, cl::NDRange(N, M), cl::NullRange);
+    queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C_ref.size(), C_ref.data());
+
+    // CPU product of 'rows' rows of 'act' with dequantized 'Wd' ([N][K]); exact reference for the kernels
+    auto cpuRef = [&](const vector<float>& act, const vector<float>& Wd, int rows) {
+        vector<float> out((size_t)rows * N);
+        for (int m = 0; m < rows; m++)
+            for (int n = 0; n < N; n++) {
+                double acc = 0.0;
+                for (int k = 0; k < K; k++) acc += (double)act[(size_t)m * K + k] * Wd[(size_t)n * K + k];
+                out[(size_t)m * N + n] = (float)acc;
+            }
+        return out;
+    };
+    vector<float> W8 = dequantizeWeights(q8), W4 = dequantizeWeights(q4);
+    int checkRows = min(M, 4);
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(24) << "Kernel"
+         << setw(13) << "Weights(MB)"
+         << setw(12) << "Median(ms)"
+         << setw(10) << "GB/s"
+         << setw(14) << "Err vs FP32"
+         << "Result" << endl;
+    cout << string(85, '-') << endl;
+
+    vector<float> C((size_t)M * N);
+    auto report = [&](const string& name, const cl::Buffer& out, double weightBytes, double ms, int rows, const vector<float>* exact, double baseMs) {
+        queue.enqueueReadBuffer(out, CL_TRUE, 0, sizeof(float) * rows * N, C.data());
+        double errFP32 = 0.0, errExact = 0.0, scaleRef = 0.0;
+        for (size_t i = 0; i < (size_t)rows * N; i++) {
+            errFP32 = max(errFP32, (double)std::abs(C[i] - C_ref[i]));
+            scaleRef = max(scaleRef, (double)std::abs(C_ref[i]));
+        }
+        if (exact) {
+            for (size_t i = 0; i < exact->size(); i++) errExact = max(errExact, (double)std::abs(C[i] - (*exact)[i]));
+        }
+        // Half-precision products drift further from the double-precision reference
+        double tol = 1e-3 * (1.0 + scaleRef) * (name.find("FP16") != string::npos ? 8.0 : 1.0);
+        string result = !exact ? "Reference" : (errExact <= tol ? "PASS" : "FAIL");
+        if (exact && baseMs > 0.0) result += " | Speedup: " + to_string(baseMs / ms).substr(0, 4) + "x";
+
+        cout << left << setw(24) << name
+             << setw(13) << fixed << setprecision(2) << weightBytes / (1024.0 * 1024.0)
+             << setw(12) << setprecision(3) << ms
+             << setw(10) << setprecision(1) << weightBytes / (ms * 1.0e6)
+             << setw(14) << scientific << setprecision(2) << errFP32 << fixed
+             << result << endl;
+    };
+
+    // --- 1. GEMV (batch 1): y = W x, x = row 0 of A ---
+    cl::Kernel kGemv(gemvProgram, "gemv");
+    kGemv.setArg(0, bufW); kGemv.setArg(1, bufA); kGemv.setArg(2, bufY); kGemv.setArg(3, N); kGemv.setArg(4, K);
+    double tGemv = median_ms(kGemv, cl::NDRange((size_t)N * wgSize), cl::NDRange(wgSize));
+    report("GEMV FP32 (float4)", bufY, 4.0 * N * K, tGemv, 1, nullptr, 0.0);
+
+    for (bool halfAct : {false, true}) {
+        const vector<float>& act = halfAct ? A_rounded : A;
+        for (int bits : {8, 4}) {
+            const QuantizedWeights& qw = (bits == 8) ? q8 : q4;
+            QBuffers& b = (bits == 8) ? b8 : b4;
+            cl::Program program = quantProgram(bits, halfAct);
+            cl::Kernel k(program, "qgemv");
+            k.setArg(0, b.q); k.setArg(1, b.scales); k.setArg(2, b.zeros);
+            k.setArg(3, halfAct ? bufA_half : bufA); k.setArg(4, bufY); k.setArg(5, N); k.setArg(6, K);
+            double ms = median_ms(k, cl::NDRange((size_t)N * wgSize), cl::NDRange(wgSize));
+            vector<float> exact = cpuRef(act, bits == 8 ? W8 : W4, 1);
+            string name = "GEMV INT" + to_string(bits) + (halfAct ? (hasFP16 ? " FP16" : " FP16-store") : "");
+            report(name, bufY, (double)qw.bytes(), ms, 1, &exact, tGemv);
+        }
+    }
+    cout << string(85, '-') << endl;
+
+    // --- 2. GEMM (batch M): C = A W^T ---
+    report("GEMM FP32 (naive)", bufC, 4.0 * N * K, tNaive, M, nullptr, 0.0);
+    TuneParams tile = matmulDefaults("matmul", queryLimits(device));
+    int ts = tile.get("TileSize");
+    cl::NDRange gemmGlobal(roundUp(N, ts), roundUp(M, ts)), gemmLocal(ts, ts);
+
+    for (bool halfAct : {false, true}) {
+        const vector<float>& act = halfAct ? A_rounded : A;
+        for (int bits : {8, 4}) {
+            const QuantizedWeights& qw = (bits == 8) ? q8 : q4;
+            QBuffers& b = (bits == 8) ? b8 : b4;
+            string options = "-cl-std=CL2.0 -DQBITS=" + to_string(bits) + " -DGROUP_SIZE=" + to_string(groupSize) +
+                             " -DTileSize=" + to_string(ts) + (halfAct ? " -DHALF_ACT" : "");
+            cl::Program program = buildProgram(context, device, quantSrc, options);
+            cl::Kernel k(program, "qgemm");
+            k.setArg(0, halfAct ? bufA_half : bufA); k.setArg(1, b.q); k.setArg(2, b.scales); k.setArg(3, b.zeros);
+            k.setArg(4, bufC); k.setArg(5, M); k.setArg(6, N); k.setArg(7, K);
+            double ms = median_ms(k, gemmGlobal, gemmLocal);
+            vector<float> exact = cpuRef(act, bits == 8 ? W8 : W4, checkRows);
+            string name = "GEMM INT" + to_string(bits) + (halfAct ? " FP16-store" : "");
+            report(name, bufC, (double)qw.bytes(), ms, M, &exact, tNaive);
+        }
+    }
+    cout << string(85, '-') << endl;
+
+    return 0;
+}
@@ -0,0 +1,524 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <string>
+#include <algorithm>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/epilogue.hpp"
+#include "utils/layer_ops.hpp"
+#include "utils/paged_kv_cache.hpp"
+#include "utils/device_arena.hpp"
+#include "utils/weight_file.hpp"
+
+using namespace std;
+
+// Usage: transformer_block [--device <spec>] [--model tiny_model.oclw] [--generate] [--seqs S] [--prompt P] [--steps G]
+//        model generation: [--dim 256] [--layers 2] [--heads 8] [--kv-heads 4] [--ffn 688] [--vocab 512]
+// Loads a LLaMA-style decoder from an .oclw weight file (utils/weight_file.hpp) and runs greedy
+// decode for S sequences: P prompt tokens, then G generated ones, one position per step through
+// the paged KV cache. If the model file doesn't exist (or --generate is given) a small random
+// model with the requested shape is written first, so the pipeline runs without any download.
+//
+// Per layer: RMSNorm -> Q/K/V projections -> RoPE -> KV append -> paged decode attention ->
+// output projection + residual -> RMSNorm -> SwiGLU MLP + residual, on the project's kernels
+// (gemm_nt with fused epilogues, layer_ops.cl, paged_attention.cl). Sequence 0 is checked
+// against a double-precision CPU forward pass every step.
+
+struct ModelConfig {
+    int dim = 256, layers = 2, heads = 8, kvHeads = 4, ffn = 688, vocab = 512;
+    float eps = 1e-5f, theta = 10000.0f;
+
+    int headDim() const { return dim / heads; }
+    int kvDim() const { return kvHeads * headDim(); }
+};
+
+static string layerName(int l, const string& tensor) { return "layers." + to_string(l) + "." + tensor; }
+
+// splitmix64 -> uniform [-1, 1): deterministic, and unlike sin(i) patterns it gives full-rank weights
+static void synth(vector<float>& v, uint64_t seed, float scale, float offset = 0.0f) {
+    for (size_t i = 0; i < v.size(); i++) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull * (i + 1);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        z ^= z >> 31;
+        v[i] = offset + scale * (float)((double)(z >> 11) / 4503599627370496.0 - 1.0);
+    }
+}
+
+// Weights are [out][in] (the gemm_nt / GEMV layout), scaled by 1/sqrt(in) so activations stay O(1)
+static bool writeTinyModel(const string& path, const ModelConfig& c) {
+    map<string, vector<float>> tensors;
+    WeightFileWriter writer;
+    uint64_t seed = 1;
+    auto add = [&](const string& name, vector<uint64_t> shape, float scale, float offset = 0.0f) {
+        vector<float>& v = tensors[name];
+        v.resize(shape.size() == 1 ? shape[0] : shape[0] * shape[1]);
+        synth(v, seed++ * 1000003ull, scale, offset);
+        writer.addTensor(name, DType::F32, shape, v.data());
+    };
+
+    writer.setMeta("dim", c.dim);
+    writer.setMeta("layers", c.layers);
+    writer.setMeta("heads", c.heads);
+    writer.setMeta("kv_heads", c.kvHeads);
+    writer.setMeta("ffn", c.ffn);
+    writer.setMeta("vocab", c.vocab);
+    writer.setMeta("norm_eps", c.eps);
+    writer.setMeta("rope_theta", c.theta);
+
+    uint64_t D = c.dim, KV = c.kvDim(), F = c.ffn;
+    float inD = 1.0f / sqrt((float)D), inF = 1.0f / sqrt((float)F);
+    add("tok_embeddings", {(uint64_t)c.vocab, D}, 1.0f);
+    for (int l = 0; l < c.layers; l++) {
+        add(layerName(l, "attention_norm"), {D}, 0.1f, 1.0f);
+        add(layerName(l, "attention.wq"), {D, D}, inD);
+        add(layerName(l, "attention.wk"), {KV, D}, inD);
+        add(layerName(l, "attention.wv"), {KV, D}, inD);
+        add(layerName(l, "attention.wo"), {D, D}, inD);
+        add(layerName(l, "ffn_norm"), {D}, 0.1f, 1.0f);
+        add(layerName(l, "feed_forward.w1"), {F, D}, inD);  // Gate
+        add(layerName(l, "feed_forward.w3"), {F, D}, inD);  // Up
+        add(layerName(l, "feed_forward.w2"), {D, F}, inF);  // Down
+    }
+    add("norm", {D}, 0.1f, 1.0f);
+    add("output", {(uint64_t)c.vocab, D}, inD);
+    return writer.write(path);
+}
+
+static ModelConfig readConfig(const MappedWeightFile& f) {
+    ModelConfig c;
+    c.dim = (int)f.meta("dim", 0);
+    c.layers = (int)f.meta("layers", 0);
+    c.heads = (int)f.meta("heads", 0);
+    c.kvHeads = (int)f.meta("kv_heads", c.heads);
+    c.ffn = (int)f.meta("ffn", 0);
+    c.vocab = (int)f.meta("vocab", 0);
+    c.eps = (float)f.meta("norm_eps", 1e-5);
+    c.theta = (float)f.meta("rope_theta", 10000.0);
+    if (c.dim <= 0 || c.layers <= 0 || c.heads <= 0 || c.kvHeads <= 0 || c.ffn <= 0 || c.vocab <= 0 ||
+        c.dim % c.heads != 0 || c.heads % c.kvHeads != 0) {
+        cerr << "Error: " << f.path() << ": missing or inconsistent model metadata" << endl;
+        exit(1);
+    }
+    return c;
+}
+
+// --- CPU Reference (double precision, one sequence) ---
+
+class CpuDecoder {
+public:
+    CpuDecoder(const MappedWeightFile& f, const ModelConfig& c) : f_(f), c_(c), k_(c.layers), v_(c.layers) {}
+
+    vector<double> step(int token, int pos) {
+        int D = c_.dim, hd = c_.headDim(), group = c_.heads / c_.kvHeads;
+        vector<double> x(D);
+        const float* emb = w("tok_embeddings") + (size_t)token * D;
+        for (int i = 0; i < D; i++) x[i] = emb[i];
+
+        for (int l = 0; l < c_.layers; l++) {
+            vector<double> h = rmsnorm(x, w(layerName(l, "attention_norm")));
+            vector<double> q = matvec(h, w(layerName(l, "attention.wq")), D, D);
+            vector<double> k = matvec(h, w(layerName(l, "attention.wk")), c_.kvDim(), D);
+            vector<double> v = matvec(h, w(layerName(l, "attention.wv")), c_.kvDim(), D);
+            rope(q, c_.heads, pos);
+            rope(k, c_.kvHeads, pos);
+            k_[l].insert(k_[l].end(), k.begin(), k.end());
+            v_[l].insert(v_[l].end(), v.begin(), v.end());
+
+            int len = pos + 1;
+            vector<double> o(D);
+            for (int hh = 0; hh < c_.heads; hh++) {
+                int kvh = hh / group;
+                vector<double> p(len);
+                double m = -INFINITY, sum = 0.0;
+                for (int t = 0; t < len; t++) {
+                    double dot = 0.0;
+                    for (int d = 0; d < hd; d++) dot += q[hh * hd + d] * k_[l][((size_t)t * c_.kvHeads + kvh) * hd + d];
+                    p[t] = dot / sqrt((double)hd);
+                    m = max(m, p[t]);
+                }
+                for (int t = 0; t < len; t++) sum += (p[t] = exp(p[t] - m));
+                for (int d = 0; d < hd; d++) {
+                    double acc = 0.0;
+                    for (int t = 0; t < len; t++) acc += p[t] * v_[l][((size_t)t * c_.kvHeads + kvh) * hd + d];
+                    o[hh * hd + d] = acc / sum;
+                }
+            }
+            vector<double> attn = matvec(o, w(layerName(l, "attention.wo")), D, D);
+            for (int i = 0; i < D; i++) x[i] += attn[i];
+
+            h = rmsnorm(x, w(layerName(l, "ffn_norm")));
+            vector<double> g = matvec(h, w(layerName(l, "feed_forward.w1")), c_.ffn, D);
+            vector<double> u = matvec(h, w(layerName(l, "feed_forward.w3")), c_.ffn, D);
+            for (int i = 0; i < c_.ffn; i++) g[i] = g[i] / (1.0 + exp(-g[i])) * u[i];
+            vector<double> down = matvec(g, w(layerName(l, "feed_forward.w2")), D, c_.ffn);
+            for (int i = 0; i < D; i++) x[i] += down[i];
+        }
+        return matvec(rmsnorm(x, w("norm")), w("output"), c_.vocab, D);
+    }
+
+private:
+    const float* w(const string& name) const { return f_.as<float>(*f_.find(name)); }
+
+    vector<double> rmsnorm(const vector<double>& x, const float* weight) const {
+        double ss = 0.0;
+        for (double v : x) ss += v * v;
+        double inv = 1.0 / sqrt(ss / x.size() + c_.eps);
+        vector<double> y(x.size());
+        for (size_t i = 0; i < x.size(); i++) y[i] = x[i] * inv * weight[i];
+        return y;
+    }
+
+    // W is [N][K]
+    static vector<double> matvec(const vector<double>& x, const float* W, int N, int K) {
+        vector<double> y(N, 0.0);
+        for (int n = 0; n < N; n++) {
+            double acc = 0.0;
+            for (int k = 0; k < K; k++) acc += x[k] * W[(size_t)n * K + k];
+            y[n] = acc;
+        }
+        return y;
+    }
+
+    void rope(vector<double>& x, int heads, int pos) const {
+        int hd = c_.headDim();
+        for (int h = 0; h < heads; h++) {
+            for (int i = 0; i < hd / 2; i++) {
+                double angle = pos * pow((double)c_.theta, -2.0 * i / hd);
+                double* p = &x[(size_t)h * hd + 2 * i];
+                double a = p[0], b = p[1];
+                p[0] = a * cos(angle) - b * sin(angle);
+                p[1] = a * sin(angle) + b * cos(angle);
+            }
+        }
+    }
+
+    const MappedWeightFile& f_;
+    ModelConfig c_;
+    vector<vector<double>> k_, v_;  // Per layer: [pos][kvHeads][headDim]
+};
+
+int main(int argc, char** argv) {
+    auto tStart = chrono::steady_clock::now();
+    string modelPath = "tiny_model.oclw";
+    bool generate = false;
+    int numSeqs = 4, promptLen = 16, genSteps = 32;
+    ModelConfig gen;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--generate") generate = true;
+        else if (arg == "--model" && hasValue) modelPath = argv[++i];
+        else if (arg == "--seqs" && hasValue) numSeqs = max(1, stoi(argv[++i]));
+        else if (arg == "--prompt" && hasValue) promptLen = max(1, stoi(argv[++i]));
+        else if (arg == "--steps" && hasValue) genSteps = max(1, stoi(argv[++i]));
+        else if (arg == "--dim" && hasValue) gen.dim = stoi(argv[++i]);
+        else if (arg == "--layers" && hasValue) gen.layers = stoi(argv[++i]);
+        else if (arg == "--heads" && hasValue) gen.heads = stoi(argv[++i]);
+        else if (arg == "--kv-heads" && hasValue) gen.kvHeads = stoi(argv[++i]);
+        else if (arg == "--ffn" && hasValue) gen.ffn = stoi(argv[++i]);
+        else if (arg == "--vocab" && hasValue) gen.vocab = stoi(argv[++i]);
+    }
+
+    // --- Model File ---
+    bool generated = false;
+    if (generate || !ifstream(modelPath).good()) {
+        if (gen.dim % gen.heads != 0 || gen.heads % gen.kvHeads != 0) {
+            cerr << "Error: --dim must be a multiple of --heads, and --heads a multiple of --kv-heads" << endl;
+            return 1;
+        }
+        if (!writeTinyModel(modelPath, gen)) return 1;
+        generated = true;
+        tStart = chrono::steady_clock::now();  // Generating the file is not part of startup
+    }
+
+    auto file = make_shared<MappedWeightFile>();
+    auto tMap = chrono::steady_clock::now();
+    if (!file->open(modelPath)) return 1;
+    double mapMs = chrono::duration<double, milli>(chrono::steady_clock::now() - tMap).count();
+    ModelConfig cfg = readConfig(*file);
+    const int D = cfg.dim, H = cfg.heads, KVH = cfg.kvHeads, hd = cfg.headDim(), F = cfg.ffn, V = cfg.vocab;
+
+    // Every tensor the runner reads, with its expected size
+    file->require("tok_embeddings", (uint64_t)V * D);
+    file->require("norm", D);
+    file->require("output", (uint64_t)V * D);
+    for (int l = 0; l < cfg.layers; l++) {
+        file->require(layerName(l, "attention_norm"), D);
+        file->require(layerName(l, "attention.wq"), (uint64_t)D * D);
+        file->require(layerName(l, "attention.wk"), (uint64_t)cfg.kvDim() * D);
+        file->require(layerName(l, "attention.wv"), (uint64_t)cfg.kvDim() * D);
+        file->require(layerName(l, "attention.wo"), (uint64_t)D * D);
+        file->require(layerName(l, "ffn_norm"), D);
+        file->require(layerName(l, "feed_forward.w1"), (uint64_t)F * D);
+        file->require(layerName(l, "feed_forward.w3"), (uint64_t)F * D);
+        file->require(layerName(l, "feed_forward.w2"), (uint64_t)D * F);
+    }
+    for (auto& t : file->tensors()) {
+        if (t.dtype != DType::F32) {
+            cerr << "Error: tensor '" << t.name << "' is " << dtypeName(t.dtype) << "; this runner reads f32 weights" << endl;
+            return 1;
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    if ((size_t)hd > device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>() || hd % 2 != 0) {
+        cerr << "Error: head dim " << hd << " must be even and fit one work-group (paged_attention_decode)" << endl;
+        return 1;
+    }
+
+    // --- Weight Upload ---
+    DeviceWeights weights = loadWeights(context, queue, device, file);
+    const WeightLoadStats& load = weights.stats();
+
+    // --- Build Section ---
+    auto tBuild = chrono::steady_clock::now();
+    TuningDB tuningDB;
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl");
+    string fusedSrc = withEpilogue(gemmSrc);
+    LayerOpsConfig opsCfg = layerOpsConfig(device, D);
+    cl::Program opsProgram = buildProgram(context, device, readKernelFile("Inference/kernels/layer_ops.cl"), opsCfg.buildOptions());
+    cl::Kernel kRmsnorm(opsProgram, "rmsnorm");
+    cl::Kernel kRope(opsProgram, "rope");
+
+    const int blockSize = min(16, hd);
+    cl::Program attnProgram = buildProgram(context, device, readKernelFile("Inference/kernels/paged_attention.cl"),
+                                           "-cl-std=CL2.0 -DHEAD_DIM=" + to_string(hd) + " -DBLOCK_SIZE=" + to_string(blockSize));
+    cl::Kernel kAppend(attnProgram, "paged_kv_append");
+    cl::Kernel kDecode(attnProgram, "paged_attention_decode");
+
+    Epilogue plain, residual, swiglu = Epilogue::swiglu();
+    residual.residual = true;
+
+    // gemm_nt for C[S][N] = A[S][K] * W[N][K]^T, tuned per shape and built once per option string
+    map<string, cl::Kernel> gemmKernels;
+    auto gemmKernel = [&](int N, int K, const Epilogue& e, TuneParams& p) -> cl::Kernel& {
+        p = matmulParams(tuningDB, device, "gemm_nt", numSeqs, N, K);
+        string options = buildOptions(p) + e.buildOptions();
+        auto it = gemmKernels.find(options);
+        if (it == gemmKernels.end()) {
+            cl::Program program = buildProgram(context, device, e.active() ? fusedSrc : gemmSrc, options);
+            it = gemmKernels.emplace(options, cl::Kernel(program, "gemm_nt")).first;
+        }
+        return it->second;
+    };
+    TuneParams scratch;
+    gemmKernel(D, D, plain, scratch);
+    gemmKernel(cfg.kvDim(), D, plain, scratch);
+    gemmKernel(D, D, residual, scratch);
+    gemmKernel(F, D, plain, scratch);
+    gemmKernel(F, D, swiglu, scratch);
+    gemmKernel(D, F, residual, scratch);
+    gemmKernel(V, D, plain, scratch);
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - tBuild).count();
+
+    // --- Activations & KV Cache ---
+    int maxLen = promptLen + genSteps;
+    int maxBlocksPerSeq = (maxLen + blockSize - 1) / blockSize;
+    vector<PagedKVCache> caches;
+    for (int l = 0; l < cfg.layers; l++) caches.emplace_back(context, KVH, hd, blockSize, numSeqs * maxBlocksPerSeq, numSeqs, maxBlocksPerSeq);
+    vector<int> batch;
+    for (int s = 0; s < numSeqs; s++) batch.push_back(caches[0].addSequence());
+    for (int l = 1; l < cfg.layers; l++) {
+        for (int s = 0; s < numSeqs; s++) caches[l].addSequence();
+    }
+
+    // Lifetimes are steps of one layer (the loop reuses the same buffers every layer):
+    //   0 rmsnorm  1 q/k/v  2 rope  3 KV append  4 attention  5 wo + residual  6 rmsnorm
+    //   7 w1  8 w3 * silu(gate)  9 w2 + residual  10 final norm  11 LM head
+    // The residual stream and the norm output span every step; projections, MLP scratch and the
+    // logits never live at the same time, so they share bytes. The queue is in order, so a
+    // tensor's last reader always finishes before the next writer of the same bytes.
+    size_t S = numSeqs;
+    LifetimePlan plan;
+    auto act = [&](size_t floats, int first, int last) { return plan.add(sizeof(float) * floats, first, last); };
+    int idX = act(S * D, 0, 11), idH = act(S * D, 0, 11), idXAlt = act(S * D, 5, 9);
+    int idQ = act(S * D, 1, 4), idK = act(S * cfg.kvDim(), 1, 3), idV = act(S * cfg.kvDim(), 1, 3), idO = act(S * D, 4, 5);
+    int idGate = act(S * F, 7, 8), idFF = act(S * F, 8, 9), idLogits = act(S * V, 11, 11);
+    DeviceArena arena(context, device);
+    PlannedBuffers activations = allocatePlan(arena, plan);
+    cl::Buffer bufX = activations.buffers[idX], bufXAlt = activations.buffers[idXAlt], bufH = activations.buffers[idH];
+    cl::Buffer bufQ = activations.buffers[idQ], bufO = activations.buffers[idO];
+    cl::Buffer bufK = activations.buffers[idK], bufV = activations.buffers[idV];
+    cl::Buffer bufGate = activations.buffers[idGate], bufFF = activations.buffers[idFF], bufLogits = activations.buffers[idLogits];
+    cl::Buffer bufPos(context, CL_MEM_READ_ONLY, sizeof(int) * S);
+
+    // --- Enqueue Helpers: each appends its event to 'events' ---
+    vector<cl::Event> events;
+    auto gemm = [&](const cl::Buffer& A, const string& weight, const cl::Buffer& C, int N, int K, const Epilogue& e,
+                    const cl::Buffer& res, const cl::Buffer& gate) {
+        TuneParams p;
+        cl::Kernel& k = gemmKernel(N, K, e, p);
+        k.setArg(0, A); k.setArg(1, weights[weight]); k.setArg(2, C);
+        k.setArg(3, numSeqs); k.setArg(4, N); k.setArg(5, K);
+        setEpilogueArgs(k, 6, e, cl::Buffer(), res, gate);
+        events.emplace_back();
+        queue.enqueueNDRangeKernel(k, cl::NullRange, matmulGlobalSize("gemm_nt", p, numSeqs, N),
+                                   cl::NDRange(p.localX, p.localY), nullptr, &events.back());
+        traceCommand(queue, events.back(), weight);
+    };
+    auto rmsnorm = [&](const cl::Buffer& x, const string& weight, const cl::Buffer& y) {
+        kRmsnorm.setArg(0, x); kRmsnorm.setArg(1, weights[weight]); kRmsnorm.setArg(2, y);
+        kRmsnorm.setArg(3, D); kRmsnorm.setArg(4, cfg.eps);
+        events.emplace_back();
+        queue.enqueueNDRangeKernel(kRmsnorm, cl::NullRange, cl::NDRange(S * opsCfg.wgSize), cl::NDRange(opsCfg.wgSize),
+                                   nullptr, &events.back());
+        traceCommand(queue, events.back(), "rmsnorm");
+    };
+    auto rope = [&](const cl::Buffer& x, int heads) {
+        kRope.setArg(0, x); kRope.setArg(1, bufPos); kRope.setArg(2, heads); kRope.setArg(3, hd); kRope.setArg(4, cfg.theta);
+        events.emplace_back();
+        queue.enqueueNDRangeKernel(kRope, cl::NullRange, cl::NDRange(hd / 2, heads, S), cl::NullRange, nullptr, &events.back());
+        traceCommand(queue, events.back(), "rope");
+    };
+
+    // One decode step for every sequence; returns the logits [S][V]
+    vector<float> xHost(S * D), logits(S * V);
+    vector<int> posHost(S);
+    vector<double> layerMs(cfg.layers + 1);  // Last entry: final norm + LM head
+    auto decodeStep = [&](const vector<int>& tokens, int pos) {
+        TraceSpan span("decode step");
+        const float* emb = file->as<float>(*file->find("tok_embeddings"));
+        for (size_t s = 0; s < S; s++) copy(emb + (size_t)tokens[s] * D, emb + (size_t)(tokens[s] + 1) * D, &xHost[s * D]);
+        fill(posHost.begin(), posHost.end(), pos);
+        queue.enqueueWriteBuffer(bufX, CL_FALSE, 0, sizeof(float) * xHost.size(), xHost.data());
+        queue.enqueueWriteBuffer(bufPos, CL_FALSE, 0, sizeof(int) * S, posHost.data());
+
+        vector<size_t> layerStart;
+        events.clear();
+        for (int l = 0; l < cfg.layers; l++) {
+            layerStart.push_back(events.size());
+            rmsnorm(bufX, layerName(l, "attention_norm"), bufH);
+            gemm(bufH, layerName(l, "attention.wq"), bufQ, D, D, plain, cl::Buffer(), cl::Buffer());
+            gemm(bufH, layerName(l, "attention.wk"), bufK, cfg.kvDim(), D, plain, cl::Buffer(), cl::Buffer());
+            gemm(bufH, layerName(l, "attention.wv"), bufV, cfg.kvDim(), D, plain, cl::Buffer(), cl::Buffer());
+            rope(bufQ, H);
+            rope(bufK, KVH);
+            if (!caches[l].appendDecode(queue, kAppend, batch, bufK, bufV)) exit(1);
+            caches[l].syncTables(queue);
+
+            kDecode.setArg(0, bufQ);
+            caches[l].setDecodeArgs(kDecode);
+            kDecode.setArg(5, bufO);
+            kDecode.setArg(6, H);
+            kDecode.setArg(9, 1.0f / sqrt((float)hd));
+            events.emplace_back();
+            queue.enqueueNDRangeKernel(kDecode, cl::NullRange, cl::NDRange(hd, H, S), cl::NDRange(hd, 1, 1), nullptr, &events.back());
+            traceCommand(queue, events.back(), "paged_attention_decode");
+
+            // Residual stream ping-pongs between bufX and bufXAlt; the epilogue adds the old one
+            gemm(bufO, layerName(l, "attention.wo"), bufXAlt, D, D, residual, bufX, cl::Buffer());
+            rmsnorm(bufXAlt, layerName(l, "ffn_norm"), bufH);
+            gemm(bufH, layerName(l, "feed_forward.w1"), bufGate, F, D, plain, cl::Buffer(), cl::Buffer());
+            gemm(bufH, layerName(l, "feed_forward.w3"), bufFF, F, D, swiglu, cl::Buffer(), bufGate);
+            gemm(bufFF, layerName(l, "feed_forward.w2"), bufX, D, F, residual, bufXAlt, cl::Buffer());
+        }
+        layerStart.push_back(events.size());
+        rmsnorm(bufX, "norm", bufH);
+        gemm(bufH, "output", bufLogits, V, D, plain, cl::Buffer(), cl::Buffer());
+        layerStart.push_back(events.size());
+        queue.enqueueReadBuffer(bufLogits, CL_TRUE, 0, sizeof(float) * logits.size(), logits.data());
+
+        // Layer latency: first kernel START to last kernel END, so KV appends and table syncs count
+        for (int l = 0; l <= cfg.layers; l++) {
+            cl_ulong start = events[layerStart[l]].getProfilingInfo<CL_PROFILING_COMMAND_START>();
+            cl_ulong end = events[layerStart[l + 1] - 1].getProfilingInfo<CL_PROFILING_COMMAND_END>();
+            layerMs[l] = (end - start) * 1.0e-6;
+        }
+    };
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Model              : " << modelPath << (generated ? " (generated)" : "") << ", " << file->tensors().size()
+         << " tensors, " << fixed << setprecision(1) << file->fileBytes() / (1024.0 * 1024.0) << " MB" << endl;
+    cout << "Config             : dim " << D << ", " << cfg.layers << " layers, " << H << "/" << KVH << " heads x " << hd
+         << ", ffn " << F << ", vocab " << V << endl;
+    cout << "Batch              : " << numSeqs << " sequences, " << promptLen << " prompt + " << genSteps << " generated tokens" << endl;
+    cout << "Activations        : " << fixed << setprecision(2) << plan.totalBytes() / (1024.0 * 1024.0) << " MB planned vs "
+         << plan.unplannedBytes() / (1024.0 * 1024.0) << " MB as separate buffers" << endl;
+    cout << "Weights            : " << (load.zeroCopy == load.tensors ? "zero-copy (CL_MEM_USE_HOST_PTR on the mapping)"
+                                        : load.zeroCopy ? "partly zero-copy" : "streamed to device buffers") << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    // --- Decode Loop: prompt positions first, then greedy generation ---
+    CpuDecoder reference(*file, cfg);
+    vector<int> tokens(S);
+    for (size_t s = 0; s < S; s++) tokens[s] = (int)((7 * s + 3) % V);
+    double maxErr = 0.0, firstTokenMs = 0.0, decodeMs = 0.0;
+    vector<double> layerSum(cfg.layers + 1, 0.0), layerMin(cfg.layers + 1, 1e30);
+    vector<int> generatedSeq0;
+
+    for (int pos = 0; pos < maxLen; pos++) {
+        auto t0 = chrono::steady_clock::now();
+        decodeStep(tokens, pos);
+        auto t1 = chrono::steady_clock::now();
+
+        vector<double> ref = reference.step(tokens[0], pos);
+        for (int i = 0; i < V; i++) maxErr = max(maxErr, std::abs(ref[i] - logits[i]) / (1.0 + std::abs(ref[i])));
+
+        bool generating = pos >= promptLen - 1;
+        for (size_t s = 0; s < S; s++) {
+            if (generating) tokens[s] = (int)(max_element(&logits[s * V], &logits[(s + 1) * V]) - &logits[s * V]);
+            else tokens[s] = (int)((7 * s + 3 + 11 * (pos + 1)) % V);  // Next prompt token
+        }
+        if (generating) generatedSeq0.push_back(tokens[0]);
+        if (pos == promptLen - 1) firstTokenMs = chrono::duration<double, milli>(t1 - tStart).count();
+        if (pos >= promptLen) {
+            decodeMs += chrono::duration<double, milli>(t1 - t0).count();
+            for (int l = 0; l <= cfg.layers; l++) {
+                layerSum[l] += layerMs[l];
+                layerMin[l] = min(layerMin[l], layerMs[l]);
+            }
+        }
+    }
+    int timedSteps = maxLen - promptLen;
+
+    // --- Results ---
+    cout << "Startup\n-----------------------------------------------------------" << endl;
+    cout << left << setw(19) << "Map + parse" << ": " << fixed << setprecision(3) << mapMs << " ms" << endl;
+    cout << left << setw(19) << "Weight upload" << ": " << load.uploadMs << " ms (" << setprecision(2) << load.gbs() << " GB/s, "
+         << load.tensors << " tensors, " << load.zeroCopy << " zero-copy)" << endl;
+    cout << left << setw(19) << "Kernel build" << ": " << setprecision(3) << buildMs << " ms" << endl;
+    cout << left << setw(19) << "Time to 1st token" << ": " << firstTokenMs << " ms (incl. " << promptLen << " prompt positions)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(12) << "Layer"
+         << setw(14) << "Avg(ms)"
+         << setw(14) << "Min(ms)"
+         << setw(10) << "Share" << endl;
+    cout << string(50, '-') << endl;
+    double total = 0.0;
+    for (double ms : layerSum) total += ms;
+    for (int l = 0; l <= cfg.layers; l++) {
+        cout << left << setw(12) << (l < cfg.layers ? to_string(l) : string("head"))
+             << setw(14) << fixed << setprecision(3) << layerSum[l] / timedSteps
+             << setw(14) << layerMin[l]
+             << setw(10) << setprecision(1) << 100.0 * layerSum[l] / total << endl;
+    }
+    cout << string(50, '-') << endl;
+    cout << left << setw(19) << "Decode step" << ": " << setprecision(3) << decodeMs / timedSteps << " ms" << endl;
+    cout << left << setw(19) << "Throughput" << ": " << setprecision(1) << S * timedSteps / (decodeMs / 1000.0) << " tokens/s" << endl;
+    cout << left << setw(19) << "Seq 0 tokens" << ":";
+    for (size_t i = 0; i < min<size_t>(generatedSeq0.size(), 12); i++) cout << " " << generatedSeq0[i];
+    cout << (generatedSeq0.size() > 12 ? " ..." : "") << endl;
+    cout << left << setw(19) << "Max error vs CPU" << ": " << scientific << setprecision(2) << maxErr
+         << (maxErr < 1e-3 ? "  PASS" : "  FAIL") << endl;
+    cout << "-----------------------------------------------------------" << endl;
+
+    return maxErr < 1e-3 ? 0 : 1;
+}
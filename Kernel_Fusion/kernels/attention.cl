@@ -0,0 +1,61 @@
+// Unfused three-kernel attention: the reference that flash_attention.cl replaces.
+// Every stage round-trips the full [heads][N][N] score matrix S through global memory.
+//
+// Layout: Q, K, V, O are [heads][N][D]; S is [heads][N][N].
+
+// 1. S = Q K^T * scale (masked entries set to -INFINITY)
+__kernel void attention_scores(__global const float* Q, __global const float* K, __global float* S,
+                               int N, int D, float scale, int causal) {
+    int col = get_global_id(0);
+    int row = get_global_id(1);
+    int head = get_global_id(2);
+    if (row >= N || col >= N) return;
+
+    __global const float* q = Q + ((size_t)head * N + row) * D;
+    __global const float* k = K + ((size_t)head * N + col) * D;
+
+    float dot = 0.0f;
+    for (int d = 0; d < D; d++) {
+        dot += q[d] * k[d];
+    }
+    S[((size_t)head * N + row) * N + col] = (causal && col > row) ? -INFINITY : dot * scale;
+}
+
+// 2. Row-wise numerically stable softmax, in place. One work-item per row.
+__kernel void attention_softmax(__global float* S, int N) {
+    int row = get_global_id(0);
+    int head = get_global_id(1);
+    if (row >= N) return;
+
+    __global float* s = S + ((size_t)head * N + row) * N;
+
+    float m = -INFINITY;
+    for (int j = 0; j < N; j++) m = fmax(m, s[j]);
+
+    float sum = 0.0f;
+    for (int j = 0; j < N; j++) {
+        float e = exp(s[j] - m);
+        s[j] = e;
+        sum += e;
+    }
+
+    float inv = 1.0f / sum;
+    for (int j = 0; j < N; j++) s[j] *= inv;
+}
+
+// 3. O = P V
+__kernel void attention_pv(__global const float* P, __global const float* V, __global float* O, int N, int D) {
+    int d = get_global_id(0);
+    int row = get_global_id(1);
+    int head = get_global_id(2);
+    if (row >= N || d >= D) return;
+
+    __global const float* p = P + ((size_t)head * N + row) * N;
+    __global const float* v = V + (size_t)head * N * D;
+
+    float acc = 0.0f;
+    for (int j = 0; j < N; j++) {
+        acc += p[j] * v[(size_t)j * D + d];
+    }
+    O[((size_t)head * N + row) * D + d] = acc;
+}
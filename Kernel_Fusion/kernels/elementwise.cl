@@ -0,0 +1,30 @@
+// Unfused MLP elementwise passes: the reference for fused_mlp.cpp. Each kernel is one full
+// read (and write) of a [rows][N] activation in global memory; the fused GEMM epilogues
+// (Vector_Foundations/kernels/epilogue.cl) do the same math in registers before the store.
+// One work-item per element; the global size is rows * N.
+
+// x[i] += bias[i % N]
+__kernel void add_bias(__global float* x, __global const float* bias, int N) {
+    size_t i = get_global_id(0);
+    x[i] += bias[i % N];
+}
+
+// tanh-form GELU, matching ACT_GELU in epilogue.cl
+__kernel void gelu(__global float* x) {
+    size_t i = get_global_id(0);
+    float v = x[i];
+    x[i] = 0.5f * v * (1.0f + tanh(0.7978845608f * (v + 0.044715f * v * v * v)));
+}
+
+// SwiGLU gating: out = silu(gate) * up
+__kernel void silu_mul(__global const float* gate, __global const float* up, __global float* out) {
+    size_t i = get_global_id(0);
+    float g = gate[i];
+    out[i] = g / (1.0f + exp(-g)) * up[i];
+}
+
+// x[i] += residual[i]
+__kernel void add_residual(__global float* x, __global const float* residual) {
+    size_t i = get_global_id(0);
+    x[i] += residual[i];
+}
@@ -0,0 +1,122 @@
+// Fused attention: O = Softmax(Q K^T * scale) V in a single pass (Flash Attention 2 style).
+//
+// Layout: Q, K, V, O are [heads][N][HEAD_DIM], row-major.
+// Grid:   (ceil(N / BLOCK_M) * BLOCK_M, heads), work-group (BLOCK_M, 1). One work-item owns one query row.
+//
+// K/V are streamed through __local memory BLOCK_N rows at a time. Each row keeps a running max (m),
+// running denominator (l) and an unnormalized output accumulator in registers, rescaling them whenever
+// a new tile raises the max (online softmax). The N x N score matrix never touches global memory.
+#ifndef HEAD_DIM
+#define HEAD_DIM 64
+#endif
+#ifndef BLOCK_M
+#define BLOCK_M 32
+#endif
+#ifndef BLOCK_N
+#define BLOCK_N 32
+#endif
+
+#if BLOCK_M > BLOCK_N
+#error "BLOCK_M must be <= BLOCK_N (the Q and O tiles are staged through the K tile)"
+#endif
+
+__kernel void flash_attention(__global const float* Q, __global const float* K, __global const float* V,
+                              __global float* O, int N, float scale, int causal) {
+    // 1. Identifiers
+    int lid = get_local_id(0);
+    int head = get_group_id(1);
+    int blockStart = get_group_id(0) * BLOCK_M;
+    int row = blockStart + lid;
+
+    size_t headOffset = (size_t)head * N * HEAD_DIM;
+    Q += headOffset;
+    K += headOffset;
+    V += headOffset;
+    O += headOffset;
+
+    // 2. Local Memory (SRAM): one K tile and one V tile
+    __local float TileK[BLOCK_N][HEAD_DIM];
+    __local float TileV[BLOCK_N][HEAD_DIM];
+
+    // 3. Stage the Q block through local memory so the global read is coalesced
+    for (int idx = lid; idx < BLOCK_M * HEAD_DIM; idx += BLOCK_M) {
+        int r = idx / HEAD_DIM, d = idx % HEAD_DIM;
+        TileK[r][d] = (blockStart + r < N) ? Q[(size_t)(blockStart + r) * HEAD_DIM + d] : 0.0f;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // 4. Private Memory (Registers): this row's query, output accumulator and softmax state
+    float q[HEAD_DIM];
+    float acc[HEAD_DIM];
+    for (int d = 0; d < HEAD_DIM; d++) {
+        q[d] = TileK[lid][d] * scale;  // Fold the scale into Q once instead of per score
+        acc[d] = 0.0f;
+    }
+    float m = -INFINITY;
+    float l = 0.0f;
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    // With causal masking, no row in this block attends past the block's last row
+    int kvEnd = causal ? min(N, blockStart + BLOCK_M) : N;
+    int numTiles = (kvEnd + BLOCK_N - 1) / BLOCK_N;
+
+    for (int t = 0; t < numTiles; t++) {
+        int tileStart = t * BLOCK_N;
+
+        // Load K/V tiles cooperatively (coalesced along HEAD_DIM)
+        for (int idx = lid; idx < BLOCK_N * HEAD_DIM; idx += BLOCK_M) {
+            int r = idx / HEAD_DIM, d = idx % HEAD_DIM;
+            bool valid = tileStart + r < N;
+            TileK[r][d] = valid ? K[(size_t)(tileStart + r) * HEAD_DIM + d] : 0.0f;
+            TileV[r][d] = valid ? V[(size_t)(tileStart + r) * HEAD_DIM + d] : 0.0f;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // Scores for this tile. Every work-item reads the same TileK row, so the loads broadcast.
+        float s[BLOCK_N];
+        float tileMax = -INFINITY;
+        for (int j = 0; j < BLOCK_N; j++) {
+            int col = tileStart + j;
+            float dot = 0.0f;
+            for (int d = 0; d < HEAD_DIM; d++) {
+                dot += q[d] * TileK[j][d];
+            }
+            bool masked = col >= N || (causal && col > row);
+            s[j] = masked ? -INFINITY : dot;
+            tileMax = fmax(tileMax, s[j]);
+        }
+
+        // Online softmax: rescale the running state to the new max, then accumulate P V
+        float mNew = fmax(m, tileMax);
+        if (mNew != -INFINITY) {
+            float correction = exp(m - mNew);
+            l *= correction;
+            for (int d = 0; d < HEAD_DIM; d++) {
+                acc[d] *= correction;
+            }
+            for (int j = 0; j < BLOCK_N; j++) {
+                float p = exp(s[j] - mNew);
+                l += p;
+                for (int d = 0; d < HEAD_DIM; d++) {
+                    acc[d] += p * TileV[j][d];
+                }
+            }
+            m = mNew;
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // 5. Normalize, then stage the O block through local memory for a coalesced write
+    float invL = (l > 0.0f) ? 1.0f / l : 0.0f;
+    for (int d = 0; d < HEAD_DIM; d++) {
+        TileK[lid][d] = acc[d] * invL;
+    }
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    for (int idx = lid; idx < BLOCK_M * HEAD_DIM; idx += BLOCK_M) {
+        int r = idx / HEAD_DIM, d = idx % HEAD_DIM;
+        if (blockStart + r < N) {
+            O[(size_t)(blockStart + r) * HEAD_DIM + d] = TileK[r][d];
+        }
+    }
+}
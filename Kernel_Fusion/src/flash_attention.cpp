@@ -0,0 +1,210 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+
+using namespace std;
+
+// Usage: flash_attention [--device <spec>] [--heads H] [--dim 64|128] [--causal] [--seq 128,256,...]
+
+// CPU reference for one head, accumulated in double
+static void cpuAttention(const float* Q, const float* K, const float* V, float* O, int N, int D, float scale, bool causal) {
+    vector<double> p(N);
+    for (int i = 0; i < N; i++) {
+        double m = -INFINITY;
+        for (int j = 0; j < N; j++) {
+            double dot = 0.0;
+            for (int d = 0; d < D; d++) dot += (double)Q[i * D + d] * K[j * D + d];
+            p[j] = (causal && j > i) ? -INFINITY : dot * scale;
+            m = max(m, p[j]);
+        }
+        double sum = 0.0;
+        for (int j = 0; j < N; j++) {
+            p[j] = exp(p[j] - m);
+            sum += p[j];
+        }
+        for (int d = 0; d < D; d++) {
+            double acc = 0.0;
+            for (int j = 0; j < N; j++) acc += p[j] * V[j * D + d];
+            O[i * D + d] = (float)(acc / sum);
+        }
+    }
+}
+
+static double maxAbsDiff(const vector<float>& a, const vector<float>& b, size_t count) {
+    double diff = 0.0;
+    for (size_t i = 0; i < count; i++) diff = max(diff, (double)std::abs(a[i] - b[i]));
+    return diff;
+}
+
+int main(int argc, char** argv) {
+    int heads = 8, D = 64;
+    bool causal = false;
+    vector<int> seqLens = {128, 256, 512, 1024, 2048, 4096};
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--heads" && i + 1 < argc) heads = stoi(argv[++i]);
+        else if (arg == "--dim" && i + 1 < argc) D = stoi(argv[++i]);
+        else if (arg == "--causal") causal = true;
+        else if (arg == "--seq" && i + 1 < argc) {
+            seqLens.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) seqLens.push_back(stoi(item));
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    size_t maxWGSize = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    cl_ulong localMem = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    cl_ulong maxAlloc = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+
+    // Largest K/V tile pair that fits in SRAM, capped at 32 rows
+    int blockN = 32;
+    while (blockN > 1 && 2 * blockN * D * sizeof(float) > localMem) blockN /= 2;
+    int blockM = min(blockN, (int)maxWGSize);
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Local Memory (SRAM): " << localMem / 1024 << " KB per Compute Unit" << endl;
+    cout << "Max Single Buffer  : " << maxAlloc / (1024 * 1024) << " MB" << endl;
+    cout << "Heads x Head Dim   : " << heads << " x " << D << (causal ? " (causal)" : "") << endl;
+    cout << "Flash Tiles        : BLOCK_M=" << blockM << " BLOCK_N=" << blockN
+         << " (" << 2 * blockN * D * sizeof(float) / 1024 << " KB SRAM)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    // --- Build Section ---
+    string flashSrc = readKernelFile("Kernel_Fusion/kernels/flash_attention.cl");
+    string refSrc = readKernelFile("Kernel_Fusion/kernels/attention.cl");
+    string flashOpts = "-cl-std=CL2.0 -DHEAD_DIM=" + to_string(D) + " -DBLOCK_M=" + to_string(blockM) +
+                       " -DBLOCK_N=" + to_string(blockN);
+
+    cl::Program flashProgram = buildProgram(context, device, flashSrc, flashOpts);
+    cl::Program refProgram = buildProgram(context, device, refSrc);
+    cl::Kernel kernelFlash(flashProgram, "flash_attention");
+    cl::Kernel kernelScores(refProgram, "attention_scores");
+    cl::Kernel kernelSoftmax(refProgram, "attention_softmax");
+    cl::Kernel kernelPV(refProgram, "attention_pv");
+
+    auto get_ms = [](cl::Event& e) {
+        e.wait();
+        cl_ulong start, end;
+        e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+        e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
+        return (end - start) * 1.0e-6;
+    };
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(8) << "SeqLen"
+         << setw(14) << "Kernel"
+         << setw(14) << "Kernel(ms)"
+         << setw(16) << "Traffic(MB)"
+         << setw(14) << "MaxErr"
+         << "Result" << endl;
+    cout << string(85, '-') << endl;
+
+    float scale = 1.0f / sqrt((float)D);
+
+    for (int N : seqLens) {
+        size_t qkvCount = (size_t)heads * N * D;
+        size_t scoreBytes = sizeof(float) * heads * (size_t)N * N;
+
+        vector<float> Q(qkvCount), K(qkvCount), V(qkvCount);
+        for (size_t i = 0; i < qkvCount; i++) {
+            Q[i] = sin(0.37f * i) * 0.5f;
+            K[i] = cos(0.11f * i) * 0.5f;
+            V[i] = sin(0.05f * i + 1.0f);
+        }
+        vector<float> O_flash(qkvCount), O_ref(qkvCount);
+
+        cl::Buffer bufQ(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * qkvCount, Q.data());
+        cl::Buffer bufK(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * qkvCount, K.data());
+        cl::Buffer bufV(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * qkvCount, V.data());
+        cl::Buffer bufO(context, CL_MEM_WRITE_ONLY, sizeof(float) * qkvCount);
+
+        // --- 1. Fused Flash Attention ---
+        cl::Event evFlash;
+        kernelFlash.setArg(0, bufQ); kernelFlash.setArg(1, bufK); kernelFlash.setArg(2, bufV); kernelFlash.setArg(3, bufO);
+        kernelFlash.setArg(4, N); kernelFlash.setArg(5, scale); kernelFlash.setArg(6, (int)causal);
+        size_t qBlocks = (N + blockM - 1) / blockM;
+        queue.enqueueNDRangeKernel(kernelFlash, cl::NullRange, cl::NDRange(qBlocks * blockM, heads),
+                                   cl::NDRange(blockM, 1), nullptr, &evFlash);
+        queue.enqueueReadBuffer(bufO, CL_TRUE, 0, sizeof(float) * qkvCount, O_flash.data());
+        double tFlash = get_ms(evFlash);
+
+        // Global traffic model: Q read and O written once; K/V re-read once per query block
+        // (halved on average under causal masking).
+        double kvPasses = causal ? (qBlocks + 1) / 2.0 : (double)qBlocks;
+        double flashMB = sizeof(float) * qkvCount * (2.0 + 2.0 * kvPasses) / (1024.0 * 1024.0);
+        // Unfused: scores reads Q,K and writes S; softmax reads and writes S; PV reads S,V and writes O
+        double unfusedMB = (sizeof(float) * qkvCount * 4.0 + 4.0 * scoreBytes) / (1024.0 * 1024.0);
+
+        // --- 2. Unfused Three-Kernel Reference ---
+        bool refFits = scoreBytes <= maxAlloc;
+        double tRef = 0.0;
+        if (refFits) {
+            cl::Buffer bufS(context, CL_MEM_READ_WRITE, scoreBytes);
+            cl::Event evS, evSoftmax, evPV;
+
+            kernelScores.setArg(0, bufQ); kernelScores.setArg(1, bufK); kernelScores.setArg(2, bufS);
+            kernelScores.setArg(3, N); kernelScores.setArg(4, D); kernelScores.setArg(5, scale); kernelScores.setArg(6, (int)causal);
+            queue.enqueueNDRangeKernel(kernelScores, cl::NullRange, cl::NDRange(N, N, heads), cl::NullRange, nullptr, &evS);
+
+            kernelSoftmax.setArg(0, bufS); kernelSoftmax.setArg(1, N);
+            queue.enqueueNDRangeKernel(kernelSoftmax, cl::NullRange, cl::NDRange(N, heads), cl::NullRange, nullptr, &evSoftmax);
+
+            kernelPV.setArg(0, bufS); kernelPV.setArg(1, bufV); kernelPV.setArg(2, bufO);
+            kernelPV.setArg(3, N); kernelPV.setArg(4, D);
+            queue.enqueueNDRangeKernel(kernelPV, cl::NullRange, cl::NDRange(D, N, heads), cl::NullRange, nullptr, &evPV);
+
+            queue.enqueueReadBuffer(bufO, CL_TRUE, 0, sizeof(float) * qkvCount, O_ref.data());
+            tRef = get_ms(evS) + get_ms(evSoftmax) + get_ms(evPV);
+        }
+
+        // --- 3. Verification ---
+        // Head 0 against the CPU for small problems (O(N^2 D) on the host), all heads against the unfused kernels
+        string result = "PASS";
+        double errCPU = 0.0, errRef = 0.0;
+        if (N <= 1024) {
+            vector<float> O_cpu((size_t)N * D);
+            cpuAttention(Q.data(), K.data(), V.data(), O_cpu.data(), N, D, scale, causal);
+            errCPU = maxAbsDiff(O_cpu, O_flash, O_cpu.size());
+            if (errCPU > 1e-3) result = "FAIL (CPU)";
+        }
+        if (refFits) {
+            errRef = maxAbsDiff(O_ref, O_flash, qkvCount);
+            if (errRef > 1e-3) result = "FAIL (Ref)";
+        }
+
+        // --- Clean Output ---
+        cout << left << setw(8) << N
+             << setw(14) << "Unfused"
+             << setw(14) << fixed << setprecision(3) << tRef
+             << setw(16) << setprecision(1) << unfusedMB
+             << setw(14) << "-"
+             << (refFits ? "Reference" : "OOM (S > max alloc)") << endl;
+
+        cout << left << setw(8) << ""
+             << setw(14) << "Flash"
+             << setw(14) << fixed << setprecision(3) << tFlash
+             << setw(16) << setprecision(1) << flashMB
+             << setw(14) << scientific << setprecision(2) << max(errCPU, errRef) << fixed
+             << result
+             << (refFits ? " | Speedup: " + to_string(tRef / tFlash).substr(0, 4) + "x" : "")
+             << " | Traffic saved: " << to_string(unfusedMB / flashMB).substr(0, 4) << "x" << endl;
+
+        cout << string(85, '-') << endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,369 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <functional>
+#include <map>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/epilogue.hpp"
+
+using namespace std;
+
+// Usage: fused_mlp [--device <spec>] [--tokens 128,512] [--dim 1024] [--ffn 2816]
+// A transformer MLP block two ways, on gemm.cl:
+//   GELU   : y = gelu(x W1 + b1) W2 + b2 + x
+//   SwiGLU : y = (silu(x Wg) * (x Wu)) Wd + x
+// Unfused runs the plain GEMMs plus one elementwise kernel per step (elementwise.cl). Fused moves
+// every elementwise step into the GEMM epilogues (epilogue.cl), so intermediates are written once.
+// A second table builds every EPI_* option the MLPs don't use (scale, ReLU, ...) on a small GEMM
+// and compares each against the host.
+
+static double geluRef(double v) { return 0.5 * v * (1.0 + tanh(0.7978845608 * (v + 0.044715 * v * v * v))); }
+static double siluRef(double v) { return v / (1.0 + exp(-v)); }
+static double actRef(Activation a, double v) {
+    switch (a) {
+        case Activation::ReLU: return max(v, 0.0);
+        case Activation::GELU: return geluRef(v);
+        case Activation::SiLU: return siluRef(v);
+        default: return v;
+    }
+}
+
+// x [K] times W [K][N], in double
+static vector<double> rowTimes(const vector<double>& x, const vector<float>& W, int K, int N) {
+    vector<double> out(N, 0.0);
+    for (int k = 0; k < K; k++)
+        for (int n = 0; n < N; n++) out[n] += x[k] * W[(size_t)k * N + n];
+    return out;
+}
+
+// Each epilogue on one M x N x K gemm, against epilogue.cl's formula evaluated on the host:
+//   v = alpha * acc + beta * C_old; v += bias[col]; v = act(gate) * v or act(v); v += residual
+static bool checkEpilogues(cl::Context& context, cl::Device& device, cl::CommandQueue& queue, const string& fusedSrc,
+                           const TuningDB& tuningDB) {
+    const int M = 64, N = 96, K = 80;
+    vector<float> A((size_t)M * K), B((size_t)K * N), Cold((size_t)M * N), bias(N), residual(Cold.size()),
+        gate(Cold.size()), C(Cold.size());
+    for (size_t i = 0; i < A.size(); i++) A[i] = sin(0.13f * i) * 0.5f;
+    for (size_t i = 0; i < B.size(); i++) B[i] = cos(0.07f * i) * 0.5f;
+    for (size_t i = 0; i < Cold.size(); i++) {
+        Cold[i] = sin(0.31f * i);
+        residual[i] = cos(0.19f * i) * 0.5f;
+        gate[i] = sin(0.41f * i + 1.0f) * 2.0f;
+    }
+    for (int i = 0; i < N; i++) bias[i] = 0.05f * (i % 9) - 0.2f;
+
+    vector<double> acc((size_t)M * N, 0.0);
+    for (int m = 0; m < M; m++)
+        for (int k = 0; k < K; k++)
+            for (int n = 0; n < N; n++) acc[(size_t)m * N + n] += (double)A[(size_t)m * K + k] * B[(size_t)k * N + n];
+
+    auto upload = [&](const vector<float>& v) {
+        return cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * v.size(), (void*)v.data());
+    };
+    cl::Buffer bufA = upload(A), bufB = upload(B), bufBias = upload(bias), bufRes = upload(residual), bufGate = upload(gate);
+    cl::Buffer bufC(context, CL_MEM_READ_WRITE, sizeof(float) * C.size());
+
+    // Every option alone, each activation plain and gated, and two with all four stages
+    vector<Epilogue> epilogues;
+    auto make = [](bool scale, bool bias, bool gated, bool residual, Activation act) {
+        Epilogue e;
+        e.scale = scale; e.bias = bias; e.gated = gated; e.residual = residual; e.act = act;
+        if (scale) { e.alpha = 0.5f; e.beta = -1.5f; }
+        return e;
+    };
+    epilogues.push_back(make(true, false, false, false, Activation::None));
+    epilogues.push_back(make(false, true, false, false, Activation::None));
+    epilogues.push_back(make(false, false, false, true, Activation::None));
+    for (Activation a : {Activation::ReLU, Activation::GELU, Activation::SiLU}) {
+        epilogues.push_back(make(false, false, false, false, a));
+        epilogues.push_back(make(false, false, true, false, a));
+    }
+    epilogues.push_back(make(true, true, false, true, Activation::ReLU));
+    epilogues.push_back(make(true, true, true, true, Activation::GELU));
+
+    TuneParams p = matmulParams(tuningDB, device, "gemm", M, N, K);
+
+    cout << "Epilogues\n-----------------------------------------------------------" << endl;
+    cout << left << setw(30) << "Epilogue"
+         << setw(12) << "MaxErr"
+         << "Result" << endl;
+    cout << string(50, '-') << endl;
+    bool ok = true;
+    for (const Epilogue& e : epilogues) {
+        cl::Kernel k(buildProgram(context, device, fusedSrc, buildOptions(p) + e.buildOptions()), "gemm");
+        k.setArg(0, bufA); k.setArg(1, bufB); k.setArg(2, bufC);
+        k.setArg(3, M); k.setArg(4, N); k.setArg(5, K);
+        setEpilogueArgs(k, 6, e, bufBias, bufRes, bufGate);
+        queue.enqueueWriteBuffer(bufC, CL_TRUE, 0, sizeof(float) * Cold.size(), Cold.data());  // C_old for EPI_SCALE
+        queue.enqueueNDRangeKernel(k, cl::NullRange, matmulGlobalSize("gemm", p, M, N), cl::NDRange(p.localX, p.localY));
+        queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+
+        double maxErr = 0.0;
+        bool match = true;
+        for (size_t i = 0; i < C.size(); i++) {
+            double v = acc[i];
+            if (e.scale) v = e.alpha * v + e.beta * Cold[i];
+            if (e.bias) v += bias[i % N];
+            v = e.gated ? actRef(e.act, gate[i]) * v : actRef(e.act, v);
+            if (e.residual) v += residual[i];
+            double diff = std::abs(v - C[i]);
+            maxErr = max(maxErr, diff);
+            if (diff > 1e-3 * (1.0 + std::abs(v))) match = false;
+        }
+        ok &= match;
+        cout << left << setw(30) << e.name()
+             << setw(12) << scientific << setprecision(2) << maxErr << fixed
+             << (match ? "PASS" : "FAIL") << endl;
+    }
+    cout << string(50, '-') << endl;
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    vector<int> tokenCounts = {128, 512};
+    int D = 1024, F = 2816;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--dim") D = stoi(argv[++i]);
+        else if (arg == "--ffn") F = stoi(argv[++i]);
+        else if (arg == "--tokens") {
+            tokenCounts.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) tokenCounts.push_back(stoi(item));
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Model / FFN Dim    : " << D << " / " << F << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    // --- Build Section ---
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl");
+    string fusedSrc = withEpilogue(gemmSrc);
+    cl::Program ewProgram = buildProgram(context, device, readKernelFile("Kernel_Fusion/kernels/elementwise.cl"));
+    cl::Kernel kBias(ewProgram, "add_bias");
+    cl::Kernel kGelu(ewProgram, "gelu");
+    cl::Kernel kSiluMul(ewProgram, "silu_mul");
+    cl::Kernel kResidual(ewProgram, "add_residual");
+    TuningDB tuningDB;
+
+    Epilogue epiBiasGelu;
+    epiBiasGelu.bias = true;
+    epiBiasGelu.act = Activation::GELU;
+    Epilogue epiBiasResidual;
+    epiBiasResidual.bias = true;
+    epiBiasResidual.residual = true;
+    Epilogue epiResidual;
+    epiResidual.residual = true;
+    Epilogue epiSwiglu = Epilogue::swiglu();
+
+    // Weights: W1 / Wg / Wu [D][F], W2 / Wd [F][D], small enough that activations stay O(1)
+    vector<float> W1((size_t)D * F), Wg((size_t)D * F), Wu((size_t)D * F), W2((size_t)F * D), Wd((size_t)F * D);
+    vector<float> b1(F), b2(D);
+    for (size_t i = 0; i < W1.size(); i++) {
+        W1[i] = sin(0.37f * i) * 0.05f;
+        Wg[i] = cos(0.23f * i) * 0.05f;
+        Wu[i] = sin(0.11f * i + 1.0f) * 0.05f;
+    }
+    for (size_t i = 0; i < W2.size(); i++) {
+        W2[i] = cos(0.29f * i) * 0.03f;
+        Wd[i] = sin(0.17f * i + 2.0f) * 0.03f;
+    }
+    for (int i = 0; i < F; i++) b1[i] = 0.01f * (i % 13) - 0.06f;
+    for (int i = 0; i < D; i++) b2[i] = 0.02f * (i % 7) - 0.06f;
+
+    auto upload = [&](const vector<float>& v) {
+        return cl::Buffer(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * v.size(), (void*)v.data());
+    };
+    cl::Buffer bufW1 = upload(W1), bufWg = upload(Wg), bufWu = upload(Wu), bufW2 = upload(W2), bufWd = upload(Wd);
+    cl::Buffer bufB1 = upload(b1), bufB2 = upload(b2);
+
+    auto get_ms = [](cl::Event& e) {
+        e.wait();
+        cl_ulong start, end;
+        e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+        e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
+        return (end - start) * 1.0e-6;
+    };
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(8) << "Tokens"
+         << setw(9) << "MLP"
+         << setw(10) << "Mode"
+         << setw(9) << "Kernels"
+         << setw(12) << "Kernel(ms)"
+         << setw(10) << "GFLOP/s"
+         << setw(11) << "Extra(MB)"
+         << setw(12) << "MaxErr"
+         << "Result" << endl;
+    cout << string(95, '-') << endl;
+
+    bool failed = false;
+    for (int T : tokenCounts) {
+        vector<float> X((size_t)T * D), Y((size_t)T * D);
+        for (size_t i = 0; i < X.size(); i++) X[i] = sin(0.05f * i) * 0.5f;
+        cl::Buffer bufX = upload(X);
+        cl::Buffer bufH1(context, CL_MEM_READ_WRITE, sizeof(float) * T * F);
+        cl::Buffer bufH2(context, CL_MEM_READ_WRITE, sizeof(float) * T * F);
+        cl::Buffer bufH3(context, CL_MEM_READ_WRITE, sizeof(float) * T * F);
+        cl::Buffer bufY(context, CL_MEM_READ_WRITE, sizeof(float) * T * D);
+
+        // Up projections are T x F x D, down projections T x D x F; each gets its tuned tile shape
+        TuneParams pUp = matmulParams(tuningDB, device, "gemm", T, F, D);
+        TuneParams pDown = matmulParams(tuningDB, device, "gemm", T, D, F);
+        auto gemmKernel = [&](const TuneParams& p, const Epilogue& e) {
+            cl::Program program = e.active() ? buildProgram(context, device, fusedSrc, buildOptions(p) + e.buildOptions())
+                                             : buildProgram(context, device, gemmSrc, buildOptions(p));
+            return cl::Kernel(program, "gemm");
+        };
+        cl::Kernel kUp = gemmKernel(pUp, Epilogue()), kDown = gemmKernel(pDown, Epilogue());
+        cl::Kernel kUpGelu = gemmKernel(pUp, epiBiasGelu), kUpSwiglu = gemmKernel(pUp, epiSwiglu);
+        cl::Kernel kDownBiasRes = gemmKernel(pDown, epiBiasResidual), kDownRes = gemmKernel(pDown, epiResidual);
+
+        vector<cl::Event> events;
+        auto gemm = [&](cl::Kernel& k, const TuneParams& p, const cl::Buffer& A, const cl::Buffer& B, const cl::Buffer& C,
+                        int M, int N, int K) {
+            k.setArg(0, A); k.setArg(1, B); k.setArg(2, C);
+            k.setArg(3, M); k.setArg(4, N); k.setArg(5, K);
+            events.emplace_back();
+            queue.enqueueNDRangeKernel(k, cl::NullRange, matmulGlobalSize("gemm", p, M, N),
+                                       cl::NDRange(p.localX, p.localY), nullptr, &events.back());
+        };
+        auto elementwise = [&](cl::Kernel& k, size_t count) {
+            events.emplace_back();
+            queue.enqueueNDRangeKernel(k, cl::NullRange, cl::NDRange(count), cl::NullRange, nullptr, &events.back());
+        };
+
+        // Each pipeline is enqueued twice (warmup, then timed); its kernel events land in 'events'
+        vector<pair<string, function<void()>>> pipelines = {
+            {"GELU/Unfused", [&] {
+                gemm(kUp, pUp, bufX, bufW1, bufH1, T, F, D);
+                kBias.setArg(0, bufH1); kBias.setArg(1, bufB1); kBias.setArg(2, F);
+                elementwise(kBias, (size_t)T * F);
+                kGelu.setArg(0, bufH1);
+                elementwise(kGelu, (size_t)T * F);
+                gemm(kDown, pDown, bufH1, bufW2, bufY, T, D, F);
+                kBias.setArg(0, bufY); kBias.setArg(1, bufB2); kBias.setArg(2, D);
+                elementwise(kBias, (size_t)T * D);
+                kResidual.setArg(0, bufY); kResidual.setArg(1, bufX);
+                elementwise(kResidual, (size_t)T * D);
+            }},
+            {"GELU/Fused", [&] {
+                setEpilogueArgs(kUpGelu, 6, epiBiasGelu, bufB1, cl::Buffer(), cl::Buffer());
+                gemm(kUpGelu, pUp, bufX, bufW1, bufH1, T, F, D);
+                setEpilogueArgs(kDownBiasRes, 6, epiBiasResidual, bufB2, bufX, cl::Buffer());
+                gemm(kDownBiasRes, pDown, bufH1, bufW2, bufY, T, D, F);
+            }},
+            {"SwiGLU/Unfused", [&] {
+                gemm(kUp, pUp, bufX, bufWg, bufH1, T, F, D);
+                gemm(kUp, pUp, bufX, bufWu, bufH2, T, F, D);
+                kSiluMul.setArg(0, bufH1); kSiluMul.setArg(1, bufH2); kSiluMul.setArg(2, bufH3);
+                elementwise(kSiluMul, (size_t)T * F);
+                gemm(kDown, pDown, bufH3, bufWd, bufY, T, D, F);
+                kResidual.setArg(0, bufY); kResidual.setArg(1, bufX);
+                elementwise(kResidual, (size_t)T * D);
+            }},
+            {"SwiGLU/Fused", [&] {
+                gemm(kUp, pUp, bufX, bufWg, bufH1, T, F, D);
+                setEpilogueArgs(kUpSwiglu, 6, epiSwiglu, cl::Buffer(), cl::Buffer(), bufH1);
+                gemm(kUpSwiglu, pUp, bufX, bufWu, bufH3, T, F, D);
+                setEpilogueArgs(kDownRes, 6, epiResidual, cl::Buffer(), bufX, cl::Buffer());
+                gemm(kDownRes, pDown, bufH3, bufWd, bufY, T, D, F);
+            }},
+        };
+
+        // Traffic beyond the GEMMs' own operand reads and output writes, in floats (see Readme)
+        double TF = (double)T * F, TD = (double)T * D;
+        map<string, double> extraFloats = {
+            {"GELU/Unfused", 4 * TF + 5 * TD}, {"GELU/Fused", TD},
+            {"SwiGLU/Unfused", 3 * TF + 3 * TD}, {"SwiGLU/Fused", TF + TD},
+        };
+
+        // CPU reference rows: first, middle and last token
+        vector<int> checkRows = {0, T / 2, T - 1};
+        auto reference = [&](bool swiglu, int r) {
+            vector<double> x(X.begin() + (size_t)r * D, X.begin() + (size_t)(r + 1) * D);
+            vector<double> h(F), y;
+            if (swiglu) {
+                vector<double> g = rowTimes(x, Wg, D, F), u = rowTimes(x, Wu, D, F);
+                for (int f = 0; f < F; f++) h[f] = siluRef(g[f]) * u[f];
+                y = rowTimes(h, Wd, F, D);
+                for (int d = 0; d < D; d++) y[d] += x[d];
+            } else {
+                vector<double> a = rowTimes(x, W1, D, F);
+                for (int f = 0; f < F; f++) h[f] = geluRef(a[f] + b1[f]);
+                y = rowTimes(h, W2, F, D);
+                for (int d = 0; d < D; d++) y[d] += b2[d] + x[d];
+            }
+            return y;
+        };
+
+        double flops = 2.0 * T * D * F * 2;
+        double tUnfused = 0.0;
+        for (auto& [name, run] : pipelines) {
+            bool swiglu = name.rfind("SwiGLU", 0) == 0;
+            double ms = 0.0;
+
+            // Pipelines share the intermediates and the output: overwrite the previous pipeline's
+            // results so one that skips a write can't pass on them. No correct output is this large.
+            const float stale = 1.0e6f;
+            for (cl::Buffer* b : {&bufH1, &bufH2, &bufH3})
+                queue.enqueueFillBuffer(*b, stale, 0, sizeof(float) * T * F);
+            queue.enqueueFillBuffer(bufY, stale, 0, sizeof(float) * T * D);
+            queue.finish();
+
+            for (int pass = 0; pass < 2; pass++) {
+                events.clear();
+                run();
+                queue.finish();
+            }
+            for (auto& e : events) ms += get_ms(e);
+
+            queue.enqueueReadBuffer(bufY, CL_TRUE, 0, sizeof(float) * Y.size(), Y.data());
+            double maxErr = 0.0;
+            bool match = true;
+            for (int r : checkRows) {
+                vector<double> ref = reference(swiglu, r);
+                for (int d = 0; d < D; d++) {
+                    double diff = std::abs(ref[d] - Y[(size_t)r * D + d]);
+                    maxErr = max(maxErr, diff);
+                    if (diff > 1e-3 * (1.0 + std::abs(ref[d]))) match = false;
+                }
+            }
+
+            failed |= !match;
+            bool fused = name.find("/Fused") != string::npos;
+            if (!fused) tUnfused = ms;
+            double mlpFlops = swiglu ? flops * 1.5 : flops;
+            cout << left << setw(8) << (name == "GELU/Unfused" ? to_string(T) : "")
+                 << setw(9) << (swiglu ? "SwiGLU" : "GELU")
+                 << setw(10) << (fused ? "Fused" : "Unfused")
+                 << setw(9) << events.size()
+                 << setw(12) << fixed << setprecision(3) << ms
+                 << setw(10) << setprecision(1) << mlpFlops / (ms * 1.0e6)
+                 << setw(11) << setprecision(1) << extraFloats[name] * sizeof(float) / (1024.0 * 1024.0)
+                 << setw(12) << scientific << setprecision(2) << maxErr << fixed
+                 << (match ? "PASS" : "FAIL")
+                 << (fused ? " | Speedup: " + to_string(tUnfused / ms).substr(0, 4) + "x" : "") << endl;
+        }
+        cout << string(95, '-') << endl;
+    }
+    cout << endl;
+
+    failed |= !checkEpilogues(context, device, queue, fusedSrc, tuningDB);
+    return failed ? 1 : 0;
+}
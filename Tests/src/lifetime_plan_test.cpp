@@ -0,0 +1,104 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "utils/device_arena.hpp"
+
+using namespace std;
+
+// Checks LifetimePlan (utils/device_arena.hpp) on the host:
+//   - tensors whose lifetimes overlap never get overlapping byte ranges,
+//   - every offset is aligned and every tensor fits inside totalBytes(),
+//   - the plan needs less than one buffer per tensor when lifetimes allow sharing.
+// Returns non-zero on the first failure.
+
+static int failures = 0;
+
+static void expect(bool ok, const string& what) {
+    if (!ok) {
+        cerr << "FAIL: " << what << endl;
+        failures++;
+    }
+}
+
+struct Interval {
+    size_t bytes;
+    int first, last;
+};
+
+static void checkPlan(const string& name, const vector<Interval>& tensors, size_t align) {
+    LifetimePlan plan;
+    for (const Interval& t : tensors) plan.add(t.bytes, t.first, t.last);
+    size_t total = plan.finalize(align);
+
+    for (size_t i = 0; i < tensors.size(); i++) {
+        expect(plan.offset((int)i) % align == 0, name + ": tensor " + to_string(i) + " is misaligned");
+        expect(plan.offset((int)i) + plan.bytes((int)i) <= total, name + ": tensor " + to_string(i) + " ends past totalBytes()");
+        for (size_t j = i + 1; j < tensors.size(); j++) {
+            bool liveTogether = tensors[i].first <= tensors[j].last && tensors[j].first <= tensors[i].last;
+            bool sharesBytes = plan.offset((int)i) < plan.offset((int)j) + plan.bytes((int)j) &&
+                               plan.offset((int)j) < plan.offset((int)i) + plan.bytes((int)i);
+            expect(!(liveTogether && sharesBytes),
+                   name + ": tensors " + to_string(i) + " and " + to_string(j) + " are live together but overlap");
+        }
+    }
+    // One buffer per tensor, each padded to the alignment like the plan's offsets
+    size_t naive = 0;
+    for (const Interval& t : tensors) naive += (t.bytes + align - 1) / align * align;
+    expect(total <= naive, name + ": plan is larger than one aligned buffer per tensor");
+}
+
+int main() {
+    // --- 1. Chain: each tensor is read only by the next step, so two buffers are enough ---
+    vector<Interval> chain;
+    for (int s = 0; s < 8; s++) chain.push_back({4096, s, s + 1});
+    checkPlan("chain", chain, 256);
+    LifetimePlan chainPlan;
+    for (const Interval& t : chain) chainPlan.add(t.bytes, t.first, t.last);
+    size_t chainTotal = chainPlan.finalize(256);
+    expect(chainTotal < chainPlan.unplannedBytes(), "chain: peak is not below the naive sum");
+    expect(chainTotal == 2 * 4096, "chain: expected two 4 KB buffers, got " + to_string(chainTotal) + " bytes");
+
+    // --- 2. All live at once: nothing may share, so the plan equals the naive sum ---
+    vector<Interval> together = {{1000, 0, 5}, {3000, 0, 5}, {512, 2, 3}, {7, 1, 4}};
+    checkPlan("together", together, 64);
+
+    // --- 3. Decoder layer: residual streams span the layer, projections and MLP scratch do not ---
+    vector<Interval> layer = {
+        {1 << 16, 0, 11},  // x
+        {1 << 16, 0, 11},  // h
+        {1 << 16, 1, 4},   // q
+        {1 << 15, 1, 3},   // k
+        {1 << 15, 1, 3},   // v
+        {1 << 16, 4, 5},   // o
+        {1 << 16, 5, 9},   // x (ping-pong)
+        {1 << 18, 7, 8},   // gate
+        {1 << 18, 8, 9},   // up * silu(gate)
+        {1 << 19, 11, 11}, // logits
+    };
+    checkPlan("layer", layer, 256);
+    LifetimePlan layerPlan;
+    for (const Interval& t : layer) layerPlan.add(t.bytes, t.first, t.last);
+    expect(layerPlan.finalize(256) < layerPlan.unplannedBytes(), "layer: peak is not below the naive sum");
+
+    // --- 4. Random intervals with odd sizes ---
+    uint64_t state = 12345;
+    auto next = [&](uint64_t mod) {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return (state >> 33) % mod;
+    };
+    for (int round = 0; round < 200; round++) {
+        vector<Interval> random;
+        int count = 1 + (int)next(40);
+        for (int i = 0; i < count; i++) {
+            int first = (int)next(30);
+            random.push_back({1 + (size_t)next(100000), first, first + (int)next(10)});
+        }
+        checkPlan("random " + to_string(round), random, (size_t)1 << next(9));
+    }
+
+    cout << "lifetime_plan_test: " << (failures ? "FAIL" : "PASS") << " (" << failures << " failures)" << endl;
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,68 @@
+// Fused GEMM epilogues, prepended to matmul.cl / register_matmul.cl / gemm.cl (see utils/epilogue.hpp).
+// Selected at build time, so a kernel built without any EPI_* macro is exactly the plain GEMM:
+//   -DEPI_SCALE          v = alpha * acc + beta * C_old            (BLAS-style; reads C)
+//   -DEPI_BIAS           v += bias[col]                           (one value per output column)
+//   -DEPI_ACT=ACT_GELU   v = act(v)   ACT_RELU / ACT_GELU (tanh form) / ACT_SILU
+//   -DEPI_GATED          v = act(gate[idx]) * v instead of act(v)  (SwiGLU: gate = x * W_gate, this GEMM = x * W_up)
+//   -DEPI_RESIDUAL       v += residual[idx]                       (applied last)
+// When any of them is set the kernels take five trailing arguments, in this order:
+//   bias, residual, gate, alpha, beta
+// Unused buffers may be passed as NULL.
+#define ACT_NONE 0
+#define ACT_RELU 1
+#define ACT_GELU 2
+#define ACT_SILU 3
+
+#ifndef EPI_ACT
+#define EPI_ACT ACT_NONE
+#endif
+
+#if defined(EPI_SCALE) || defined(EPI_BIAS) || defined(EPI_GATED) || defined(EPI_RESIDUAL) || EPI_ACT != ACT_NONE
+#define EPILOGUE
+#endif
+
+inline float epi_act(float x) {
+#if EPI_ACT == ACT_RELU
+    return fmax(x, 0.0f);
+#elif EPI_ACT == ACT_GELU
+    return 0.5f * x * (1.0f + tanh(0.7978845608f * (x + 0.044715f * x * x * x)));
+#elif EPI_ACT == ACT_SILU
+    return x / (1.0f + exp(-x));
+#else
+    return x;
+#endif
+}
+
+#ifdef EPILOGUE
+#define EPILOGUE_PARAMS , __global const float* bias, __global const float* residual, __global const float* gate, \
+                          float alpha, float beta
+#define EPILOGUE_ARGS , bias, residual, gate, alpha, beta
+
+// The value stored at C[idx] (column 'col') for accumulator 'acc'
+inline float epilogue(float acc, size_t idx, int col, __global const float* C, __global const float* bias,
+                      __global const float* residual, __global const float* gate, float alpha, float beta) {
+    float v = acc;
+#ifdef EPI_SCALE
+    v = alpha * v + (beta != 0.0f ? beta * C[idx] : 0.0f);
+#endif
+#ifdef EPI_BIAS
+    v += bias[col];
+#endif
+#ifdef EPI_GATED
+    v = epi_act(gate[idx]) * v;
+#else
+    v = epi_act(v);
+#endif
+#ifdef EPI_RESIDUAL
+    v += residual[idx];
+#endif
+    return v;
+}
+
+#define STORE_C(C, idx, col, acc) \
+    ((C)[idx] = epilogue((acc), (idx), (col), (C), bias, residual, gate, alpha, beta))
+#else
+#define EPILOGUE_PARAMS
+#define EPILOGUE_ARGS
+#define STORE_C(C, idx, col, acc) ((C)[idx] = (acc))
+#endif
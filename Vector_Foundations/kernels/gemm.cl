@@ -0,0 +1,210 @@
+// 2D Register-Blocked GEMM with float4 global loads and ping-pong local tiles.
+//   gemm    : C[M][N] = A[M][K] * B[K][N]
+//   gemm_nt : C[M][N] = A[M][K] * B[N][K]^T   (B stored one output feature per row, like model weights)
+// Any M, N, K: edge tiles are zero-filled on load and bounds-checked on store.
+//
+// A work-group computes a TSM x TSN block of C with (TSN / WPTN) x (TSM / WPTM) work-items, and each
+// work-item owns a WPTM x WPTN register tile. Its rows / columns are strided by the work-group size,
+// so neighbouring work-items read neighbouring local words and write neighbouring C columns.
+// Tile shape comes from the auto-tuner (-DTSM=64 -DTSN=64 -DTSK=16 -DWPTM=8 -DWPTN=8); it must satisfy
+// gemmParamsValid() in utils/tuning.hpp: TSM % WPTM == 0, TSN % WPTN == 0, TSK % 4 == 0, and the
+// TSM*TSK/4 and TSN*TSK/4 float4 loads of a tile must divide evenly over the work-group.
+// Prepend epilogue.cl to fuse bias / activation / residual / SwiGLU gating into the store.
+#ifndef TSM
+#define TSM 64
+#endif
+#ifndef TSN
+#define TSN 64
+#endif
+#ifndef TSK
+#define TSK 16
+#endif
+#ifndef WPTM
+#define WPTM 8
+#endif
+#ifndef WPTN
+#define WPTN 8
+#endif
+
+// Plain store unless epilogue.cl was prepended
+#ifndef STORE_C
+#define EPILOGUE_PARAMS
+#define EPILOGUE_ARGS
+#define STORE_C(C, idx, col, acc) ((C)[idx] = (acc))
+#endif
+
+#define RTSM (TSM / WPTM)  // Work-group height
+#define RTSN (TSN / WPTN)  // Work-group width
+#define THREADS (RTSM * RTSN)
+#define LOADS_A (TSM * TSK / 4 / THREADS)  // float4 loads per work-item per tile
+#define LOADS_B (TSN * TSK / 4 / THREADS)
+
+// Local tiles are stored K-major (tile[k][row]); +1 padding keeps the transposing stores off one bank
+#define LDA_TILE (TSM + 1)
+#define LDB_TILE (TSN + 1)
+
+// Four consecutive floats of X[row][col..col+3] (rows x cols, row-major), zero past the edges.
+// vload4 only needs float alignment, so any 'cols' is fine.
+inline float4 load4(__global const float* X, int rows, int cols, int row, int col) {
+    if (row >= rows) return (float4)(0.0f);
+    __global const float* p = X + (size_t)row * cols + col;
+    if (col + 3 < cols) return vload4(0, p);
+    return (float4)(col < cols ? p[0] : 0.0f, col + 1 < cols ? p[1] : 0.0f, col + 2 < cols ? p[2] : 0.0f, 0.0f);
+}
+
+// Tiles of row-major X[rows][K] (A, and B for gemm_nt): float4 i covers row i / (TSK/4), k 4 * (i % (TSK/4))
+inline void fetchRowTile(__global const float* X, int rows, int K, int r0, int k0, int tid, float4* regs, int count) {
+    for (int l = 0; l < count; l++) {
+        int i = tid + l * THREADS;
+        regs[l] = load4(X, rows, K, r0 + i / (TSK / 4), k0 + (i % (TSK / 4)) * 4);
+    }
+}
+
+inline void storeRowTile(__local float* tile, int ld, int tid, const float4* regs, int count) {
+    for (int l = 0; l < count; l++) {
+        int i = tid + l * THREADS;
+        int r = i / (TSK / 4), k = (i % (TSK / 4)) * 4;
+        tile[(k + 0) * ld + r] = regs[l].x;
+        tile[(k + 1) * ld + r] = regs[l].y;
+        tile[(k + 2) * ld + r] = regs[l].z;
+        tile[(k + 3) * ld + r] = regs[l].w;
+    }
+}
+
+// Tiles of B[K][N] (gemm): float4 i covers k i / (TSN/4), columns 4 * (i % (TSN/4))
+inline void fetchColTile(__global const float* B, int K, int N, int k0, int n0, int tid, float4* regs, int count) {
+    for (int l = 0; l < count; l++) {
+        int i = tid + l * THREADS;
+        regs[l] = load4(B, K, N, k0 + i / (TSN / 4), n0 + (i % (TSN / 4)) * 4);
+    }
+}
+
+inline void storeColTile(__local float* tile, int tid, const float4* regs, int count) {
+    for (int l = 0; l < count; l++) {
+        int i = tid + l * THREADS;
+        __local float* p = tile + (i / (TSN / 4)) * LDB_TILE + (i % (TSN / 4)) * 4;
+        p[0] = regs[l].x;
+        p[1] = regs[l].y;
+        p[2] = regs[l].z;
+        p[3] = regs[l].w;
+    }
+}
+
+// Asub / Bsub hold two tiles each: [2][TSK][LDA_TILE] and [2][TSK][LDB_TILE]
+inline void gemm_body(__global const float* A, __global const float* B, __global float* C, int M, int N, int K,
+                      const int transB, __local float* Asub, __local float* Bsub EPILOGUE_PARAMS) {
+    // 1. Identifiers
+    const int tidm = get_local_id(1);
+    const int tidn = get_local_id(0);
+    const int tid = tidm * RTSN + tidn;
+    const int m0 = get_group_id(1) * TSM;
+    const int n0 = get_group_id(0) * TSN;
+
+    // 2. Private Memory: the WPTM x WPTN accumulators plus the staging registers for the next tile
+    float acc[WPTM][WPTN];
+    for (int wm = 0; wm < WPTM; wm++)
+        for (int wn = 0; wn < WPTN; wn++) acc[wm][wn] = 0.0f;
+    float4 ra[LOADS_A], rb[LOADS_B];
+
+    // 3. Prologue: K-tile 0 into buffer 0
+    fetchRowTile(A, M, K, m0, 0, tid, ra, LOADS_A);
+    if (transB) fetchRowTile(B, N, K, n0, 0, tid, rb, LOADS_B);
+    else fetchColTile(B, K, N, 0, n0, tid, rb, LOADS_B);
+    storeRowTile(Asub, LDA_TILE, tid, ra, LOADS_A);
+    if (transB) storeRowTile(Bsub, LDB_TILE, tid, rb, LOADS_B);
+    else storeColTile(Bsub, tid, rb, LOADS_B);
+    barrier(CLK_LOCAL_MEM_FENCE);
+
+    int numTiles = (K + TSK - 1) / TSK;
+    for (int t = 0; t < numTiles; t++) {
+        __local float* Acur = Asub + (t & 1) * TSK * LDA_TILE;
+        __local float* Bcur = Bsub + (t & 1) * TSK * LDB_TILE;
+        __local float* Anext = Asub + ((t + 1) & 1) * TSK * LDA_TILE;
+        __local float* Bnext = Bsub + ((t + 1) & 1) * TSK * LDB_TILE;
+        bool more = t + 1 < numTiles;  // Uniform across the work-group
+
+        // 4. Issue the global loads for tile t + 1 first so they are in flight during the FMAs below
+        if (more) {
+            int k0 = (t + 1) * TSK;
+            fetchRowTile(A, M, K, m0, k0, tid, ra, LOADS_A);
+            if (transB) fetchRowTile(B, N, K, n0, k0, tid, rb, LOADS_B);
+            else fetchColTile(B, K, N, k0, n0, tid, rb, LOADS_B);
+        }
+
+        // 5. Outer products from the current tile: WPTM + WPTN local reads feed WPTM * WPTN FMAs
+        for (int k = 0; k < TSK; k++) {
+            float bReg[WPTN];
+            for (int wn = 0; wn < WPTN; wn++) bReg[wn] = Bcur[k * LDB_TILE + tidn + wn * RTSN];
+            for (int wm = 0; wm < WPTM; wm++) {
+                float a = Acur[k * LDA_TILE + tidm + wm * RTSM];
+                for (int wn = 0; wn < WPTN; wn++) acc[wm][wn] = mad(a, bReg[wn], acc[wm][wn]);
+            }
+        }
+
+        // 6. Park tile t + 1 in the other buffer. Nobody reads it during this iteration and the
+        // barrier at the end of the previous one retired its last readers, so one barrier suffices.
+        if (more) {
+            storeRowTile(Anext, LDA_TILE, tid, ra, LOADS_A);
+            if (transB) storeRowTile(Bnext, LDB_TILE, tid, rb, LOADS_B);
+            else storeColTile(Bnext, tid, rb, LOADS_B);
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+    }
+
+    // 7. Write the register tile back to Global Memory
+    for (int wm = 0; wm < WPTM; wm++) {
+        int row = m0 + tidm + wm * RTSM;
+        if (row >= M) break;
+        for (int wn = 0; wn < WPTN; wn++) {
+            int col = n0 + tidn + wn * RTSN;
+            if (col < N) STORE_C(C, (size_t)row * N + col, col, acc[wm][wn]);
+        }
+    }
+}
+
+// Grid: (ceil(N / TSN) * RTSN, ceil(M / TSM) * RTSM), work-group (RTSN, RTSM). See matmulGlobalSize().
+__kernel __attribute__((reqd_work_group_size(RTSN, RTSM, 1)))
+void gemm(__global const float* A, __global const float* B, __global float* C, int M, int N, int K
+          EPILOGUE_PARAMS) {
+    __local float Asub[2 * TSK * LDA_TILE];
+    __local float Bsub[2 * TSK * LDB_TILE];
+    gemm_body(A, B, C, M, N, K, 0, Asub, Bsub EPILOGUE_ARGS);
+}
+
+__kernel __attribute__((reqd_work_group_size(RTSN, RTSM, 1)))
+void gemm_nt(__global const float* A, __global const float* B, __global float* C, int M, int N, int K
+             EPILOGUE_PARAMS) {
+    __local float Asub[2 * TSK * LDA_TILE];
+    __local float Bsub[2 * TSK * LDB_TILE];
+    gemm_body(A, B, C, M, N, K, 1, Asub, Bsub EPILOGUE_ARGS);
+}
+
+// Strided batch: C[b] = A[b] * B[b] (or B[b]^T) for b = get_group_id(2), with X[b] = X + b * strideX.
+// A stride of 0 broadcasts that operand to every batch (e.g. one weight matrix shared by all heads).
+// Epilogue residual / gate buffers are laid out like C; bias is shared by every batch.
+// Grid: as above plus a third dimension of 'batch' work-groups of depth 1. See batched_gemm.hpp.
+__kernel __attribute__((reqd_work_group_size(RTSN, RTSM, 1)))
+void gemm_batched(__global const float* A, __global const float* B, __global float* C, int M, int N, int K,
+                  long strideA, long strideB, long strideC EPILOGUE_PARAMS) {
+    __local float Asub[2 * TSK * LDA_TILE];
+    __local float Bsub[2 * TSK * LDB_TILE];
+    long b = get_group_id(2);
+#ifdef EPILOGUE
+    residual += residual ? b * strideC : 0;  // Per-output operands follow C; bias is shared
+    gate += gate ? b * strideC : 0;
+#endif
+    gemm_body(A + b * strideA, B + b * strideB, C + b * strideC, M, N, K, 0, Asub, Bsub EPILOGUE_ARGS);
+}
+
+__kernel __attribute__((reqd_work_group_size(RTSN, RTSM, 1)))
+void gemm_nt_batched(__global const float* A, __global const float* B, __global float* C, int M, int N, int K,
+                     long strideA, long strideB, long strideC EPILOGUE_PARAMS) {
+    __local float Asub[2 * TSK * LDA_TILE];
+    __local float Bsub[2 * TSK * LDB_TILE];
+    long b = get_group_id(2);
+#ifdef EPILOGUE
+    residual += residual ? b * strideC : 0;
+    gate += gate ? b * strideC : 0;
+#endif
+    gemm_body(A + b * strideA, B + b * strideB, C + b * strideC, M, N, K, 1, Asub, Bsub EPILOGUE_ARGS);
+}
@@ -1,6 +1,18 @@
+// TileSize is normally supplied at build time (-DTileSize=N) by the auto-tuner.
+// The work-group must be TileSize x TileSize.
+// Prepend epilogue.cl to fuse bias / activation / residual into the store (see utils/epilogue.hpp).
+#ifndef TileSize
 #define TileSize 16
-
-__kernel void matmul(__global const float* A, __global const float* B, __global float* C, int M, int N, int K) {
+#endif
+// Plain store unless epilogue.cl was prepended
+#ifndef STORE_C
+#define EPILOGUE_PARAMS
+#define EPILOGUE_ARGS
+#define STORE_C(C, idx, col, acc) ((C)[idx] = (acc))
+#endif
+
+__kernel void matmul(__global const float* A, __global const float* B, __global float* C, int M, int N, int K
+                     EPILOGUE_PARAMS) {
     // 1. Thread Identifiers
     int row = get_global_id(1);
     int col = get_global_id(0);
@@ -39,6 +51,6 @@ __kernel void matmul(__global const float* A, __global const float* B, __global
     }
 
     if (row < M && col < N) {
-        C[row * N + col] = acc;
+        STORE_C(C, row * N + col, col, acc);
     }
 }
@@ -1,8 +1,23 @@
 // Work Per Thread (Register Tile) Matrix Multiplication.
+// TileSize and WPT are normally supplied at build time (-DTileSize=N -DWPT=W) by the auto-tuner.
+// The work-group must be TileSize x TileSize; each group covers TileSize x (TileSize * WPT) outputs.
+// -DACCUMULATE adds into C instead of overwriting it (used by K-blocked callers, see streaming_gemm.hpp).
+// Otherwise epilogue.cl may be prepended to fuse bias / activation / residual into the store.
+#ifndef TileSize
 #define TileSize 16
+#endif
+#ifndef WPT
 #define WPT 4
+#endif
+// Plain store unless epilogue.cl was prepended
+#ifndef STORE_C
+#define EPILOGUE_PARAMS
+#define EPILOGUE_ARGS
+#define STORE_C(C, idx, col, acc) ((C)[idx] = (acc))
+#endif
 __kernel void register_matmul(__global const float *A, __global const float *B,
-                              __global float *C, int M, int N, int K) {
+                              __global float *C, int M, int N, int K
+                              EPILOGUE_PARAMS) {
   // 1. Identifiers
   int localrow = get_local_id(1);
   int localcol = get_local_id(0);
@@ -55,7 +70,11 @@ __kernel void register_matmul(__global const float *A, __global const float *B,
     for (int w = 0; w < WPT; w++) {
       int globalColOut = col + w * TileSize;
       if (globalColOut < N) {
-        C[row * N + globalColOut] = acc[w];
+#ifdef ACCUMULATE
+        C[row * N + globalColOut] += acc[w];
+#else
+        STORE_C(C, row * N + globalColOut, globalColOut, acc[w]);
+#endif
       }
     }
   }
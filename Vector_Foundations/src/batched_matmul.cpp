@@ -0,0 +1,282 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <chrono>
+#include <array>
+#include <cstdio>
+#include <functional>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/batched_gemm.hpp"
+#include "utils/cpu_gemm.hpp"
+#include "utils/epilogue.hpp"
+
+using namespace std;
+
+// Usage: batched_matmul [--device <spec>] [--heads 8,32] [--sizes 64,128,128x128x64] [--reps N]
+// Per-head GEMMs (attention projections / QK^T) at head-sized shapes: one register_matmul or gemm
+// launch per head versus a single strided-batched gemm launch, and a batched launch with one
+// broadcast B (a weight shared by every head). gemm_nt_batched (B per head as [N][K], as in QK^T)
+// runs plain and with a gate + residual epilogue, whose operands are offset per head like C;
+// both are compared with cpuGemm(..., transB = true) over every output.
+// Wall(ms) is host time for the whole batch including enqueue overhead; Kernel(ms) is the sum
+// of the kernels' own profiled times.
+
+static vector<array<int, 3>> parseShapes(const string& list) {
+    vector<array<int, 3>> shapes;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        int M, N, K;
+        int n = sscanf(item.c_str(), "%dx%dx%d", &M, &N, &K);
+        if (n == 1) shapes.push_back({M, M, M});
+        else if (n == 3) shapes.push_back({M, N, K});
+    }
+    return shapes;
+}
+
+struct Timing { double wallMs = 0.0, kernelMs = 0.0; };
+
+// Best of 'reps' after one warmup. 'launch' enqueues the whole batch and returns its kernel events.
+static Timing timeBatch(cl::CommandQueue& queue, int reps, const function<vector<cl::Event>()>& launch) {
+    Timing best;
+    for (int r = -1; r < reps; r++) {
+        auto t0 = chrono::high_resolution_clock::now();
+        vector<cl::Event> events = launch();
+        queue.finish();
+        auto t1 = chrono::high_resolution_clock::now();
+        if (r < 0) continue;
+
+        Timing t;
+        t.wallMs = chrono::duration<double, milli>(t1 - t0).count();
+        for (auto& e : events) {
+            t.kernelMs += (e.getProfilingInfo<CL_PROFILING_COMMAND_END>() - e.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+        }
+        if (r == 0 || t.wallMs < best.wallMs) best = t;
+    }
+    return best;
+}
+
+int main(int argc, char** argv) {
+    vector<int> headCounts = {8, 32};
+    vector<array<int, 3>> shapes = parseShapes("64,128,128x128x64");
+    int reps = 10;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sizes") shapes = parseShapes(argv[++i]);
+        else if (arg == "--reps") reps = stoi(argv[++i]);
+        else if (arg == "--heads") {
+            headCounts.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) headCounts.push_back(stoi(item));
+        }
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Max Compute Units  : " << device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() << endl;
+    cout << "Reps               : " << reps << " (best of)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    string regSrc = readKernelFile("Vector_Foundations/kernels/register_matmul.cl");
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl");
+    TuningDB tuningDB;
+
+    // --- Table Header ---
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(16) << "Heads x MxNxK"
+         << setw(22) << "Mode"
+         << setw(10) << "Launches"
+         << setw(12) << "Wall(ms)"
+         << setw(12) << "Kernel(ms)"
+         << setw(10) << "GFLOP/s"
+         << setw(11) << "vs Loop"
+         << "Result" << endl;
+    cout << string(100, '-') << endl;
+
+    for (auto [M, N, K] : shapes) {
+        // Kernels are specialized per shape, not per head count
+        TuneParams pReg = matmulParams(tuningDB, device, "register_matmul", M, N, K);
+        TuneParams pGemm = matmulParams(tuningDB, device, "gemm", M, N, K);
+        cl::Program regProgram = buildProgram(context, device, regSrc, buildOptions(pReg));
+        cl::Program gemmProgram = buildProgram(context, device, gemmSrc, buildOptions(pGemm));
+        cl::Kernel kReg(regProgram, "register_matmul");
+        cl::Kernel kGemm(gemmProgram, "gemm");
+        cl::Kernel kBatched(gemmProgram, batchedKernelName(false).c_str());
+
+        // B^T per head: plain, and with v = gate[idx] * acc + residual[idx] fused into the store
+        Epilogue epiGateRes;
+        epiGateRes.gated = true;
+        epiGateRes.residual = true;
+        TuneParams pNt = matmulParams(tuningDB, device, "gemm_nt", M, N, K);
+        cl::Kernel kBatchedNt(buildProgram(context, device, gemmSrc, buildOptions(pNt)), batchedKernelName(true).c_str());
+        cl::Kernel kBatchedNtEpi(buildProgram(context, device, withEpilogue(gemmSrc), buildOptions(pNt) + epiGateRes.buildOptions()),
+                                 batchedKernelName(true).c_str());
+
+        for (int heads : headCounts) {
+            GemmBatch g = GemmBatch::packed(M, N, K, heads);
+            GemmBatch gShared = GemmBatch::packed(M, N, K, heads, false, false, true);
+            GemmBatch gNt = GemmBatch::packed(M, N, K, heads, true);
+
+            vector<float> A(g.elementsA()), B(g.elementsB()), C(g.elementsC());
+            fillGemmInputs(A, B);
+
+            // Transposed B and exact epilogue operands (multiples of 1/16, distinct per head)
+            vector<float> Bt(B.size()), gate(C.size()), residual(C.size()), refNt(C.size()), refEpi(C.size());
+            for (int h = 0; h < heads; h++)
+                for (int k = 0; k < K; k++)
+                    for (int n = 0; n < N; n++) Bt[h * gNt.strideB + (size_t)n * K + k] = B[h * g.strideB + (size_t)k * N + n];
+            for (size_t i = 0; i < C.size(); i++) {
+                gate[i] = (float)((i * 3) % 11) * 0.0625f - 0.25f;
+                residual[i] = (float)((i * 5) % 7) * 0.0625f - 0.125f;
+            }
+            for (int h = 0; h < heads; h++)
+                cpuGemm(A.data() + h * gNt.strideA, Bt.data() + h * gNt.strideB, refNt.data() + h * gNt.strideC, M, N, K, true);
+            for (size_t i = 0; i < C.size(); i++) refEpi[i] = gate[i] * refNt[i] + residual[i];
+
+            // Contiguous buffers for the batched kernels, one buffer set per head for the loops
+            cl::Buffer bufA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * A.size(), A.data());
+            cl::Buffer bufB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * B.size(), B.data());
+            cl::Buffer bufC(context, CL_MEM_WRITE_ONLY, sizeof(float) * C.size());
+            cl::Buffer bufBt(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * Bt.size(), Bt.data());
+            cl::Buffer bufGate(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * gate.size(), gate.data());
+            cl::Buffer bufResidual(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * residual.size(), residual.data());
+            vector<cl::Buffer> headA, headB, headC;
+            for (int h = 0; h < heads; h++) {
+                headA.emplace_back(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * M * K, A.data() + h * g.strideA);
+                headB.emplace_back(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * K * N, B.data() + h * g.strideB);
+                headC.emplace_back(context, CL_MEM_WRITE_ONLY, sizeof(float) * M * N);
+            }
+
+            // Spot-check 64 outputs per head against a double-precision dot product
+            auto verify = [&](const GemmBatch& gb, const function<const float*(int)>& headOut) {
+                for (int h = 0; h < heads; h++) {
+                    if (!spotCheckGemm(A.data() + h * gb.strideA, B.data() + h * gb.strideB, headOut(h), M, N, K))
+                        return false;
+                }
+                return true;
+            };
+            auto readHeads = [&](vector<cl::Buffer>& bufs) {
+                for (int h = 0; h < heads; h++)
+                    queue.enqueueReadBuffer(bufs[h], CL_TRUE, 0, sizeof(float) * M * N, C.data() + h * g.strideC);
+            };
+            // Every output against a host result (the transB rows)
+            auto matches = [&](const vector<float>& ref) {
+                for (size_t i = 0; i < C.size(); i++)
+                    if (std::abs(ref[i] - C[i]) > 1e-3 * (1.0 + std::abs(ref[i]))) return false;
+                return true;
+            };
+            // Variants share the output buffers: overwrite the previous result so a launch that
+            // writes nothing can't pass on it. No correct output gets near this value.
+            auto clearOutputs = [&] {
+                const float stale = -1.0e6f;
+                queue.enqueueFillBuffer(bufC, stale, 0, sizeof(float) * C.size());
+                for (auto& b : headC) queue.enqueueFillBuffer(b, stale, 0, sizeof(float) * M * N);
+                queue.finish();
+            };
+
+            // 1. Loop of register_matmul launches (the baseline)
+            clearOutputs();
+            Timing tLoopReg = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(heads);
+                for (int h = 0; h < heads; h++) {
+                    kReg.setArg(0, headA[h]); kReg.setArg(1, headB[h]); kReg.setArg(2, headC[h]);
+                    kReg.setArg(3, M); kReg.setArg(4, N); kReg.setArg(5, K);
+                    queue.enqueueNDRangeKernel(kReg, cl::NullRange, matmulGlobalSize("register_matmul", pReg, M, N),
+                                               cl::NDRange(pReg.localX, pReg.localY), nullptr, &ev[h]);
+                }
+                return ev;
+            });
+            readHeads(headC);
+            bool okLoopReg = verify(g, [&](int h) { return C.data() + h * g.strideC; });
+
+            // 2. Loop of gemm launches (same kernel body as the batched path, isolates launch cost)
+            clearOutputs();
+            Timing tLoopGemm = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(heads);
+                for (int h = 0; h < heads; h++) {
+                    kGemm.setArg(0, headA[h]); kGemm.setArg(1, headB[h]); kGemm.setArg(2, headC[h]);
+                    kGemm.setArg(3, M); kGemm.setArg(4, N); kGemm.setArg(5, K);
+                    queue.enqueueNDRangeKernel(kGemm, cl::NullRange, matmulGlobalSize("gemm", pGemm, M, N),
+                                               cl::NDRange(pGemm.localX, pGemm.localY), nullptr, &ev[h]);
+                }
+                return ev;
+            });
+            readHeads(headC);
+            bool okLoopGemm = verify(g, [&](int h) { return C.data() + h * g.strideC; });
+
+            // 3. One strided-batched launch
+            clearOutputs();
+            Timing tBatched = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(1);
+                enqueueBatchedGemm(queue, kBatched, pGemm, g, bufA, bufB, bufC, nullptr, &ev[0]);
+                return ev;
+            });
+            queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+            bool okBatched = verify(g, [&](int h) { return C.data() + h * g.strideC; });
+
+            // 4. One batched launch with B broadcast (strideB = 0): every head multiplies the same weight
+            clearOutputs();
+            Timing tShared = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(1);
+                enqueueBatchedGemm(queue, kBatched, pGemm, gShared, bufA, bufB, bufC, nullptr, &ev[0]);
+                return ev;
+            });
+            queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+            bool okShared = verify(gShared, [&](int h) { return C.data() + h * gShared.strideC; });
+
+            // 5. gemm_nt_batched: B per head as [N][K]
+            clearOutputs();
+            Timing tNt = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(1);
+                enqueueBatchedGemm(queue, kBatchedNt, pNt, gNt, bufA, bufBt, bufC, nullptr, &ev[0]);
+                return ev;
+            });
+            queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+            bool okNt = matches(refNt);
+
+            // 6. Same with the gate + residual epilogue (operands at b * strideC, like C)
+            clearOutputs();
+            setEpilogueArgs(kBatchedNtEpi, 9, epiGateRes, cl::Buffer(), bufResidual, bufGate);
+            Timing tNtEpi = timeBatch(queue, reps, [&] {
+                vector<cl::Event> ev(1);
+                enqueueBatchedGemm(queue, kBatchedNtEpi, pNt, gNt, bufA, bufBt, bufC, nullptr, &ev[0]);
+                return ev;
+            });
+            queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+            bool okNtEpi = matches(refEpi);
+
+            string label = to_string(heads) + " x " + to_string(M) + "x" + to_string(N) + "x" + to_string(K);
+            auto row = [&](const string& first, const string& mode, int launches, const Timing& t, bool ok) {
+                cout << left << setw(16) << first
+                     << setw(22) << mode
+                     << setw(10) << launches
+                     << setw(12) << fixed << setprecision(3) << t.wallMs
+                     << setw(12) << t.kernelMs
+                     << setw(10) << setprecision(1) << g.flops() / (t.wallMs * 1.0e6)
+                     << setw(11) << (to_string(tLoopReg.wallMs / t.wallMs).substr(0, 4) + "x")
+                     << (ok ? "PASS" : "FAIL") << endl;
+            };
+            row(label, "Loop register_matmul", heads, tLoopReg, okLoopReg);
+            row("", "Loop gemm", heads, tLoopGemm, okLoopGemm);
+            row("", "Batched gemm", 1, tBatched, okBatched);
+            row("", "Batched, shared B", 1, tShared, okShared);
+            row("", "Batched gemm_nt", 1, tNt, okNt);
+            row("", "Batched nt, gate+res", 1, tNtEpi, okNtEpi);
+            cout << string(100, '-') << endl;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include "utils/cpu_gemm.hpp"
+
+using namespace std;
+
+// Usage: cpu_gemm [--sizes 512,1024,2048,4096] [--threads N] [--reps N] [--isa all|best]
+// The host GEMM backend (utils/cpu_gemm.hpp) on N x N x N problems with no OpenCL device involved,
+// so it runs on GPU-less CI machines. Every micro-kernel the CPU supports is timed (best of
+// 'reps') with B as [K][N] and, as "<isa> nt", as [N][K]; plus one scalar triple loop at the
+// smallest size for scale. Up to N = 512 every output is compared with cpuGemmScalar (exact
+// inputs, so bit for bit); above that 256 outputs per run are checked against a
+// double-precision dot product. Sizes that are not a multiple of the micro-tile width exercise
+// the edge tiles (ctest runs --sizes 64,100,257).
+
+int main(int argc, char** argv) {
+    vector<int> sizes = {512, 1024, 2048, 4096};
+    int threads = 0, reps = 3;
+    bool allIsas = true;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threads") threads = stoi(argv[++i]);
+        else if (arg == "--reps") reps = max(1, stoi(argv[++i]));
+        else if (arg == "--isa") allIsas = string(argv[++i]) != "best";
+        else if (arg == "--sizes") {
+            sizes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) sizes.push_back(stoi(item));
+        }
+    }
+
+    ThreadPool pool(threads);
+    CpuIsa best = detectCpuIsa();
+    vector<CpuIsa> isas = {best};
+    if (allIsas) {
+        isas.clear();
+        for (CpuIsa isa : {CpuIsa::Generic, CpuIsa::AVX2, CpuIsa::AVX512}) {
+            if ((int)isa <= (int)best) isas.push_back(isa);
+        }
+    }
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Backend            : cpuGemm (packed panels, thread pool)" << endl;
+    cout << "Best ISA           : " << cpuIsaName(best) << endl;
+    cout << "Threads            : " << pool.size() << endl;
+    cout << "Reps               : " << reps << " (best of)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(8) << "Size"
+         << setw(14) << "Kernel"
+         << setw(14) << "Time(ms)"
+         << setw(12) << "GFLOP/s"
+         << setw(10) << "Result" << endl;
+    cout << string(58, '-') << endl;
+
+    bool failed = false;
+    for (int N : sizes) {
+        vector<float> A((size_t)N * N), B((size_t)N * N), C((size_t)N * N);
+        fillGemmInputs(A, B);
+        double flops = 2.0 * N * N * N;
+
+        // Same product with B stored as [N][K], for the transB packing path
+        vector<float> Bt((size_t)N * N);
+        for (int k = 0; k < N; k++)
+            for (int n = 0; n < N; n++) Bt[(size_t)n * N + k] = B[(size_t)k * N + n];
+
+        bool fullCheck = N <= 512;
+        vector<float> ref;
+        if (fullCheck) {
+            ref.resize(C.size());
+            cpuGemmScalar(A.data(), B.data(), ref.data(), N, N, N);
+        }
+        auto verify = [&](bool transB) {
+            if (fullCheck) return C == ref;
+            return spotCheckGemm(A.data(), transB ? Bt.data() : B.data(), C.data(), N, N, N, transB, 256);
+        };
+        auto printRow = [&](const string& size, const string& name, double ms, bool pass) {
+            cout << left << setw(8) << size
+                 << setw(14) << name
+                 << setw(14) << fixed << setprecision(3) << ms
+                 << setw(12) << setprecision(1) << flops / (ms * 1.0e6)
+                 << setw(10) << (pass ? "PASS" : "FAIL") << endl;
+            failed |= !pass;
+        };
+
+        string label = to_string(N);
+        if (N == sizes.front()) {
+            auto t0 = chrono::steady_clock::now();
+            cpuGemmScalar(A.data(), B.data(), C.data(), N, N, N);
+            printRow(label, "scalar", chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count(), verify(false));
+            label = "";
+        }
+        for (CpuIsa isa : isas) {
+            for (bool transB : {false, true}) {
+                double bestMs = 0.0;
+                for (int r = 0; r < reps; r++) {
+                    fill(C.begin(), C.end(), 0.0f);
+                    auto t0 = chrono::steady_clock::now();
+                    cpuGemm(A.data(), transB ? Bt.data() : B.data(), C.data(), N, N, N, transB, &pool, &isa);
+                    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+                    if (r == 0 || ms < bestMs) bestMs = ms;
+                }
+                printRow(label, string(cpuIsaName(isa)) + (transB ? " nt" : ""), bestMs, verify(transB));
+                label = "";
+            }
+        }
+        cout << string(58, '-') << endl;
+    }
+    return failed ? 1 : 0;
+}
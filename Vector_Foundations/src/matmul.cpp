@@ -5,17 +5,26 @@
 #include <fstream>
 #include <iomanip>
 #include <cmath> 
-#include "C:/Users/ASUS/Desktop/Shreyas/OpenCL-LLM/utils/utils.hpp"
+#include <map>
+#include <algorithm>
+#include <chrono>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/shared_buffer.hpp"
+#include "utils/cpu_gemm.hpp"
 
 using namespace std;
 
-int main() {
+int main(int argc, char** argv) {
+    vector<int> testSizes = {128, 256, 512, 1024, 2048, 4096};
+
+    // --- Backend ---
+    // No OpenCL device (or --backend host): time the host GEMM on the same sizes instead of exiting
+    if (selectGemmBackend(argc, argv) == GemmBackend::Host) return runHostGemm(testSizes, 3) ? 0 : 1;
+
     // --- Device Setup ---
-    vector<cl::Platform> platforms;
-    vector<cl::Device> devices;
-    cl::Platform::get(&platforms);
-    platforms[0].getDevices(CL_DEVICE_TYPE_GPU, &devices);
-    cl::Device device = devices[0];
+    cl::Device device = selectDevice(argc, argv);
     cl::Context context(device);
     cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
 
@@ -43,122 +52,182 @@ int main() {
     cout << "-----------------------------------------------------------\n" << endl;
 
     // --- Build Section ---
-    string naiveSrc = readKernelFile("Vector_Foundations\\kernels\\naive_matmul.cl") + "\n";
-    string sramSrc = readKernelFile("Vector_Foundations\\kernels\\matmul.cl") + "\n";
-    string regSrc = readKernelFile("Vector_Foundations\\kernels\\register_matmul.cl") + "\n";
-    
-    cl::Program::Sources sources;
-    sources.push_back({naiveSrc.c_str(), naiveSrc.length()});
-    sources.push_back({sramSrc.c_str(), sramSrc.length()});
-    sources.push_back({regSrc.c_str(), regSrc.length()});
-
-    cl::Program program(context, sources);
-    if (program.build("-cl-std=CL2.0") != CL_SUCCESS) {
-        cout << "Error building: " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << endl;
-        return 1;
-    }
+    string naiveSrc = readKernelFile("Vector_Foundations/kernels/naive_matmul.cl") + "\n";
+    string sramSrc = readKernelFile("Vector_Foundations/kernels/matmul.cl") + "\n";
+    string regSrc = readKernelFile("Vector_Foundations/kernels/register_matmul.cl") + "\n";
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl") + "\n";
 
-    cl::Kernel kernelNaive(program, "naive_matmul");
-    cl::Kernel kernelSRAM(program, "matmul");       
-    cl::Kernel kernelReg(program, "register_matmul");    
+    // Loads a cached binary on warm runs instead of recompiling
+    cl::Program naiveProgram = buildProgram(context, device, naiveSrc);
+    cl::Kernel kernelNaive(naiveProgram, "naive_matmul");
+
+    // Tiled kernels are specialized per size from the tuning database (see matmul_tuner.cpp)
+    TuningDB tuningDB;
+    map<string, cl::Kernel> tunedKernels;
+    auto getTunedKernel = [&](const string& name, const string& src, const TuneParams& p) {
+        string options = buildOptions(p);
+        auto it = tunedKernels.find(name + options);
+        if (it != tunedKernels.end()) return it->second;
+        cl::Program program = buildProgram(context, device, src, options);
+        return tunedKernels[name + options] = cl::Kernel(program, name.c_str());
+    };
+
+    // --- Buffer Modes: explicit copies vs. the zero-copy path for this device ---
+    // On UMA devices (integrated GPU, CPU) chooseBufferMode picks SVM or page-aligned host pointers;
+    // on discrete GPUs it copies, and the comparison row uses ALLOC_HOST_PTR (pinned, mapped) instead.
+    BufferMode zeroCopyMode = chooseBufferMode(device);
+    if (zeroCopyMode == BufferMode::Copy) zeroCopyMode = BufferMode::AllocHostPtr;
+    cout << "Unified Memory     : " << (isUnifiedMemory(device) ? "YES" : "NO") << endl;
+    cout << "Zero-Copy Mode     : " << bufferModeName(zeroCopyMode) << endl;
+    cout << "Host Reference     : cpuGemm, " << cpuIsaName(detectCpuIsa()) << ", " << defaultThreadPool().size() << " threads\n" << endl;
 
     // --- Table Header ---
     cout << "Table\n-----------------------------------------------------------" << endl;
     cout << left << setw(6)  << "Size" 
+         << setw(14) << "Buffers"
          << setw(16) << "Kernel"
          << setw(14) << "Kernel(ms)" 
          << setw(14) << "HRAM In(ms)"
          << setw(14) << "HRAM Out(ms)" 
          << setw(10) << "Result" << endl;
-    cout << string(85, '-') << endl;
+    cout << string(95, '-') << endl;
 
-    vector<int> testSizes = {128, 256, 512, 1024, 2048, 4096};
+    // Helper to extract timings safely; steps that enqueue nothing (fine-grained SVM) cost 0
+    auto get_ms = [](cl::Event& e) {
+        if (!e()) return 0.0;
+        e.wait(); 
+        cl_ulong start, end;
+        e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+        e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
+        return (end - start) * 1.0e-6;
+    };
+
+    // Copy-mode device buffers come from one arena: every size/mode pass releases its blocks on
+    // scope exit and the next pass takes them back out of the same slabs.
+    DeviceArena arena(context, device);
 
     for (int N : testSizes) {
+      // Exact inputs (fillGemmInputs): any correct kernel matches the host result bit for bit
+      vector<float> hostA((size_t)N * N), hostB((size_t)N * N), hostC((size_t)N * N);
+      fillGemmInputs(hostA, hostB);
+
+      // Independent host reference (multithreaded SIMD, utils/cpu_gemm.hpp), timed like a kernel
+      auto cpuStart = chrono::steady_clock::now();
+      {
+          TraceSpan span("cpuGemm reference");
+          cpuGemm(hostA.data(), hostB.data(), hostC.data(), N, N, N);
+      }
+      double tCPU = chrono::duration<double, milli>(chrono::steady_clock::now() - cpuStart).count();
+
+      for (BufferMode mode : {BufferMode::Copy, zeroCopyMode}) {
         int Arow = N, Bcol = N, Brow = N;
-        vector<float> A(N * N, 1.0f), B(N * N, 2.0f);
-        
-        vector<float> C_naive(N * N, 0.0f);
-        vector<float> C_sram(N * N, 0.0f);
-        vector<float> C_reg(N * N, 0.0f);
+        size_t bytes = sizeof(float) * N * N;
 
-        cl::Buffer bufA(context, CL_MEM_READ_ONLY, sizeof(float)*A.size());
-        cl::Buffer bufB(context, CL_MEM_READ_ONLY, sizeof(float)*B.size());
-        cl::Buffer bufC_naive(context, CL_MEM_WRITE_ONLY, sizeof(float)*C_naive.size());
-        cl::Buffer bufC_sram(context, CL_MEM_WRITE_ONLY, sizeof(float)*C_sram.size());
-        cl::Buffer bufC_reg(context, CL_MEM_WRITE_ONLY, sizeof(float)*C_reg.size());
+        SharedBuffer bufA(arena, bytes, mode, CL_MEM_READ_ONLY);
+        SharedBuffer bufB(arena, bytes, mode, CL_MEM_READ_ONLY);
+        SharedBuffer bufC_naive(arena, bytes, mode, CL_MEM_WRITE_ONLY);
+        SharedBuffer bufC_sram(arena, bytes, mode, CL_MEM_WRITE_ONLY);
+        SharedBuffer bufC_reg(arena, bytes, mode, CL_MEM_WRITE_ONLY);
+        SharedBuffer bufC_gemm(arena, bytes, mode, CL_MEM_WRITE_ONLY);
 
-        cl::Event evInA, evInB;
-        cl::Event evKNaive, evOutNaive;
-        cl::Event evKSRAM, evOutSRAM;
-        cl::Event evKReg, evOutReg;
+        // "In" is every command that makes the host-written inputs visible to the device:
+        // the write in Copy mode, the map + unmap pair in the zero-copy modes.
+        cl::Event evMapA, evInA, evMapB, evInB;
+        cl::Event evKNaive, evOutNaive, evUnmapNaive;
+        cl::Event evKSRAM, evOutSRAM, evUnmapSRAM;
+        cl::Event evKReg, evOutReg, evUnmapReg;
+        cl::Event evKGemm, evOutGemm, evUnmapGemm;
 
-        queue.enqueueWriteBuffer(bufA, CL_FALSE, 0, sizeof(float)*A.size(), A.data(), nullptr, &evInA);
-        queue.enqueueWriteBuffer(bufB, CL_FALSE, 0, sizeof(float)*B.size(), B.data(), nullptr, &evInB);
+        float* A = bufA.mapWrite<float>(queue, &evMapA);
+        copy(hostA.begin(), hostA.end(), A);
+        bufA.unmapWrite(queue, &evInA);
+        float* B = bufB.mapWrite<float>(queue, &evMapB);
+        copy(hostB.begin(), hostB.end(), B);
+        bufB.unmapWrite(queue, &evInB);
 
         // --- 1. Run Naive ---
-        kernelNaive.setArg(0, bufA); kernelNaive.setArg(1, bufB); kernelNaive.setArg(2, bufC_naive);
+        bufA.setArg(kernelNaive, 0); bufB.setArg(kernelNaive, 1); bufC_naive.setArg(kernelNaive, 2);
         kernelNaive.setArg(3, Arow); kernelNaive.setArg(4, Bcol); kernelNaive.setArg(5, Brow);
         queue.enqueueNDRangeKernel(kernelNaive, cl::NullRange, cl::NDRange(Bcol, Arow), cl::NullRange, nullptr, &evKNaive);
-        queue.enqueueReadBuffer(bufC_naive, CL_TRUE, 0, sizeof(float)*C_naive.size(), C_naive.data(), nullptr, &evOutNaive);
+        traceCommand(queue, evKNaive, "naive_matmul");
 
         // --- 2. Run SRAM Tiled ---
-        kernelSRAM.setArg(0, bufA); kernelSRAM.setArg(1, bufB); kernelSRAM.setArg(2, bufC_sram);
+        TuneParams pSRAM = matmulParams(tuningDB, device, "matmul", Arow, Bcol, Brow);
+        cl::Kernel kernelSRAM = getTunedKernel("matmul", sramSrc, pSRAM);
+        bufA.setArg(kernelSRAM, 0); bufB.setArg(kernelSRAM, 1); bufC_sram.setArg(kernelSRAM, 2);
         kernelSRAM.setArg(3, Arow); kernelSRAM.setArg(4, Bcol); kernelSRAM.setArg(5, Brow);
-        cl::NDRange localWorkSizeSRAM(16, 16); 
-        queue.enqueueNDRangeKernel(kernelSRAM, cl::NullRange, cl::NDRange(Bcol, Arow), localWorkSizeSRAM, nullptr, &evKSRAM);
-        queue.enqueueReadBuffer(bufC_sram, CL_TRUE, 0, sizeof(float)*C_sram.size(), C_sram.data(), nullptr, &evOutSRAM);
+        cl::NDRange localWorkSizeSRAM(pSRAM.localX, pSRAM.localY);
+        queue.enqueueNDRangeKernel(kernelSRAM, cl::NullRange, matmulGlobalSize("matmul", pSRAM, Arow, Bcol), localWorkSizeSRAM, nullptr, &evKSRAM);
+        traceCommand(queue, evKSRAM, "matmul");
 
-        // --- 3. Run Register Tiled (WPT = 4) ---
-        // FIXED: Explicitly set the arguments for the register kernel
-        kernelReg.setArg(0, bufA); kernelReg.setArg(1, bufB); kernelReg.setArg(2, bufC_reg);
+        // --- 3. Run Register Tiled (WPT from the tuning database) ---
+        TuneParams pReg = matmulParams(tuningDB, device, "register_matmul", Arow, Bcol, Brow);
+        cl::Kernel kernelReg = getTunedKernel("register_matmul", regSrc, pReg);
+        bufA.setArg(kernelReg, 0); bufB.setArg(kernelReg, 1); bufC_reg.setArg(kernelReg, 2);
         kernelReg.setArg(3, Arow); kernelReg.setArg(4, Bcol); kernelReg.setArg(5, Brow);
-        
-        cl::NDRange localWorkSizeReg(16, 16);
-        int WPT = 4;
-        cl::NDRange globalWorkSizeReg(Bcol / WPT, Arow); // Shrink the grid horizontally
-        
+
+        cl::NDRange localWorkSizeReg(pReg.localX, pReg.localY);
+        cl::NDRange globalWorkSizeReg = matmulGlobalSize("register_matmul", pReg, Arow, Bcol); // Grid shrinks horizontally by WPT
+
         queue.enqueueNDRangeKernel(kernelReg, cl::NullRange, globalWorkSizeReg, localWorkSizeReg, nullptr, &evKReg);
-        queue.enqueueReadBuffer(bufC_reg, CL_TRUE, 0, sizeof(float)*C_reg.size(), C_reg.data(), nullptr, &evOutReg);
+        traceCommand(queue, evKReg, "register_matmul");
 
-        // Helper to extract timings safely
-        auto get_ms = [](cl::Event& e) {
-            e.wait(); 
-            cl_ulong start, end;
-            e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
-            e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
-            return (end - start) * 1.0e-6;
-        };
+        // --- 4. Run 2D Register Blocked (gemm.cl, tile shape from the tuning database) ---
+        TuneParams pGemm = matmulParams(tuningDB, device, "gemm", Arow, Bcol, Brow);
+        cl::Kernel kernelGemm = getTunedKernel("gemm", gemmSrc, pGemm);
+        bufA.setArg(kernelGemm, 0); bufB.setArg(kernelGemm, 1); bufC_gemm.setArg(kernelGemm, 2);
+        kernelGemm.setArg(3, Arow); kernelGemm.setArg(4, Bcol); kernelGemm.setArg(5, Brow);
+        queue.enqueueNDRangeKernel(kernelGemm, cl::NullRange, matmulGlobalSize("gemm", pGemm, Arow, Bcol),
+                                   cl::NDRange(pGemm.localX, pGemm.localY), nullptr, &evKGemm);
+        traceCommand(queue, evKGemm, "gemm");
+
+        // --- Results back to the host (read in Copy mode, blocking map otherwise) ---
+        const float* C_naive = bufC_naive.mapRead<float>(queue, &evOutNaive);
+        const float* C_sram = bufC_sram.mapRead<float>(queue, &evOutSRAM);
+        const float* C_reg = bufC_reg.mapRead<float>(queue, &evOutReg);
+        const float* C_gemm = bufC_gemm.mapRead<float>(queue, &evOutGemm);
+
+        // Verification logic
+        bool matchNaive = true, matchSRAM = true, matchReg = true, matchGemm = true;
+        for(size_t i=0; i<(size_t)N*N; ++i) {
+            if(std::abs(hostC[i] - C_naive[i]) > 1e-3) { matchNaive = false; }
+            if(std::abs(hostC[i] - C_sram[i]) > 1e-3) { matchSRAM = false; }
+            if(std::abs(hostC[i] - C_reg[i]) > 1e-3) { matchReg = false; }
+            if(std::abs(hostC[i] - C_gemm[i]) > 1e-3) { matchGemm = false; }
+        }
+
+        bufC_naive.unmapRead(queue, &evUnmapNaive);
+        bufC_sram.unmapRead(queue, &evUnmapSRAM);
+        bufC_reg.unmapRead(queue, &evUnmapReg);
+        bufC_gemm.unmapRead(queue, &evUnmapGemm);
+        queue.finish();
 
         // Calculate transfer time
-        double tIn = get_ms(evInA) + get_ms(evInB);
+        double tIn = get_ms(evMapA) + get_ms(evInA) + get_ms(evMapB) + get_ms(evInB);
         
-        // Calculate kernel times (FIXED: actually timing evKReg now)
+        // Calculate kernel times
         double tKNaive = get_ms(evKNaive);
         double tKSRAM = get_ms(evKSRAM);
         double tKReg = get_ms(evKReg);
+        double tKGemm = get_ms(evKGemm);
 
         // Calculate output times
-        double tOutNaive = get_ms(evOutNaive);
-        double tOutSRAM = get_ms(evOutSRAM);
-        double tOutReg = get_ms(evOutReg);
-
-        // Verification logic
-        bool matchSRAM = true, matchReg = true;
-        for(size_t i=0; i<C_naive.size(); ++i) {
-            if(std::abs(C_naive[i] - C_sram[i]) > 1e-3) { matchSRAM = false; }
-            if(std::abs(C_naive[i] - C_reg[i]) > 1e-3) { matchReg = false; }
-        }
+        double tOutNaive = get_ms(evOutNaive) + get_ms(evUnmapNaive);
+        double tOutSRAM = get_ms(evOutSRAM) + get_ms(evUnmapSRAM);
+        double tOutReg = get_ms(evOutReg) + get_ms(evUnmapReg);
+        double tOutGemm = get_ms(evOutGemm) + get_ms(evUnmapGemm);
 
         // --- Clean Output ---
-        cout << left << setw(6)  << N 
+        cout << left << setw(6)  << (mode == BufferMode::Copy ? to_string(N) : "") 
+             << setw(14) << bufferModeName(mode)
              << setw(16) << "Naive"
              << setw(14) << fixed << setprecision(3) << tKNaive 
              << setw(14) << tIn 
              << setw(14) << tOutNaive 
-             << setw(10) << "PASS" << endl;
+             << setw(10) << (matchNaive ? "PASS" : "FAIL") << endl;
              
         cout << left << setw(6)  << "" 
+             << setw(14) << ""
              << setw(16) << "SRAM Tiled"
              << setw(14) << fixed << setprecision(3) << tKSRAM 
              << setw(14) << "-" 
@@ -166,14 +235,34 @@ int main() {
              << setw(10) << (matchSRAM ? "Speedup: " + to_string(tKNaive/tKSRAM).substr(0,4) + "x" : "FAIL") << endl;
 
         cout << left << setw(6)  << "" 
+             << setw(14) << ""
              << setw(16) << "Register Tiled"
              << setw(14) << fixed << setprecision(3) << tKReg 
              << setw(14) << "-" 
              << setw(14) << tOutReg 
              << setw(10) << (matchReg ? "Speedup: " + to_string(tKNaive/tKReg).substr(0,4) + "x" : "FAIL") << endl;
-             
-        cout << string(85, '-') << endl;
+
+        cout << left << setw(6)  << "" 
+             << setw(14) << ""
+             << setw(16) << "2D Register"
+             << setw(14) << fixed << setprecision(3) << tKGemm 
+             << setw(14) << "-" 
+             << setw(14) << tOutGemm 
+             << setw(10) << (matchGemm ? "Speedup: " + to_string(tKNaive/tKGemm).substr(0,4) + "x" : "FAIL") << endl;
+
+        if (mode == BufferMode::Copy) {
+            cout << left << setw(6)  << ""
+                 << setw(14) << "Host"
+                 << setw(16) << "CPU SIMD"
+                 << setw(14) << fixed << setprecision(3) << tCPU
+                 << setw(14) << "-"
+                 << setw(14) << "-"
+                 << setw(10) << "Speedup: " + to_string(tKNaive/tCPU).substr(0,4) + "x" << endl;
+        }
+      }
+      cout << string(95, '-') << endl;
     }
 
+    arena.printStats();
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,166 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <cstdio>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+
+using namespace std;
+
+// Usage: matmul_tuner [--device <spec>] [--sizes 512,1024,4096x11008x4096] [--db <file>] [--reps N]
+// Sweeps TileSize / WPT (gemm.cl: TSM / TSN / TSK / WPTM / WPTN) / work-group shape for the tiled matmul
+// kernels and stores the fastest configuration per (device, M, N, K bucket). matmul.cpp picks the
+// results up automatically.
+
+struct Shape { int M, N, K; };
+
+static vector<Shape> parseSizes(const string& list) {
+    vector<Shape> shapes;
+    stringstream ss(list);
+    string item;
+    while (getline(ss, item, ',')) {
+        Shape s;
+        if (sscanf(item.c_str(), "%dx%dx%d", &s.M, &s.N, &s.K) != 3) {
+            s.M = s.N = s.K = stoi(item);
+        }
+        shapes.push_back(s);
+    }
+    return shapes;
+}
+
+int main(int argc, char** argv) {
+    vector<Shape> shapes = parseSizes("256,512,1024,2048");
+    string dbPath = tuningDBPath();
+    int reps = 3;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--sizes") shapes = parseSizes(argv[++i]);
+        else if (arg == "--db") dbPath = argv[++i];
+        else if (arg == "--reps") reps = stoi(argv[++i]);
+    }
+
+    // --- Device Setup ---
+    cl::Device device = selectDevice(argc, argv);
+    cl::Context context(device);
+    cl::CommandQueue queue(context, device, CL_QUEUE_PROFILING_ENABLE);
+    DeviceLimits lim = queryLimits(device);
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    cout << "Device Name        : " << device.getInfo<CL_DEVICE_NAME>() << endl;
+    cout << "Max Work-Group     : " << lim.maxWGSize << " threads per group" << endl;
+    cout << "Local Memory (SRAM): " << lim.localMem / 1024 << " KB per Compute Unit" << endl;
+    cout << "Tuning Database    : " << dbPath << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    string naiveSrc = readKernelFile("Vector_Foundations/kernels/naive_matmul.cl");
+    map<string, string> tunedSrc = {
+        {"matmul", readKernelFile("Vector_Foundations/kernels/matmul.cl")},
+        {"register_matmul", readKernelFile("Vector_Foundations/kernels/register_matmul.cl")},
+        {"gemm", readKernelFile("Vector_Foundations/kernels/gemm.cl")},
+        {"gemm_nt", readKernelFile("Vector_Foundations/kernels/gemm.cl")},
+    };
+
+    cl::Program naiveProgram = buildProgram(context, device, naiveSrc);
+    cl::Kernel kernelNaive(naiveProgram, "naive_matmul");
+
+    TuningDB db(dbPath);
+    string devKey = deviceKey(device);
+
+    auto get_ms = [](cl::Event& e) {
+        e.wait();
+        cl_ulong start, end;
+        e.getProfilingInfo(CL_PROFILING_COMMAND_START, &start);
+        e.getProfilingInfo(CL_PROFILING_COMMAND_END, &end);
+        return (end - start) * 1.0e-6;
+    };
+
+    for (const Shape& s : shapes) {
+        // Non-trivial inputs so an indexing bug in a config can't hide behind uniform values
+        vector<float> A((size_t)s.M * s.K), B((size_t)s.K * s.N);
+        for (size_t i = 0; i < A.size(); i++) A[i] = (float)((i % 7) - 3) * 0.25f;
+        for (size_t i = 0; i < B.size(); i++) B[i] = (float)((i % 5) - 2) * 0.5f;
+        vector<float> C_ref((size_t)s.M * s.N), C((size_t)s.M * s.N);
+
+        cl::Buffer bufA(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * A.size(), A.data());
+        cl::Buffer bufB(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * B.size(), B.data());
+        cl::Buffer bufC(context, CL_MEM_WRITE_ONLY, sizeof(float) * C.size());
+
+        // gemm_nt takes B as [N][K]
+        vector<float> BT(B.size());
+        for (int k = 0; k < s.K; k++)
+            for (int n = 0; n < s.N; n++) BT[(size_t)n * s.K + k] = B[(size_t)k * s.N + n];
+        cl::Buffer bufBT(context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sizeof(float) * BT.size(), BT.data());
+
+        kernelNaive.setArg(0, bufA); kernelNaive.setArg(1, bufB); kernelNaive.setArg(2, bufC);
+        kernelNaive.setArg(3, s.M); kernelNaive.setArg(4, s.N); kernelNaive.setArg(5, s.K);
+        queue.enqueueNDRangeKernel(kernelNaive, cl::NullRange, cl::NDRange(s.N, s.M));
+        queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C_ref.size(), C_ref.data());
+
+        double flops = 2.0 * s.M * s.N * s.K;
+        cout << "Shape " << s.M << "x" << s.N << "x" << s.K << endl;
+        cout << left << setw(18) << "Kernel" << setw(36) << "Params" << setw(10) << "Local"
+             << setw(12) << "Best(ms)" << setw(12) << "GFLOP/s" << "Result" << endl;
+        cout << string(100, '-') << endl;
+
+        for (auto& [name, src] : tunedSrc) {
+            TuneParams best;
+            for (TuneParams p : matmulCandidates(name, lim)) {
+                cl_int err;
+                cl::Program program = buildProgram(context, device, src, buildOptions(p), &err);
+                if (err != CL_SUCCESS) continue;
+                cl::Kernel kernel(program, name.c_str());
+
+                // Register pressure can cap the group below the device maximum
+                size_t kernelWG = kernel.getWorkGroupInfo<CL_KERNEL_WORK_GROUP_SIZE>(device);
+                if (p.localX * p.localY > kernelWG) continue;
+
+                kernel.setArg(0, bufA); kernel.setArg(1, name == "gemm_nt" ? bufBT : bufB); kernel.setArg(2, bufC);
+                kernel.setArg(3, s.M); kernel.setArg(4, s.N); kernel.setArg(5, s.K);
+                cl::NDRange global = matmulGlobalSize(name, p, s.M, s.N);
+                cl::NDRange local(p.localX, p.localY);
+
+                // One warmup launch doubles as the correctness check
+                cl::Event ev;
+                if (queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &ev) != CL_SUCCESS) continue;
+                queue.enqueueReadBuffer(bufC, CL_TRUE, 0, sizeof(float) * C.size(), C.data());
+                bool match = true;
+                for (size_t i = 0; i < C.size() && match; ++i) {
+                    if (std::abs(C_ref[i] - C[i]) > 1e-3 * (1.0f + std::abs(C_ref[i]))) match = false;
+                }
+
+                double bestMs = 1e30;
+                for (int r = 0; r < reps && match; r++) {
+                    queue.enqueueNDRangeKernel(kernel, cl::NullRange, global, local, nullptr, &ev);
+                    bestMs = min(bestMs, get_ms(ev));
+                }
+                p.gflops = match ? flops / (bestMs * 1.0e6) : 0.0;
+
+                cout << left << setw(18) << name << setw(36) << encodeDefines(p.defines)
+                     << setw(10) << (to_string(p.localX) + "x" + to_string(p.localY))
+                     << setw(12) << fixed << setprecision(3) << (match ? bestMs : 0.0)
+                     << setw(12) << setprecision(1) << p.gflops << (match ? "PASS" : "FAIL") << endl;
+
+                if (match && p.gflops > best.gflops) best = p;
+            }
+
+            if (best.gflops > 0.0) {
+                db.record(devKey, name, s.M, s.N, s.K, best);
+                cout << ">> Best " << name << ": " << encodeDefines(best.defines) << " @ "
+                     << fixed << setprecision(1) << best.gflops << " GFLOP/s" << endl;
+            }
+        }
+        cout << string(100, '-') << "\n" << endl;
+    }
+
+    if (!db.save()) {
+        cerr << "Error: Could not write tuning database " << dbPath << endl;
+        return 1;
+    }
+    cout << "> Tuning complete. Results saved to '" << dbPath << "'." << endl;
+    return 0;
+}
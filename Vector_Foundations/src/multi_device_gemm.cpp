@@ -0,0 +1,129 @@
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#include <CL/opencl.hpp>
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+#include "utils/tuning.hpp"
+#include "utils/cpu_gemm.hpp"
+#include "utils/multi_device_gemm.hpp"
+
+using namespace std;
+
+// Usage: multi_device_gemm [--sizes 2048,4096] [--batch 1] [--tile 512] [--split N] [--reps N]
+// One GEMM (or --batch independent ones) split into --tile sized C tiles and spread over every
+// OpenCL device on the machine (utils/multi_device_gemm.hpp). --split N partitions each CPU device
+// into N sub-devices, which is how a POCL-only machine gets more than one worker.
+// Each size runs on every device alone, then on all of them with a static split and with work
+// stealing. Results are checked against cpuGemm, which also runs alone when there is no device.
+
+int main(int argc, char** argv) {
+    vector<int> sizes = {2048, 4096};
+    int batch = 1, tile = 512, split = 1, reps = 3;
+    for (int i = 1; i + 1 < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--batch") batch = max(1, stoi(argv[++i]));
+        else if (arg == "--tile") tile = max(16, stoi(argv[++i]));
+        else if (arg == "--split") split = max(1, stoi(argv[++i]));
+        else if (arg == "--reps") reps = max(1, stoi(argv[++i]));
+        else if (arg == "--sizes") {
+            sizes.clear();
+            stringstream ss(argv[++i]);
+            string item;
+            while (getline(ss, item, ',')) sizes.push_back(stoi(item));
+        }
+    }
+
+    // --- Backend: with no OpenCL device (or --backend host) the host GEMM does the work ---
+    if (selectGemmBackend(argc, argv) == GemmBackend::Host) return runHostGemm(sizes, reps) ? 0 : 1;
+
+    // --- Device Setup: every device of every platform ---
+    vector<HeteroDevice> devices = heterogeneousDevices(split);
+    if (devices.empty()) {
+        cerr << "Error: No OpenCL device found!" << endl;
+        return 1;
+    }
+
+    cout << "Details\n-----------------------------------------------------------" << endl;
+    for (size_t d = 0; d < devices.size(); d++) {
+        cout << "Device " << left << setw(12) << d << ": " << devices[d].name << " ("
+             << devices[d].device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() << " CUs)" << endl;
+    }
+    cout << "Tile               : " << tile << " x " << tile << endl;
+    cout << "Batch              : " << batch << endl;
+    cout << "Reps               : " << reps << " (best of, after one warmup)" << endl;
+    cout << "-----------------------------------------------------------\n" << endl;
+
+    string gemmSrc = readKernelFile("Vector_Foundations/kernels/gemm.cl");
+    TuningDB tuningDB;
+
+    cout << "Table\n-----------------------------------------------------------" << endl;
+    cout << left << setw(8) << "Size"
+         << setw(34) << "Devices"
+         << setw(14) << "Wall(ms)"
+         << setw(12) << "GFLOP/s"
+         << setw(10) << "Result" << endl;
+    cout << string(78, '-') << endl;
+
+    bool failed = false;
+    for (int N : sizes) {
+        // Exact inputs (fillGemmInputs): every correct tiling matches cpuGemm bit for bit
+        size_t elems = (size_t)N * N;
+        vector<float> A(elems * batch), Bt(elems * batch), C(elems * batch), ref(elems * batch);
+        fillGemmInputs(A, Bt);
+        vector<GemmJob> jobs;
+        for (int b = 0; b < batch; b++) {
+            cpuGemm(&A[b * elems], &Bt[b * elems], &ref[b * elems], N, N, N, true);
+            jobs.push_back({&A[b * elems], &Bt[b * elems], &C[b * elems], N, N, N});
+        }
+        double flops = 2.0 * N * N * N * batch;
+
+        // Warmup (also calibrates the initial shares), then best of 'reps'
+        auto measure = [&](MultiDeviceGemm& sched, bool steal) {
+            sched.run(jobs, steal);
+            double best = 0.0;
+            for (int r = 0; r < reps; r++) {
+                fill(C.begin(), C.end(), 0.0f);
+                double ms = sched.run(jobs, steal);
+                if (r == 0 || ms < best) best = ms;
+            }
+            bool pass = true;
+            for (size_t i = 0; i < C.size() && pass; i++) pass = std::abs(C[i] - ref[i]) <= 1e-3f;
+            failed |= !pass;
+            return make_pair(best, pass);
+        };
+        auto printRow = [&](const string& size, const string& name, pair<double, bool> r) {
+            cout << left << setw(8) << size
+                 << setw(34) << name.substr(0, 33)
+                 << setw(14) << fixed << setprecision(3) << r.first
+                 << setw(12) << setprecision(1) << flops / (r.first * 1.0e6)
+                 << setw(10) << (r.second ? "PASS" : "FAIL") << endl;
+        };
+
+        string label = to_string(N) + (batch > 1 ? "x" + to_string(batch) : "");
+        if (devices.size() > 1) {
+            for (auto& d : devices) {
+                MultiDeviceGemm single({d}, gemmSrc, tuningDB, tile, tile);
+                printRow(label, d.name, measure(single, false));
+                label = "";
+            }
+        }
+
+        MultiDeviceGemm all(devices, gemmSrc, tuningDB, tile, tile);
+        printRow(label, "All (static split)", measure(all, false));
+        printRow("", "All (work stealing)", measure(all, true));
+
+        // Where the tiles went in the last stealing run
+        for (auto& s : all.stats()) {
+            cout << left << setw(8) << "" << "  " << setw(32) << s.name.substr(0, 31)
+                 << s.tiles << " tiles (" << s.stolen << " stolen), " << fixed << setprecision(1) << s.gflops()
+                 << " GFLOP/s busy, " << s.uploadedBytes / (1024.0 * 1024.0) << " MB uploaded" << endl;
+        }
+        cout << string(78, '-') << endl;
+    }
+    return failed ? 1 : 0;
+}
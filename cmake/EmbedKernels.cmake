@@ -0,0 +1,80 @@
+# Embeds every <module>/kernels/*.cl into ${OPENCL_LLM_GENERATED_DIR}/embedded_kernels.hpp as
+# constexpr raw-string tables (see utils/kernel_registry.hpp), so programs need no kernel files
+# at runtime. For each file it also records the __kernel functions it defines and its
+# specialization parameters: every "#ifndef NAME / #define NAME <default>" pair, i.e. the -D
+# options the file understands. Runs at configure time; editing a .cl re-runs the configure step.
+# Expects OPENCL_LLM_GENERATED_DIR (set by OpenCLProgram.cmake).
+
+function(opencl_llm_embed_kernels root)
+    file(GLOB kernel_files RELATIVE "${root}" "${root}/*/kernels/*.cl")
+    list(SORT kernel_files)
+
+    set(out "// Generated by cmake/EmbedKernels.cmake from */kernels/*.cl. Do not edit.\n")
+    string(APPEND out "#ifndef EMBEDDED_KERNELS_HPP\n#define EMBEDDED_KERNELS_HPP\n\n")
+    string(APPEND out "namespace embedded_kernels {\n\n")
+
+    set(table "")
+    set(index 0)
+    foreach(rel ${kernel_files})
+        set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${root}/${rel}")
+        file(READ "${root}/${rel}" src)
+
+        # Source, split into 8 KB raw literals (MSVC caps a single literal at 16 KB)
+        string(APPEND out "// ${rel}\nconstexpr const char source${index}[] =")
+        string(LENGTH "${src}" len)
+        set(pos 0)
+        while(pos LESS len)
+            string(SUBSTRING "${src}" ${pos} 8192 chunk)
+            string(APPEND out "\n    R\"ocl_src(${chunk})ocl_src\"")
+            math(EXPR pos "${pos} + 8192")
+        endwhile()
+        if(len EQUAL 0)
+            string(APPEND out " \"\"")
+        endif()
+        string(APPEND out ";\n")
+
+        # __kernel entry points, with or without an __attribute__((...)) before the return type
+        string(REGEX MATCHALL "__kernel([ \t\n]+__attribute__\\(\\([^\n]*\\)\\))?[ \t\n]+void[ \t\n]+[A-Za-z_][A-Za-z_0-9]*"
+               decls "${src}")
+        set(names "")
+        foreach(decl ${decls})
+            string(REGEX REPLACE ".*[ \t\n]" "" fn "${decl}")
+            string(APPEND names "\"${fn}\", ")
+        endforeach()
+        list(LENGTH decls num_kernels)
+        string(APPEND out "constexpr const char* kernels${index}[] = {${names}nullptr};\n")
+
+        # Specialization parameters with their in-file defaults
+        string(REGEX MATCHALL "#ifndef[ \t]+[A-Za-z_][A-Za-z_0-9]*\n#define[ \t]+[A-Za-z_][A-Za-z_0-9]*[ \t]+[^\n]*" guards "${src}")
+        set(params "")
+        set(num_params 0)
+        foreach(guard ${guards})
+            string(REGEX MATCH "#ifndef[ \t]+([A-Za-z_0-9]+)\n#define[ \t]+([A-Za-z_0-9]+)[ \t]+([^\n]*)" _ "${guard}")
+            set(param "${CMAKE_MATCH_1}")
+            set(value "${CMAKE_MATCH_3}")
+            if(param STREQUAL CMAKE_MATCH_2)
+                string(STRIP "${value}" value)
+                string(REGEX REPLACE "[ \t]*//.*$" "" value "${value}")
+                string(REPLACE "\\" "\\\\" value "${value}")
+                string(REPLACE "\"" "\\\"" value "${value}")
+                string(APPEND params "{\"${param}\", \"${value}\"}, ")
+                math(EXPR num_params "${num_params} + 1")
+            endif()
+        endforeach()
+        string(APPEND out "constexpr EmbeddedKernelParam params${index}[] = {${params}{nullptr, nullptr}};\n\n")
+
+        set(ns "embedded_kernels::")
+        string(APPEND table "    {\"${rel}\", ${ns}source${index}, ${ns}kernels${index}, ${num_kernels}, ${ns}params${index}, ${num_params}},\n")
+        math(EXPR index "${index} + 1")
+    endforeach()
+
+    string(APPEND out "}  // namespace embedded_kernels\n\n")
+    string(APPEND out "constexpr EmbeddedKernelFile kEmbeddedKernels[] = {\n${table}")
+    string(APPEND out "    {nullptr, nullptr, nullptr, 0, nullptr, 0},\n};\n")
+    string(APPEND out "constexpr int kNumEmbeddedKernels = ${index};\n\n#endif\n")
+
+    # Only touch the header when a kernel changed, so unrelated reconfigures don't rebuild everything
+    file(WRITE "${OPENCL_LLM_GENERATED_DIR}/embedded_kernels.hpp.tmp" "${out}")
+    configure_file("${OPENCL_LLM_GENERATED_DIR}/embedded_kernels.hpp.tmp"
+                   "${OPENCL_LLM_GENERATED_DIR}/embedded_kernels.hpp" COPYONLY)
+endfunction()
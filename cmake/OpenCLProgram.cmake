@@ -0,0 +1,31 @@
+# Shared setup for every OpenCL host program in the repo: C++17, the OpenCL ICD loader, the
+# repo root on the include path so sources can include "utils/...", and the generated
+# embedded-kernel tables (cmake/EmbedKernels.cmake).
+# Usage (from any module's CMakeLists.txt): add_opencl_program(<target> <sources...>)
+
+# Imported targets and variables are directory-scoped, so these run for every including directory
+find_package(OpenCL REQUIRED)
+find_package(Threads REQUIRED)  # Host thread pool (utils/thread_pool.hpp)
+get_filename_component(OPENCL_LLM_ROOT "${CMAKE_CURRENT_LIST_DIR}/.." ABSOLUTE)
+set(OPENCL_LLM_GENERATED_DIR "${CMAKE_BINARY_DIR}/generated")
+
+if(COMMAND add_opencl_program)
+    return()
+endif()
+
+include(${CMAKE_CURRENT_LIST_DIR}/EmbedKernels.cmake)
+opencl_llm_embed_kernels(${OPENCL_LLM_ROOT})
+
+function(add_opencl_program name)
+    add_executable(${name} ${ARGN})
+    set_target_properties(${name} PROPERTIES CXX_STANDARD 17 CXX_STANDARD_REQUIRED ON)
+    target_include_directories(${name} PRIVATE ${OPENCL_LLM_ROOT} ${OPENCL_LLM_GENERATED_DIR} ${OpenCL_INCLUDE_DIRS})
+    target_link_libraries(${name} OpenCL::OpenCL Threads::Threads)
+
+    # Optional: Add compiler flags for optimization
+    if(MSVC)
+        target_compile_options(${name} PRIVATE /W4)
+    else()
+        target_compile_options(${name} PRIVATE -Wall -Wextra -O3)
+    endif()
+endfunction()
@@ -0,0 +1,65 @@
+// Strided-batched GEMM: 'batch' independent C[b] = A[b] * B[b] products (B[b]^T with transB) in a
+// single launch of gemm_batched / gemm_nt_batched (gemm.cl). The batch index is the third NDRange
+// dimension, so 32 heads of 128 x 128 fill 32x more compute units than one launch per head and
+// pay the launch overhead once.
+// Operand b starts at X + b * strideX (in floats); a stride of 0 broadcasts X to every batch.
+#ifndef BATCHED_GEMM_HPP
+#define BATCHED_GEMM_HPP
+
+#include <string>
+#include <vector>
+
+#include "utils/trace.hpp"
+#include "utils/tuning.hpp"
+
+struct GemmBatch {
+    int M = 0, N = 0, K = 0, batch = 1;
+    cl_long strideA = 0, strideB = 0, strideC = 0;  // Floats between consecutive matrices; 0 = broadcast
+    bool transB = false;                             // B[b] is [N][K] instead of [K][N]
+
+    // Densely packed operands; broadcastA / broadcastB share one matrix across the batch
+    static GemmBatch packed(int M, int N, int K, int batch, bool transB = false, bool broadcastA = false,
+                            bool broadcastB = false) {
+        GemmBatch g;
+        g.M = M; g.N = N; g.K = K; g.batch = batch; g.transB = transB;
+        g.strideA = broadcastA ? 0 : (cl_long)M * K;
+        g.strideB = broadcastB ? 0 : (cl_long)K * N;
+        g.strideC = (cl_long)M * N;
+        return g;
+    }
+
+    // Floats each buffer must hold
+    size_t elementsA() const { return (size_t)strideA * (batch - 1) + (size_t)M * K; }
+    size_t elementsB() const { return (size_t)strideB * (batch - 1) + (size_t)K * N; }
+    size_t elementsC() const { return (size_t)strideC * (batch - 1) + (size_t)M * N; }
+    double flops() const { return 2.0 * M * N * K * batch; }
+};
+
+inline std::string batchedKernelName(bool transB) { return transB ? "gemm_nt_batched" : "gemm_batched"; }
+
+// Tile shape comes from the single-matrix entry ("gemm" / "gemm_nt") for the per-batch shape:
+// the batched kernels share gemm_body, so the same -D parameters are valid and near-optimal.
+inline TuneParams batchedGemmParams(const TuningDB& db, const cl::Device& device, const GemmBatch& g) {
+    return matmulParams(db, device, g.transB ? "gemm_nt" : "gemm", g.M, g.N, g.K);
+}
+
+inline cl::NDRange batchedGlobalSize(const TuneParams& p, const GemmBatch& g) {
+    size_t tsm = p.get("TSM"), tsn = p.get("TSN");
+    return cl::NDRange((g.N + tsn - 1) / tsn * p.localX, (g.M + tsm - 1) / tsm * p.localY, g.batch);
+}
+
+// 'kernel' is batchedKernelName(g.transB) from gemm.cl built with buildOptions(p)
+inline cl_int enqueueBatchedGemm(cl::CommandQueue& queue, cl::Kernel& kernel, const TuneParams& p, const GemmBatch& g,
+                                 const cl::Buffer& A, const cl::Buffer& B, const cl::Buffer& C,
+                                 const std::vector<cl::Event>* waitList = nullptr, cl::Event* event = nullptr) {
+    kernel.setArg(0, A); kernel.setArg(1, B); kernel.setArg(2, C);
+    kernel.setArg(3, g.M); kernel.setArg(4, g.N); kernel.setArg(5, g.K);
+    kernel.setArg(6, g.strideA); kernel.setArg(7, g.strideB); kernel.setArg(8, g.strideC);
+    TraceEvent te(event);
+    cl_int err = queue.enqueueNDRangeKernel(kernel, cl::NullRange, batchedGlobalSize(p, g),
+                                            cl::NDRange(p.localX, p.localY, 1), waitList, te.get());
+    if (err == CL_SUCCESS) te.record(queue, g.transB ? "batched gemm_nt" : "batched gemm");
+    return err;
+}
+
+#endif
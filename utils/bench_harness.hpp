@@ -0,0 +1,304 @@
+// Shared benchmark harness: a registry of named benchmarks, warmup + repeated timing with
+// min / median / p95 statistics, GFLOP/s and GB/s, and CSV / JSON reports tagged with device
+// metadata and a free-form label (e.g. a commit hash) so runs can be compared across commits.
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include "utils/cl_runtime.hpp"
+#include "utils/device_peaks.hpp"
+#include "utils/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Command line: [--sizes 512,1024,16M] [--reps N] [--warmup N] [--filter substr]
+//               [--json out.json] [--csv out.csv] [--label text] [--list]   (plus --device, see cl_runtime.hpp)
+struct BenchOptions {
+    std::vector<size_t> sizes;  // Empty: every benchmark runs its own defaults
+    int warmup = 2;
+    int reps = 10;
+    std::string filter;         // Only benchmarks whose name contains this
+    std::string jsonPath, csvPath;
+    std::string label;
+    bool list = false;
+};
+
+// "4096", "64K", "16M" (binary multiples)
+inline size_t parseSize(const std::string& s) {
+    size_t v = std::stoull(s);
+    char suffix = s.empty() ? 0 : (char)std::toupper((unsigned char)s.back());
+    if (suffix == 'K') v <<= 10;
+    else if (suffix == 'M') v <<= 20;
+    else if (suffix == 'G') v <<= 30;
+    return v;
+}
+
+inline BenchOptions parseBenchOptions(int argc, char** argv) {
+    BenchOptions opt;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--list") opt.list = true;
+        else if (arg == "--reps" && hasValue) opt.reps = std::max(1, std::stoi(argv[++i]));
+        else if (arg == "--warmup" && hasValue) opt.warmup = std::max(0, std::stoi(argv[++i]));
+        else if (arg == "--filter" && hasValue) opt.filter = argv[++i];
+        else if (arg == "--json" && hasValue) opt.jsonPath = argv[++i];
+        else if (arg == "--csv" && hasValue) opt.csvPath = argv[++i];
+        else if (arg == "--label" && hasValue) opt.label = argv[++i];
+        else if (arg == "--sizes" && hasValue) {
+            std::stringstream ss(argv[++i]);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                if (!item.empty()) opt.sizes.push_back(parseSize(item));
+            }
+        }
+    }
+    return opt;
+}
+
+struct BenchStats {
+    int reps = 0;
+    double minMs = 0.0, medianMs = 0.0, p95Ms = 0.0, meanMs = 0.0;
+};
+
+// Nearest-rank percentiles over the timed repetitions
+inline BenchStats summarize(std::vector<double> ms) {
+    BenchStats s;
+    if (ms.empty()) return s;
+    std::sort(ms.begin(), ms.end());
+    s.reps = (int)ms.size();
+    s.minMs = ms.front();
+    s.medianMs = ms[ms.size() / 2];
+    s.p95Ms = ms[(size_t)std::ceil(0.95 * ms.size()) - 1];
+    double sum = 0.0;
+    for (double t : ms) sum += t;
+    s.meanMs = sum / ms.size();
+    return s;
+}
+
+// 'launch' enqueues one repetition and returns its events; a repetition's time is the sum of their
+// profiled durations (the queue needs CL_QUEUE_PROFILING_ENABLE). The first 'warmup' are discarded.
+// 'name' labels the events on the OCL_TRACE timeline.
+inline BenchStats timeEvents(const BenchOptions& opt, const std::function<std::vector<cl::Event>()>& launch,
+                             const std::string& name = "bench") {
+    std::vector<double> times;
+    for (int r = 0; r < opt.warmup + opt.reps; r++) {
+        std::vector<cl::Event> events = launch();
+        double ms = 0.0;
+        for (auto& e : events) {
+            traceCommand(e, name);
+            e.wait();
+            ms += (e.getProfilingInfo<CL_PROFILING_COMMAND_END>() - e.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+        }
+        if (r >= opt.warmup) times.push_back(ms);
+    }
+    return summarize(times);
+}
+
+// Host-side work (the CPU backends): wall-clock time of each call to 'run'
+inline BenchStats timeHost(const BenchOptions& opt, const std::function<void()>& run) {
+    std::vector<double> times;
+    for (int r = 0; r < opt.warmup + opt.reps; r++) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (r >= opt.warmup) times.push_back(ms);
+    }
+    return summarize(times);
+}
+
+struct BenchResult {
+    std::string benchmark;
+    size_t size = 0;
+    BenchStats stats;
+    double flops = 0.0;           // Work per repetition; 0 when not meaningful
+    double bytes = 0.0;           // Minimum memory traffic per repetition
+    std::string result = "PASS";  // PASS / FAIL, or "-" when there is nothing to verify
+    double rooflineGFLOPs = 0.0;  // Attainable GFLOP/s at this intensity; 0 when the peaks are unknown
+
+    double gflops() const { return stats.medianMs > 0 ? flops / (stats.medianMs * 1.0e6) : 0.0; }
+    double gbs() const { return stats.medianMs > 0 ? bytes / (stats.medianMs * 1.0e6) : 0.0; }
+    double intensity() const { return bytes > 0 ? flops / bytes : 0.0; }
+    double percentOfRoofline() const { return rooflineGFLOPs > 0 ? 100.0 * gflops() / rooflineGFLOPs : 0.0; }
+};
+
+struct DeviceInfo {
+    std::string name, vendor, version, driver, key;
+    cl_uint computeUnits = 0, clockMHz = 0;
+    cl_ulong globalMemMB = 0, localMemKB = 0;
+};
+
+inline DeviceInfo describeDevice(const cl::Device& device) {
+    DeviceInfo d;
+    d.name = device.getInfo<CL_DEVICE_NAME>();
+    d.vendor = device.getInfo<CL_DEVICE_VENDOR>();
+    d.version = device.getInfo<CL_DEVICE_VERSION>();
+    d.driver = device.getInfo<CL_DRIVER_VERSION>();
+    d.key = deviceKey(device);
+    d.computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+    d.clockMHz = device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+    d.globalMemMB = device.getInfo<CL_DEVICE_GLOBAL_MEM_SIZE>() / (1024 * 1024);
+    d.localMemKB = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>() / 1024;
+    return d;
+}
+
+// A benchmark runs once per size and returns its timed result (use timeEvents for the stats).
+// Sizes mean different things per benchmark (N for matmul, element counts for memory), so a
+// --sizes list is passed through 'validate', which returns why a size can't run ("" if it can).
+struct Benchmark {
+    std::string name;
+    std::vector<size_t> defaultSizes;
+    std::function<BenchResult(size_t size, const BenchOptions& opt)> run;
+    std::function<std::string(size_t size)> validate;
+};
+
+class BenchRegistry {
+public:
+    void add(const std::string& name, std::vector<size_t> defaultSizes,
+             std::function<BenchResult(size_t, const BenchOptions&)> run,
+             std::function<std::string(size_t)> validate = nullptr) {
+        benchmarks_.push_back({name, std::move(defaultSizes), std::move(run), std::move(validate)});
+    }
+
+    const std::vector<Benchmark>& benchmarks() const { return benchmarks_; }
+
+    // Measured ceilings (stream_probes) used to place each result under the device roofline
+    void setPeaks(const DevicePeaks& peaks) { peaks_ = peaks; }
+
+    // Runs every benchmark matching the filter over its sizes, printing one table row per result
+    std::vector<BenchResult> run(const BenchOptions& opt) const {
+        std::cout << std::left << std::setw(22) << "Benchmark"
+                  << std::setw(11) << "Size"
+                  << std::setw(11) << "Min(ms)"
+                  << std::setw(12) << "Median(ms)"
+                  << std::setw(11) << "p95(ms)"
+                  << std::setw(11) << "GFLOP/s"
+                  << std::setw(10) << "GB/s"
+                  << std::setw(8) << "%Roof"
+                  << "Result" << std::endl;
+        std::cout << std::string(103, '-') << std::endl;
+
+        std::vector<BenchResult> results;
+        for (const Benchmark& b : benchmarks_) {
+            if (!opt.filter.empty() && b.name.find(opt.filter) == std::string::npos) continue;
+            for (size_t size : opt.sizes.empty() ? b.defaultSizes : opt.sizes) {
+                std::string invalid = b.validate ? b.validate(size) : "";
+                if (!invalid.empty()) {
+                    std::cout << std::left << std::setw(22) << b.name
+                              << std::setw(11) << size
+                              << "skipped: " << invalid << std::endl;
+                    continue;
+                }
+                BenchResult r;
+                {
+                    TraceSpan span(b.name + " " + std::to_string(size), "bench");
+                    r = b.run(size, opt);
+                }
+                r.benchmark = b.name;
+                r.size = size;
+                if (r.flops > 0 && r.bytes > 0) r.rooflineGFLOPs = peaks_.roofline(r.intensity());
+                std::cout << std::left << std::setw(22) << r.benchmark
+                          << std::setw(11) << r.size
+                          << std::setw(11) << std::fixed << std::setprecision(3) << r.stats.minMs
+                          << std::setw(12) << r.stats.medianMs
+                          << std::setw(11) << r.stats.p95Ms
+                          << std::setw(11) << std::setprecision(1) << r.gflops()
+                          << std::setw(10) << r.gbs()
+                          << std::setw(8) << (r.rooflineGFLOPs > 0 ? std::to_string((int)std::lround(r.percentOfRoofline())) : "-")
+                          << r.result << std::endl;
+                results.push_back(r);
+            }
+        }
+        std::cout << std::string(103, '-') << std::endl;
+        return results;
+    }
+
+private:
+    std::vector<Benchmark> benchmarks_;
+    DevicePeaks peaks_;
+};
+
+inline std::string benchTimestamp() {
+    std::time_t now = std::time(nullptr);
+    char buf[32];
+    std::strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+    return buf;
+}
+
+inline std::string jsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) continue;
+        out += c;
+    }
+    return out;
+}
+
+// Appends one row per result; the header is written when the file is new, so one CSV can
+// accumulate runs from many commits / devices and be diffed by 'label'. 'device' is deviceKey().
+inline bool writeBenchCSV(const std::string& path, const std::string& label, const DeviceInfo& dev,
+                          const std::vector<BenchResult>& results) {
+    bool exists = std::ifstream(path).good();
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        std::cerr << "Warning: could not write benchmark CSV " << path << std::endl;
+        return false;
+    }
+    if (!exists) out << "timestamp,label,device,benchmark,size,reps,min_ms,median_ms,p95_ms,mean_ms,gflops,gbs,intensity,roofline_gflops,result\n";
+    std::string ts = benchTimestamp();
+    for (const auto& r : results) {
+        out << ts << ',' << label << ',' << dev.key << ',' << r.benchmark << ',' << r.size << ','
+            << r.stats.reps << ',' << r.stats.minMs << ',' << r.stats.medianMs << ',' << r.stats.p95Ms << ','
+            << r.stats.meanMs << ',' << r.gflops() << ',' << r.gbs() << ',' << r.intensity() << ','
+            << r.rooflineGFLOPs << ',' << r.result << '\n';
+    }
+    return true;
+}
+
+inline bool writeBenchJSON(const std::string& path, const std::string& label, const DeviceInfo& dev,
+                           const BenchOptions& opt, const std::vector<BenchResult>& results) {
+    std::ofstream out(path);
+    if (!out) {
+        std::cerr << "Warning: could not write benchmark JSON " << path << std::endl;
+        return false;
+    }
+    out << "{\n"
+        << "  \"timestamp\": \"" << benchTimestamp() << "\",\n"
+        << "  \"label\": \"" << jsonEscape(label) << "\",\n"
+        << "  \"warmup\": " << opt.warmup << ",\n"
+        << "  \"reps\": " << opt.reps << ",\n"
+        << "  \"device\": {\n"
+        << "    \"name\": \"" << jsonEscape(dev.name) << "\",\n"
+        << "    \"vendor\": \"" << jsonEscape(dev.vendor) << "\",\n"
+        << "    \"version\": \"" << jsonEscape(dev.version) << "\",\n"
+        << "    \"driver\": \"" << jsonEscape(dev.driver) << "\",\n"
+        << "    \"compute_units\": " << dev.computeUnits << ",\n"
+        << "    \"max_clock_mhz\": " << dev.clockMHz << ",\n"
+        << "    \"global_mem_mb\": " << dev.globalMemMB << ",\n"
+        << "    \"local_mem_kb\": " << dev.localMemKB << "\n"
+        << "  },\n"
+        << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const auto& r = results[i];
+        out << (i ? "," : "") << "\n    {\"benchmark\": \"" << jsonEscape(r.benchmark) << "\", \"size\": " << r.size
+            << ", \"min_ms\": " << r.stats.minMs << ", \"median_ms\": " << r.stats.medianMs
+            << ", \"p95_ms\": " << r.stats.p95Ms << ", \"mean_ms\": " << r.stats.meanMs
+            << ", \"gflops\": " << r.gflops() << ", \"gbs\": " << r.gbs()
+            << ", \"intensity\": " << r.intensity() << ", \"roofline_gflops\": " << r.rooflineGFLOPs
+            << ", \"result\": \"" << r.result << "\"}";
+    }
+    out << "\n  ]\n}\n";
+    return true;
+}
+
+#endif
@@ -0,0 +1,276 @@
+// Shared OpenCL runtime helpers: device selection and a disk cache for compiled program binaries.
+#ifndef CL_RUNTIME_HPP
+#define CL_RUNTIME_HPP
+
+#ifndef CL_HPP_TARGET_OPENCL_VERSION
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#endif
+#include <CL/opencl.hpp>
+
+#include "utils/trace.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define CL_RUNTIME_GETPID _getpid
+#else
+#include <unistd.h>
+#define CL_RUNTIME_GETPID getpid
+#endif
+
+// Which device to run on.
+// Parsed from "--device <spec>" or the OCL_DEVICE environment variable, where <spec> is
+//   gpu | cpu | accel | all            -> first device of that type
+//   <type>:<index> / <type>:<name>     -> n-th device of that type, or first whose name contains <name>
+//   <index> / <name>                   -> same, searched over every device on every platform
+// With no spec we prefer a GPU and fall back to whatever is present (e.g. a POCL CPU device).
+struct DeviceSelection {
+    cl_device_type type = CL_DEVICE_TYPE_GPU;
+    std::string name;      // Case-insensitive substring of CL_DEVICE_NAME
+    int index = -1;        // Index into the devices that match 'type'
+    bool fallback = true;  // Allow any device type if nothing of 'type' exists
+};
+
+inline std::string toLower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return s;
+}
+
+inline DeviceSelection parseDeviceSpec(const std::string& spec) {
+    DeviceSelection sel;
+    if (spec.empty()) return sel;
+
+    sel.fallback = false;
+    std::string head = spec, rest;
+    size_t colon = spec.find(':');
+    if (colon != std::string::npos) {
+        head = spec.substr(0, colon);
+        rest = spec.substr(colon + 1);
+    }
+
+    std::string h = toLower(head);
+    if (h == "gpu") sel.type = CL_DEVICE_TYPE_GPU;
+    else if (h == "cpu") sel.type = CL_DEVICE_TYPE_CPU;
+    else if (h == "accel") sel.type = CL_DEVICE_TYPE_ACCELERATOR;
+    else if (h == "all" || h == "any") sel.type = CL_DEVICE_TYPE_ALL;
+    else {
+        // No type keyword: the whole spec is an index or a name
+        sel.type = CL_DEVICE_TYPE_ALL;
+        rest = spec;
+    }
+
+    if (!rest.empty()) {
+        bool numeric = std::all_of(rest.begin(), rest.end(), [](unsigned char c) { return std::isdigit(c); });
+        if (numeric) sel.index = std::stoi(rest);
+        else sel.name = toLower(rest);
+    }
+    return sel;
+}
+
+// Reads "--device <spec>" / "--device=<spec>" from argv, falling back to $OCL_DEVICE.
+inline DeviceSelection parseDeviceSelection(int argc, char** argv) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--device" && i + 1 < argc) return parseDeviceSpec(argv[i + 1]);
+        if (arg.rfind("--device=", 0) == 0) return parseDeviceSpec(arg.substr(9));
+    }
+    const char* env = std::getenv("OCL_DEVICE");
+    return parseDeviceSpec(env ? env : "");
+}
+
+// Every device of the given type across all platforms, in platform order.
+inline std::vector<cl::Device> listDevices(cl_device_type type = CL_DEVICE_TYPE_ALL) {
+    std::vector<cl::Device> all;
+    std::vector<cl::Platform> platforms;
+    cl::Platform::get(&platforms);
+    for (auto& p : platforms) {
+        std::vector<cl::Device> devices;
+        p.getDevices(type, &devices);  // Returns CL_DEVICE_NOT_FOUND for empty platforms; that's fine
+        all.insert(all.end(), devices.begin(), devices.end());
+    }
+    return all;
+}
+
+inline cl::Device selectDevice(const DeviceSelection& sel) {
+    std::vector<cl::Device> devices = listDevices(sel.type);
+    if (devices.empty() && sel.fallback) devices = listDevices(CL_DEVICE_TYPE_ALL);
+
+    if (devices.empty()) {
+        std::cerr << "Error: No matching OpenCL device found!" << std::endl;
+        exit(1);
+    }
+
+    if (!sel.name.empty()) {
+        for (auto& d : devices) {
+            if (toLower(d.getInfo<CL_DEVICE_NAME>()).find(sel.name) != std::string::npos) return d;
+        }
+        std::cerr << "Error: No OpenCL device name contains '" << sel.name << "'. Available:" << std::endl;
+        for (auto& d : devices) std::cerr << "  " << d.getInfo<CL_DEVICE_NAME>() << std::endl;
+        exit(1);
+    }
+
+    if (sel.index >= 0) {
+        if (sel.index >= (int)devices.size()) {
+            std::cerr << "Error: Device index " << sel.index << " out of range (" << devices.size() << " devices)" << std::endl;
+            exit(1);
+        }
+        return devices[sel.index];
+    }
+
+    return devices[0];
+}
+
+inline cl::Device selectDevice(int argc, char** argv) {
+    return selectDevice(parseDeviceSelection(argc, argv));
+}
+
+// Where a GEMM driver runs: an OpenCL device, or cpuGemm on the host (utils/cpu_gemm.hpp).
+// Parsed from "--backend opencl|host" or $OCL_BACKEND ("cpu" is accepted for host). With neither,
+// the host backend is the fallback when no OpenCL device exists at all, so GEMM drivers still
+// run (and check their results) on GPU-less machines instead of exiting in selectDevice.
+enum class GemmBackend { OpenCL, Host };
+
+inline GemmBackend selectGemmBackend(int argc, char** argv) {
+    std::string spec;
+    if (const char* env = std::getenv("OCL_BACKEND")) spec = env;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--backend" && i + 1 < argc) spec = argv[i + 1];
+        else if (arg.rfind("--backend=", 0) == 0) spec = arg.substr(10);
+    }
+    spec = toLower(spec);
+    if (spec == "host" || spec == "cpu") return GemmBackend::Host;
+    if (spec == "opencl") return GemmBackend::OpenCL;
+    if (!spec.empty()) std::cerr << "Warning: unknown backend '" << spec << "' (expected opencl or host)" << std::endl;
+
+    if (listDevices().empty()) {
+        std::cerr << "Note: no OpenCL device found, falling back to the host GEMM backend" << std::endl;
+        return GemmBackend::Host;
+    }
+    return GemmBackend::OpenCL;
+}
+
+// Identifies a device + driver pair in per-device result files (CSV-safe).
+inline std::string deviceKey(const cl::Device& device) {
+    std::string key = device.getInfo<CL_DEVICE_NAME>() + " | " + device.getInfo<CL_DRIVER_VERSION>();
+    for (char& c : key) {
+        if (c == ',' || c == '\n' || c == '\r') c = ' ';
+    }
+    return key;
+}
+
+// --- Program Binary Cache ---
+// Compiled binaries are stored under $OCL_CACHE_DIR (default ".cl_cache"), one file per
+// (device, driver version, source hash, build options). Set OCL_CACHE_DIR="" to disable.
+
+inline uint64_t fnv1a64(const std::string& data, uint64_t h = 1469598103934665603ULL) {
+    for (unsigned char c : data) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+inline std::string programCacheDir() {
+    const char* env = std::getenv("OCL_CACHE_DIR");
+    return env ? std::string(env) : std::string(".cl_cache");
+}
+
+inline std::string programCacheKey(const cl::Device& device, const std::vector<std::string>& sources, const std::string& options) {
+    cl::Platform platform(device.getInfo<CL_DEVICE_PLATFORM>());
+
+    // Field separators keep ("ab","c") and ("a","bc") from colliding
+    uint64_t h = fnv1a64(device.getInfo<CL_DEVICE_NAME>() + '\x1f');
+    h = fnv1a64(device.getInfo<CL_DEVICE_VENDOR>() + '\x1f', h);
+    h = fnv1a64(device.getInfo<CL_DEVICE_VERSION>() + '\x1f', h);
+    h = fnv1a64(device.getInfo<CL_DRIVER_VERSION>() + '\x1f', h);
+    h = fnv1a64(platform.getInfo<CL_PLATFORM_VERSION>() + '\x1f', h);
+    h = fnv1a64(options + '\x1f', h);
+    for (auto& s : sources) h = fnv1a64(s + '\x1f', h);
+
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", (unsigned long long)h);
+    return hex;
+}
+
+// Builds 'sources' for 'device', loading a cached binary when one exists and storing one when it doesn't.
+// On failure the build log is printed; the program exits unless 'err' is given, in which case the status is returned there.
+inline cl::Program buildProgram(const cl::Context& context, const cl::Device& device,
+                                const std::vector<std::string>& sources,
+                                const std::string& options = "-cl-std=CL2.0", cl_int* err = nullptr) {
+    TraceSpan span("buildProgram", "build");
+    namespace fs = std::filesystem;
+    std::string dir = programCacheDir();
+    fs::path path;
+
+    if (!dir.empty()) {
+        path = fs::path(dir) / (programCacheKey(device, sources, options) + ".bin");
+        std::ifstream file(path, std::ios::binary);
+        if (file.is_open()) {
+            std::vector<unsigned char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            cl::Program::Binaries binaries{binary};
+            std::vector<cl_int> binaryStatus;
+            cl_int status = CL_SUCCESS;
+            cl::Program program(context, {device}, binaries, &binaryStatus, &status);
+            if (status == CL_SUCCESS && program.build({device}, options.c_str()) == CL_SUCCESS) {
+                if (err) *err = CL_SUCCESS;
+                return program;
+            }
+            // Stale or corrupt entry (e.g. driver updated in place): fall through and rebuild
+        }
+    }
+
+    cl::Program::Sources clSources;
+    for (auto& s : sources) clSources.push_back({s.c_str(), s.length()});
+    cl::Program program(context, clSources);
+    cl_int status = program.build({device}, options.c_str());
+
+    if (status != CL_SUCCESS) {
+        std::cerr << "Error building: " << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(device) << std::endl;
+        if (!err) exit(1);
+        *err = status;
+        return program;
+    }
+
+    if (!dir.empty()) {
+        std::vector<std::vector<unsigned char>> binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        if (!binaries.empty() && !binaries[0].empty() && !ec) {
+            // Write then rename so a concurrent reader never sees a partial file. The temp name is
+            // unique per process and thread: several programs (or the per-device threads of
+            // multi_device_gemm) can build the same key at once, and must not interleave writes.
+            fs::path tmp = path;
+            tmp += "." + std::to_string(CL_RUNTIME_GETPID()) + "." +
+                   std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()) % 100000) + ".tmp";
+            std::ofstream out(tmp, std::ios::binary);
+            out.write((const char*)binaries[0].data(), binaries[0].size());
+            out.close();
+            if (out) fs::rename(tmp, path, ec);
+            else fs::remove(tmp, ec);
+        }
+    }
+
+    if (err) *err = CL_SUCCESS;
+    return program;
+}
+
+inline cl::Program buildProgram(const cl::Context& context, const cl::Device& device, const std::string& source,
+                                const std::string& options = "-cl-std=CL2.0", cl_int* err = nullptr) {
+    return buildProgram(context, device, std::vector<std::string>{source}, options, err);
+}
+
+#endif
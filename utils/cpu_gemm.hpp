@@ -0,0 +1,368 @@
+// Native CPU GEMM: C[M][N] = A[M][K] * B[K][N] (or B given as [N][K] with transB, like gemm_nt),
+// row-major, same argument order as the OpenCL matmul kernels. It is the host reference for the
+// GPU kernels and the execution backend when there is no usable OpenCL device.
+//
+// The structure is the GPU tiling moved one level up the memory hierarchy (the BLIS/GotoBLAS
+// layout): a KC x NC panel of B is packed once per (jc, pc) step and stays in L2/L3, each thread
+// packs an MC x KC block of A that stays in L2, and a micro-kernel keeps an MR x NR tile of C in
+// vector registers while it streams both packed panels - the same job WPTM x WPTN does in gemm.cl.
+// Micro-kernels: AVX-512 (6 x 32), AVX2 + FMA (6 x 16), and a plain loop the compiler
+// auto-vectorizes for whatever the target baseline is. The widest one the CPU supports is picked
+// at runtime; OCL_CPU_ISA=generic|avx2|avx512 caps the choice.
+#ifndef CPU_GEMM_HPP
+#define CPU_GEMM_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "utils/thread_pool.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#define CPU_GEMM_X86 1
+#include <immintrin.h>
+#endif
+
+// GCC / Clang compile the wide kernels for their ISA regardless of -march; MSVC accepts the
+// intrinsics without flags
+#if defined(__GNUC__)
+#define CPU_GEMM_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CPU_GEMM_TARGET(isa)
+#endif
+
+#if defined(__GNUC__) && !defined(__clang__)
+#define CPU_GEMM_UNROLL _Pragma("GCC unroll 16")
+#elif defined(__clang__)
+#define CPU_GEMM_UNROLL _Pragma("unroll")
+#else
+#define CPU_GEMM_UNROLL
+#endif
+
+enum class CpuIsa { Generic, AVX2, AVX512 };
+
+inline const char* cpuIsaName(CpuIsa isa) {
+    switch (isa) {
+        case CpuIsa::Generic: return "generic";
+        case CpuIsa::AVX2: return "AVX2+FMA";
+        case CpuIsa::AVX512: return "AVX-512";
+    }
+    return "?";
+}
+
+inline CpuIsa detectCpuIsa() {
+    static const CpuIsa isa = [] {
+        CpuIsa best = CpuIsa::Generic;
+#if CPU_GEMM_X86 && defined(__GNUC__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) best = CpuIsa::AVX512;
+        else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) best = CpuIsa::AVX2;
+#elif CPU_GEMM_X86 && defined(__AVX512F__)
+        best = CpuIsa::AVX512;
+#elif CPU_GEMM_X86 && defined(__AVX2__)
+        best = CpuIsa::AVX2;
+#endif
+        const char* env = std::getenv("OCL_CPU_ISA");
+        if (env) {
+            std::string m = env;
+            if (m == "generic") best = CpuIsa::Generic;
+            else if (m == "avx2" && best == CpuIsa::AVX512) best = CpuIsa::AVX2;
+        }
+        return best;
+    }();
+    return isa;
+}
+
+namespace cpu_gemm {
+
+constexpr int KC = 256;  // Depth of one packed panel: an MR x KC strip of A stays in L1
+
+// A[rows][K] block -> strips of MR rows, each stored k-major (MR floats per k), zero-padded
+template <int MR>
+inline void packA(const float* A, int K, int rows, int kc, float* out) {
+    for (int s = 0; s < rows; s += MR) {
+        int mr = std::min(MR, rows - s);
+        for (int k = 0; k < kc; k++) {
+            for (int i = 0; i < mr; i++) out[i] = A[(size_t)(s + i) * K + k];
+            for (int i = mr; i < MR; i++) out[i] = 0.0f;
+            out += MR;
+        }
+    }
+}
+
+// One NR-wide strip of B (cols [j, j + nr) of a kc-deep panel) -> NR floats per k, zero-padded.
+// B points at row pc (or at column pc of each row with transB).
+template <int NR>
+inline void packBStrip(const float* B, int N, int K, bool transB, int j, int nr, int kc, float* out) {
+    for (int k = 0; k < kc; k++) {
+        if (transB) {
+            for (int c = 0; c < nr; c++) out[c] = B[(size_t)(j + c) * K + k];
+        } else {
+            const float* row = B + (size_t)k * N + j;
+            for (int c = 0; c < nr; c++) out[c] = row[c];
+        }
+        for (int c = nr; c < NR; c++) out[c] = 0.0f;
+        out += NR;
+    }
+}
+
+// Adds (or stores) an MR x NR register tile into C, clipped to mr x nr at the matrix edges
+template <int MR, int NR>
+inline void storeTile(const float (&acc)[MR][NR], float* C, int ldc, int mr, int nr, bool accumulate) {
+    for (int i = 0; i < mr; i++) {
+        float* c = C + (size_t)i * ldc;
+        for (int j = 0; j < nr; j++) c[j] = accumulate ? c[j] + acc[i][j] : acc[i][j];
+    }
+}
+
+// --- Micro-kernels: C tile (+)= packed A strip (kc x MR) * packed B strip (kc x NR) ---
+
+// Written so the j loop vectorizes at any -march (SSE2 on a baseline x86-64 build, NEON on ARM):
+// the B row is copied to a local so the compiler can keep it and the accumulators in registers,
+// and the fully unrolled j loop turns into NR / width vector FMAs (~5x over the naive form).
+template <int MR, int NR>
+inline void microGeneric(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr, bool accumulate) {
+    float acc[MR][NR] = {};
+    for (int k = 0; k < kc; k++, pa += MR, pb += NR) {
+        float b[NR];
+        for (int j = 0; j < NR; j++) b[j] = pb[j];
+        for (int i = 0; i < MR; i++) {
+            float a = pa[i];
+            CPU_GEMM_UNROLL
+            for (int j = 0; j < NR; j++) acc[i][j] += a * b[j];
+        }
+    }
+    storeTile<MR, NR>(acc, C, ldc, mr, nr, accumulate);
+}
+
+#if CPU_GEMM_X86
+// 6 x 16: 12 ymm accumulators + 2 for B + 1 broadcast of A, out of 16 registers
+CPU_GEMM_TARGET("avx2,fma")
+inline void microAvx2(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr, bool accumulate) {
+    __m256 c00 = _mm256_setzero_ps(), c01 = _mm256_setzero_ps(), c10 = _mm256_setzero_ps(), c11 = _mm256_setzero_ps();
+    __m256 c20 = _mm256_setzero_ps(), c21 = _mm256_setzero_ps(), c30 = _mm256_setzero_ps(), c31 = _mm256_setzero_ps();
+    __m256 c40 = _mm256_setzero_ps(), c41 = _mm256_setzero_ps(), c50 = _mm256_setzero_ps(), c51 = _mm256_setzero_ps();
+    for (int k = 0; k < kc; k++, pa += 6, pb += 16) {
+        __m256 b0 = _mm256_loadu_ps(pb), b1 = _mm256_loadu_ps(pb + 8);
+        __m256 a = _mm256_broadcast_ss(pa + 0);
+        c00 = _mm256_fmadd_ps(a, b0, c00); c01 = _mm256_fmadd_ps(a, b1, c01);
+        a = _mm256_broadcast_ss(pa + 1);
+        c10 = _mm256_fmadd_ps(a, b0, c10); c11 = _mm256_fmadd_ps(a, b1, c11);
+        a = _mm256_broadcast_ss(pa + 2);
+        c20 = _mm256_fmadd_ps(a, b0, c20); c21 = _mm256_fmadd_ps(a, b1, c21);
+        a = _mm256_broadcast_ss(pa + 3);
+        c30 = _mm256_fmadd_ps(a, b0, c30); c31 = _mm256_fmadd_ps(a, b1, c31);
+        a = _mm256_broadcast_ss(pa + 4);
+        c40 = _mm256_fmadd_ps(a, b0, c40); c41 = _mm256_fmadd_ps(a, b1, c41);
+        a = _mm256_broadcast_ss(pa + 5);
+        c50 = _mm256_fmadd_ps(a, b0, c50); c51 = _mm256_fmadd_ps(a, b1, c51);
+    }
+    __m256 acc[6][2] = {{c00, c01}, {c10, c11}, {c20, c21}, {c30, c31}, {c40, c41}, {c50, c51}};
+    if (mr == 6 && nr == 16) {
+        for (int i = 0; i < 6; i++) {
+            float* c = C + (size_t)i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm256_add_ps(acc[i][0], _mm256_loadu_ps(c));
+                acc[i][1] = _mm256_add_ps(acc[i][1], _mm256_loadu_ps(c + 8));
+            }
+            _mm256_storeu_ps(c, acc[i][0]);
+            _mm256_storeu_ps(c + 8, acc[i][1]);
+        }
+        return;
+    }
+    float tile[6][16];
+    for (int i = 0; i < 6; i++) {
+        _mm256_storeu_ps(tile[i], acc[i][0]);
+        _mm256_storeu_ps(tile[i] + 8, acc[i][1]);
+    }
+    storeTile<6, 16>(tile, C, ldc, mr, nr, accumulate);
+}
+
+// 6 x 32: 12 zmm accumulators, twice the AVX2 tile per FMA issued
+CPU_GEMM_TARGET("avx512f")
+inline void microAvx512(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr, bool accumulate) {
+    __m512 acc[6][2];
+    for (int i = 0; i < 6; i++) acc[i][0] = acc[i][1] = _mm512_setzero_ps();
+    for (int k = 0; k < kc; k++, pa += 6, pb += 32) {
+        __m512 b0 = _mm512_loadu_ps(pb), b1 = _mm512_loadu_ps(pb + 16);
+        for (int i = 0; i < 6; i++) {
+            __m512 a = _mm512_set1_ps(pa[i]);
+            acc[i][0] = _mm512_fmadd_ps(a, b0, acc[i][0]);
+            acc[i][1] = _mm512_fmadd_ps(a, b1, acc[i][1]);
+        }
+    }
+    if (mr == 6 && nr == 32) {
+        for (int i = 0; i < 6; i++) {
+            float* c = C + (size_t)i * ldc;
+            if (accumulate) {
+                acc[i][0] = _mm512_add_ps(acc[i][0], _mm512_loadu_ps(c));
+                acc[i][1] = _mm512_add_ps(acc[i][1], _mm512_loadu_ps(c + 16));
+            }
+            _mm512_storeu_ps(c, acc[i][0]);
+            _mm512_storeu_ps(c + 16, acc[i][1]);
+        }
+        return;
+    }
+    float tile[6][32];
+    for (int i = 0; i < 6; i++) {
+        _mm512_storeu_ps(tile[i], acc[i][0]);
+        _mm512_storeu_ps(tile[i] + 16, acc[i][1]);
+    }
+    storeTile<6, 32>(tile, C, ldc, mr, nr, accumulate);
+}
+#endif
+
+using MicroKernel = void (*)(int kc, const float* pa, const float* pb, float* C, int ldc, int mr, int nr, bool accumulate);
+
+// Blocked driver for one micro-kernel shape. Work items are (MC-row block, NR-strip range) pairs
+// so even M = MC keeps every thread busy; each pc > 0 step accumulates into C.
+template <int MR, int NR>
+inline void gemmBlocked(MicroKernel micro, const float* A, const float* B, float* C, int M, int N, int K, bool transB,
+                        ThreadPool& pool) {
+    constexpr int MC = MR * 16;  // A block: MC x KC floats (96 KB) in L2
+    constexpr int NC = NR * 64;  // B panel: KC x NC floats (1-2 MB) shared by all threads in L3
+    int threads = pool.size();
+
+    std::vector<float> packedB((size_t)KC * NC);
+    std::vector<std::vector<float>> packedA(threads, std::vector<float>((size_t)MC * KC));
+
+    for (int jc = 0; jc < N; jc += NC) {
+        int nc = std::min(NC, N - jc);
+        int strips = (nc + NR - 1) / NR;
+        for (int pc = 0; pc < K; pc += KC) {
+            int kc = std::min(KC, K - pc);
+            const float* Bp = transB ? B + pc : B + (size_t)pc * N;
+
+            pool.run(strips, [&](int s, int) {
+                int j = s * NR;
+                packBStrip<NR>(Bp, N, K, transB, jc + j, std::min(NR, nc - j), kc, packedB.data() + (size_t)s * KC * NR);
+            });
+
+            int rowBlocks = (M + MC - 1) / MC;
+            int colSplits = std::max(1, std::min(strips, (threads + rowBlocks - 1) / rowBlocks));
+            pool.run(rowBlocks * colSplits, [&](int task, int worker) {
+                int ic = (task / colSplits) * MC, split = task % colSplits;
+                int mc = std::min(MC, M - ic);
+                int s0 = strips * split / colSplits, s1 = strips * (split + 1) / colSplits;
+                float* pa = packedA[worker].data();
+                packA<MR>(A + (size_t)ic * K + pc, K, mc, kc, pa);
+
+                for (int s = s0; s < s1; s++) {
+                    int j = s * NR;
+                    const float* pb = packedB.data() + (size_t)s * KC * NR;
+                    for (int i = 0; i < mc; i += MR) {
+                        micro(kc, pa + (size_t)i * kc, pb, C + (size_t)(ic + i) * N + jc + j, N, std::min(MR, mc - i),
+                              std::min(NR, nc - j), pc > 0);
+                    }
+                }
+            });
+        }
+    }
+}
+
+}  // namespace cpu_gemm
+
+// C = A * B on the host. A is [M][K]; B is [K][N], or [N][K] when transB. Threads come from
+// 'pool' (defaultThreadPool() when null), the micro-kernel from detectCpuIsa() unless 'isa' is given.
+inline void cpuGemm(const float* A, const float* B, float* C, int M, int N, int K, bool transB = false,
+                    ThreadPool* pool = nullptr, const CpuIsa* isa = nullptr) {
+    if (M <= 0 || N <= 0) return;
+    if (K <= 0) {
+        for (int i = 0; i < M; i++) std::memset(C + (size_t)i * N, 0, sizeof(float) * N);
+        return;
+    }
+    ThreadPool& p = pool ? *pool : defaultThreadPool();
+    switch (isa ? *isa : detectCpuIsa()) {
+#if CPU_GEMM_X86
+        case CpuIsa::AVX512:
+            cpu_gemm::gemmBlocked<6, 32>(cpu_gemm::microAvx512, A, B, C, M, N, K, transB, p);
+            return;
+        case CpuIsa::AVX2:
+            cpu_gemm::gemmBlocked<6, 16>(cpu_gemm::microAvx2, A, B, C, M, N, K, transB, p);
+            return;
+#endif
+        default:
+            cpu_gemm::gemmBlocked<4, 16>(cpu_gemm::microGeneric<4, 16>, A, B, C, M, N, K, transB, p);
+            return;
+    }
+}
+
+// --- Shared Test Data & Checks for the GEMM Drivers ---
+
+// Inputs are multiples of 1/16 in [-0.5, 0.5], so for K up to 2^16 every partial sum is a multiple
+// of 1/256 below 2^14 and exact in float: any correct GEMM, whatever its summation order, matches
+// the host result bit for bit.
+inline void fillGemmInputs(std::vector<float>& A, std::vector<float>& B) {
+    for (size_t i = 0; i < A.size(); i++) A[i] = (float)((i * 7) % 17) * 0.0625f - 0.5f;
+    for (size_t i = 0; i < B.size(); i++) B[i] = (float)((i * 5) % 13) * 0.0625f - 0.375f;
+}
+
+// Checks 'samples' outputs of C[M][N] = A * B (B as [N][K] with transB) against double-precision
+// dot products, at rows and columns spread by multiplicative hashing. For sizes where a full
+// reference GEMM would dominate the run.
+inline bool spotCheckGemm(const float* A, const float* B, const float* C, int M, int N, int K, bool transB = false,
+                          int samples = 64) {
+    for (int s = 0; s < samples; s++) {
+        size_t row = ((size_t)s * 2654435761u) % M, col = ((size_t)s * 40503u) % N;
+        double acc = 0.0;
+        for (int k = 0; k < K; k++) acc += (double)A[row * K + k] * (transB ? B[col * K + k] : B[(size_t)k * N + col]);
+        if (std::abs(acc - C[row * N + col]) > 1e-3 * (1.0 + std::abs(acc))) return false;
+    }
+    return true;
+}
+
+// Textbook triple loop with a double accumulator: the slow, obviously-correct check on cpuGemm
+inline void cpuGemmScalar(const float* A, const float* B, float* C, int M, int N, int K, bool transB = false) {
+    for (int i = 0; i < M; i++) {
+        for (int j = 0; j < N; j++) {
+            double acc = 0.0;
+            for (int k = 0; k < K; k++) acc += (double)A[(size_t)i * K + k] * (transB ? B[(size_t)j * K + k] : B[(size_t)k * N + j]);
+            C[(size_t)i * N + j] = (float)acc;
+        }
+    }
+}
+
+// Host fallback for a GEMM driver that has no OpenCL device: cpuGemm on N x N x N problems,
+// best of 'reps', each spot-checked. Prints the usual Details / Table blocks; false on a FAIL.
+inline bool runHostGemm(const std::vector<int>& sizes, int reps) {
+    std::cout << "Details\n-----------------------------------------------------------" << std::endl;
+    std::cout << "Backend            : cpuGemm (host, " << cpuIsaName(detectCpuIsa()) << ", "
+              << defaultThreadPool().size() << " threads)" << std::endl;
+    std::cout << "Reps               : " << reps << " (best of)" << std::endl;
+    std::cout << "-----------------------------------------------------------\n" << std::endl;
+
+    std::cout << "Table\n-----------------------------------------------------------" << std::endl;
+    std::cout << std::left << std::setw(8) << "Size"
+              << std::setw(14) << "Time(ms)"
+              << std::setw(12) << "GFLOP/s"
+              << std::setw(10) << "Result" << std::endl;
+    std::cout << std::string(44, '-') << std::endl;
+    bool ok = true;
+    for (int N : sizes) {
+        std::vector<float> A((size_t)N * N), B((size_t)N * N), C((size_t)N * N);
+        fillGemmInputs(A, B);
+        double best = 0.0;
+        for (int r = 0; r < std::max(1, reps); r++) {
+            auto t0 = std::chrono::steady_clock::now();
+            cpuGemm(A.data(), B.data(), C.data(), N, N, N);
+            double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+            if (r == 0 || ms < best) best = ms;
+        }
+        bool pass = spotCheckGemm(A.data(), B.data(), C.data(), N, N, N, false, 256);
+        ok &= pass;
+        std::cout << std::left << std::setw(8) << N
+                  << std::setw(14) << std::fixed << std::setprecision(3) << best
+                  << std::setw(12) << std::setprecision(1) << 2.0 * N * N * N / (best * 1.0e6)
+                  << std::setw(10) << (pass ? "PASS" : "FAIL") << std::endl;
+    }
+    std::cout << std::string(44, '-') << std::endl;
+    return ok;
+}
+
+#endif
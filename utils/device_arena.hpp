@@ -0,0 +1,334 @@
+// Device memory arena: a few large slabs are reserved once and handed out as sub-buffers
+// (clCreateSubBuffer), so steady-state allocation never reaches the driver's allocator.
+//
+// Each slab is a buddy system. Size class k is a block of (minBlock << k) bytes, every class has
+// a free list of block offsets, a request takes the smallest free block that fits (splitting
+// larger ones), and a released block merges with its free buddy. Block offsets are multiples of
+// the block size, so they always satisfy CL_DEVICE_MEM_BASE_ADDR_ALIGN. Sub-buffer objects are
+// cached per (slab, offset, class, flags) and reused when the same block is handed out again.
+//
+// LifetimePlan covers the other half: tensors whose lifetimes (first and last step that touches
+// them) are known up front share one block, laid out so only tensors that are never live at the
+// same time overlap.
+#ifndef DEVICE_ARENA_HPP
+#define DEVICE_ARENA_HPP
+
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "utils/cl_runtime.hpp"
+
+inline size_t roundUpPow2(size_t x) {
+    size_t p = 1;
+    while (p < x) p <<= 1;
+    return p;
+}
+
+class DeviceArena {
+public:
+    // One allocation. 'buffer' is a sub-buffer of a slab, or a dedicated buffer when the request
+    // is larger than a slab.
+    struct Block {
+        cl::Buffer buffer;
+        size_t bytes = 0;   // As requested
+        size_t offset = 0;  // Within the slab
+        int slab = -1;      // -1: dedicated
+        int order = 0;      // Size class: minBlock << order bytes
+        explicit operator bool() const { return bytes != 0; }
+    };
+
+    struct Stats {
+        size_t reservedBytes = 0;   // Slabs + dedicated buffers: what the driver actually holds
+        size_t inUseBytes = 0;      // Live blocks, rounded to their size class
+        size_t requestedBytes = 0;  // Live blocks, as requested
+        size_t peakInUseBytes = 0;
+        size_t peakRequestedBytes = 0;
+        size_t allocations = 0, releases = 0;
+        size_t slabs = 0, dedicated = 0;
+        size_t subBuffersCreated = 0, subBuffersReused = 0;
+    };
+
+    // slabBytes = 0: min(256 MB, CL_DEVICE_MAX_MEM_ALLOC_SIZE), rounded down to a power of two.
+    DeviceArena(const cl::Context& context, const cl::Device& device, size_t slabBytes = 0,
+                cl_mem_flags flags = CL_MEM_READ_WRITE)
+        : context_(context), flags_(flags) {
+        size_t align = device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8;
+        minBlock_ = roundUpPow2(std::max<size_t>(align, 256));
+        size_t maxAlloc = device.getInfo<CL_DEVICE_MAX_MEM_ALLOC_SIZE>();
+        if (slabBytes == 0) slabBytes = std::min<size_t>(256u << 20, maxAlloc);
+        slabBytes = std::max(slabBytes, minBlock_);
+        slabBytes_ = roundUpPow2(slabBytes);
+        if (slabBytes_ > maxAlloc) slabBytes_ /= 2;
+        maxOrder_ = 0;
+        while ((minBlock_ << maxOrder_) < slabBytes_) maxOrder_++;
+    }
+
+    DeviceArena(const DeviceArena&) = delete;
+    DeviceArena& operator=(const DeviceArena&) = delete;
+
+    const cl::Context& context() const { return context_; }
+    size_t alignment() const { return minBlock_; }
+    size_t slabBytes() const { return slabBytes_; }
+    const Stats& stats() const { return stats_; }
+
+    // 'access' narrows the slab's flags for this block (e.g. CL_MEM_READ_ONLY).
+    Block allocate(size_t bytes, cl_mem_flags access = 0) {
+        Block b;
+        b.bytes = std::max<size_t>(bytes, 1);
+        if (b.bytes > slabBytes_) {
+            cl_int err = CL_SUCCESS;
+            b.buffer = cl::Buffer(context_, access ? access : flags_, b.bytes, nullptr, &err);
+            check(err, b.bytes);
+            stats_.dedicated++;
+            stats_.reservedBytes += b.bytes;
+            track(b, b.bytes, +1);
+            return b;
+        }
+
+        b.order = orderFor(b.bytes);
+        // Best fit: the slab whose smallest sufficient free block is the smallest
+        int bestSlab = -1, bestOrder = maxOrder_ + 1;
+        for (size_t s = 0; s < slabs_.size(); s++) {
+            for (int o = b.order; o < bestOrder; o++) {
+                if (!slabs_[s].free[o].empty()) {
+                    bestSlab = (int)s;
+                    bestOrder = o;
+                    break;
+                }
+            }
+        }
+        if (bestSlab < 0) {
+            bestSlab = addSlab();
+            bestOrder = maxOrder_;
+        }
+
+        // Split down to the requested class; the upper halves go back on the free lists
+        Slab& slab = slabs_[bestSlab];
+        size_t offset = *slab.free[bestOrder].begin();
+        slab.free[bestOrder].erase(slab.free[bestOrder].begin());
+        for (int o = bestOrder; o > b.order; o--) slab.free[o - 1].insert(offset + blockBytes(o - 1));
+
+        b.slab = bestSlab;
+        b.offset = offset;
+        b.buffer = subBuffer(bestSlab, offset, blockBytes(b.order), access);
+        track(b, blockBytes(b.order), +1);
+        return b;
+    }
+
+    void release(Block& b) {
+        if (!b) return;
+        if (b.slab < 0) {
+            stats_.reservedBytes -= b.bytes;
+            stats_.dedicated--;
+            track(b, b.bytes, -1);
+            b = Block();
+            return;
+        }
+        track(b, blockBytes(b.order), -1);
+
+        // Merge with the buddy while it is free
+        Slab& slab = slabs_[b.slab];
+        size_t offset = b.offset;
+        int order = b.order;
+        while (order < maxOrder_) {
+            size_t buddy = offset ^ blockBytes(order);
+            auto it = slab.free[order].find(buddy);
+            if (it == slab.free[order].end()) break;
+            slab.free[order].erase(it);
+            offset = std::min(offset, buddy);
+            order++;
+        }
+        slab.free[order].insert(offset);
+        b = Block();
+    }
+
+    // A view of [offset, offset + bytes) inside 'b' (sub-buffers of sub-buffers are not allowed,
+    // so this is carved from the parent slab directly).
+    cl::Buffer view(const Block& b, size_t offset, size_t bytes, cl_mem_flags access = 0) {
+        cl::Buffer parent = b.slab < 0 ? b.buffer : slabs_[b.slab].buffer;
+        cl_buffer_region region = {(b.slab < 0 ? 0 : b.offset) + offset, bytes};
+        cl_int err = CL_SUCCESS;
+        cl::Buffer sub = parent.createSubBuffer(access ? access : flags_, CL_BUFFER_CREATE_TYPE_REGION, &region, &err);
+        check(err, bytes);
+        stats_.subBuffersCreated++;
+        return sub;
+    }
+
+    // External fragmentation: the share of free bytes that sit in blocks smaller than the largest
+    // free size class. 0 when every free byte can serve the biggest request that still fits.
+    double fragmentation() const {
+        std::vector<size_t> freeBytes(maxOrder_ + 1, 0);
+        size_t total = 0;
+        for (auto& slab : slabs_) {
+            for (int o = 0; o <= maxOrder_; o++) freeBytes[o] += slab.free[o].size() * blockBytes(o);
+        }
+        for (size_t b : freeBytes) total += b;
+        for (int o = maxOrder_; o >= 0; o--) {
+            if (freeBytes[o]) return 1.0 - (double)freeBytes[o] / total;
+        }
+        return 0.0;
+    }
+
+    void printStats(std::ostream& os = std::cout) const {
+        auto mb = [](size_t b) { return b / (1024.0 * 1024.0); };
+        os << std::fixed << std::setprecision(2);
+        os << "Arena Reserved     : " << mb(stats_.reservedBytes) << " MB (" << stats_.slabs << " x "
+           << mb(slabBytes_) << " MB slabs, " << stats_.dedicated << " dedicated)" << std::endl;
+        os << "Arena Peak In Use  : " << mb(stats_.peakInUseBytes) << " MB (requested " << mb(stats_.peakRequestedBytes)
+           << " MB)" << std::endl;
+        os << "Arena Allocations  : " << stats_.allocations << " (sub-buffers created " << stats_.subBuffersCreated
+           << ", reused " << stats_.subBuffersReused << ")" << std::endl;
+        os << "Arena Fragmentation: " << std::setprecision(1) << 100.0 * fragmentation() << " %" << std::endl;
+    }
+
+private:
+    struct Slab {
+        cl::Buffer buffer;
+        std::vector<std::set<size_t>> free;  // Per size class, block offsets
+    };
+
+    size_t blockBytes(int order) const { return minBlock_ << order; }
+
+    int orderFor(size_t bytes) const {
+        int o = 0;
+        while (blockBytes(o) < bytes) o++;
+        return o;
+    }
+
+    int addSlab() {
+        cl_int err = CL_SUCCESS;
+        Slab s;
+        s.buffer = cl::Buffer(context_, flags_, slabBytes_, nullptr, &err);
+        check(err, slabBytes_);
+        s.free.resize(maxOrder_ + 1);
+        s.free[maxOrder_].insert(0);
+        slabs_.push_back(std::move(s));
+        stats_.slabs++;
+        stats_.reservedBytes += slabBytes_;
+        return (int)slabs_.size() - 1;
+    }
+
+    cl::Buffer subBuffer(int slab, size_t offset, size_t bytes, cl_mem_flags access) {
+        auto key = std::make_tuple(slab, offset, bytes, access);
+        auto it = subBuffers_.find(key);
+        if (it != subBuffers_.end()) {
+            stats_.subBuffersReused++;
+            return it->second;
+        }
+        Block whole;
+        whole.slab = slab;
+        return subBuffers_[key] = view(whole, offset, bytes, access);
+    }
+
+    void track(const Block& b, size_t classBytes, int sign) {
+        if (sign > 0) {
+            stats_.allocations++;
+            stats_.inUseBytes += classBytes;
+            stats_.requestedBytes += b.bytes;
+            stats_.peakInUseBytes = std::max(stats_.peakInUseBytes, stats_.inUseBytes);
+            stats_.peakRequestedBytes = std::max(stats_.peakRequestedBytes, stats_.requestedBytes);
+        } else {
+            stats_.releases++;
+            stats_.inUseBytes -= classBytes;
+            stats_.requestedBytes -= b.bytes;
+        }
+    }
+
+    void check(cl_int err, size_t bytes) const {
+        if (err != CL_SUCCESS) {
+            std::cerr << "Error: device arena could not allocate " << bytes << " bytes (OpenCL error " << err << ")" << std::endl;
+            exit(1);
+        }
+    }
+
+    cl::Context context_;
+    cl_mem_flags flags_;
+    size_t minBlock_ = 256, slabBytes_ = 0;
+    int maxOrder_ = 0;
+    std::vector<Slab> slabs_;
+    std::map<std::tuple<int, size_t, size_t, cl_mem_flags>, cl::Buffer> subBuffers_;
+    Stats stats_;
+};
+
+// Static memory plan for tensors with known lifetimes. Steps are whatever the caller counts
+// (kernel launches, layers); a tensor is live from 'first' to 'last' inclusive. Tensors are
+// placed largest first at the lowest aligned offset that does not overlap any placed tensor
+// whose lifetime intersects theirs.
+class LifetimePlan {
+public:
+    int add(size_t bytes, int first, int last) {
+        tensors_.push_back({bytes, first, last, 0});
+        return (int)tensors_.size() - 1;
+    }
+
+    // Assigns offsets and returns the total bytes the plan needs.
+    size_t finalize(size_t align) {
+        std::vector<int> order(tensors_.size());
+        for (size_t i = 0; i < order.size(); i++) order[i] = (int)i;
+        std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return tensors_[a].bytes > tensors_[b].bytes; });
+
+        std::vector<int> placed;
+        total_ = 0;
+        for (int id : order) {
+            Tensor& t = tensors_[id];
+            // Live neighbours sorted by offset; take the first gap that fits
+            std::vector<const Tensor*> live;
+            for (int p : placed) {
+                const Tensor& o = tensors_[p];
+                if (o.first <= t.last && t.first <= o.last) live.push_back(&o);
+            }
+            std::sort(live.begin(), live.end(), [](const Tensor* a, const Tensor* b) { return a->offset < b->offset; });
+            size_t offset = 0;
+            for (const Tensor* o : live) {
+                if (offset + t.bytes <= o->offset) break;
+                offset = std::max(offset, (o->offset + o->bytes + align - 1) / align * align);
+            }
+            t.offset = offset;
+            total_ = std::max(total_, offset + t.bytes);
+            placed.push_back(id);
+        }
+        return total_;
+    }
+
+    size_t offset(int id) const { return tensors_[id].offset; }
+    size_t bytes(int id) const { return tensors_[id].bytes; }
+    size_t size() const { return tensors_.size(); }
+    size_t totalBytes() const { return total_; }
+
+    // What one buffer per tensor would need
+    size_t unplannedBytes() const {
+        size_t sum = 0;
+        for (auto& t : tensors_) sum += t.bytes;
+        return sum;
+    }
+
+private:
+    struct Tensor {
+        size_t bytes;
+        int first, last;
+        size_t offset;
+    };
+    std::vector<Tensor> tensors_;
+    size_t total_ = 0;
+};
+
+// One arena block holding every tensor of a finalized plan; buffers[id] views tensor 'id'.
+struct PlannedBuffers {
+    DeviceArena::Block block;
+    std::vector<cl::Buffer> buffers;
+};
+
+inline PlannedBuffers allocatePlan(DeviceArena& arena, LifetimePlan& plan) {
+    PlannedBuffers out;
+    out.block = arena.allocate(plan.finalize(arena.alignment()));
+    for (size_t id = 0; id < plan.size(); id++) out.buffers.push_back(arena.view(out.block, plan.offset((int)id), plan.bytes((int)id)));
+    return out;
+}
+
+#endif
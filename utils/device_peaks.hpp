@@ -0,0 +1,96 @@
+// Measured per-device ceilings (global memory bandwidth, FP32 throughput), persisted so that kernel
+// benchmarks can report their achieved throughput as a fraction of what the hardware actually delivers.
+#ifndef DEVICE_PEAKS_HPP
+#define DEVICE_PEAKS_HPP
+
+#include "utils/cl_runtime.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct DevicePeaks {
+    double bandwidthGBs = 0.0;  // Sustained global-memory bandwidth (STREAM-style copy)
+    double gflops = 0.0;        // Peak FP32 throughput (peak_flops in stream_probes.cl); 0 if never measured
+
+    // Roofline: attainable GFLOP/s at 'intensity' FLOPs per byte of global traffic. 0 if either peak is unknown.
+    double roofline(double intensity) const {
+        if (bandwidthGBs <= 0.0 || gflops <= 0.0) return 0.0;
+        return std::min(gflops, intensity * bandwidthGBs);
+    }
+    // Arithmetic intensity where the roofline turns from memory- to compute-bound
+    double ridgePoint() const { return bandwidthGBs > 0.0 ? gflops / bandwidthGBs : 0.0; }
+};
+
+inline std::string devicePeaksPath() {
+    const char* env = std::getenv("OCL_PEAKS_DB");
+    return env ? std::string(env) : std::string("device_peaks.csv");
+}
+
+inline bool loadDevicePeaks(const std::string& device, DevicePeaks& out, const std::string& path = devicePeaksPath()) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    std::string line;
+    std::getline(file, line);  // Header
+    while (std::getline(file, line)) {
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) f.push_back(field);
+        if (f.size() >= 2 && f[0] == device) {
+            out.bandwidthGBs = std::stod(f[1]);
+            if (f.size() >= 3) out.gflops = std::stod(f[2]);  // Absent in files written before stream_probes
+            return true;
+        }
+    }
+    return false;
+}
+
+// Replaces this device's row, keeping every other device's.
+inline bool saveDevicePeaks(const std::string& device, const DevicePeaks& peaks, const std::string& path = devicePeaksPath()) {
+    std::vector<std::string> rows;
+    std::ifstream in(path);
+    std::string line;
+    if (in.is_open()) {
+        std::getline(in, line);
+        while (std::getline(in, line)) {
+            if (line.rfind(device + ",", 0) != 0) rows.push_back(line);
+        }
+        in.close();
+    }
+
+    std::ofstream out(path);
+    if (!out.is_open()) return false;
+    out << "device,bandwidth_gbs,gflops\n";
+    for (auto& r : rows) out << r << "\n";
+    out << device << "," << peaks.bandwidthGBs << "," << peaks.gflops << "\n";
+    return (bool)out;
+}
+
+// Runs benchmark_bandwidth from Hardware/kernels/memory_bench.cl over 'numElements' floats and
+// returns the best of 'reps' runs in GB/s (read + write bytes).
+inline double measureCopyBandwidth(const cl::Context& context, const cl::CommandQueue& queue, cl::Kernel& kernel,
+                                   size_t numElements, int reps = 5) {
+    size_t bytes = numElements * sizeof(float);
+    cl::Buffer in(context, CL_MEM_READ_ONLY, bytes);
+    cl::Buffer out(context, CL_MEM_WRITE_ONLY, bytes);
+    queue.enqueueFillBuffer(in, 1.0f, 0, bytes);
+
+    kernel.setArg(0, in);
+    kernel.setArg(1, out);
+    double bestMs = 1e30;
+    for (int r = 0; r <= reps; r++) {
+        cl::Event ev;
+        queue.enqueueNDRangeKernel(kernel, cl::NullRange, cl::NDRange(numElements / 4), cl::NullRange, nullptr, &ev);
+        ev.wait();
+        cl_ulong start = ev.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+        cl_ulong end = ev.getProfilingInfo<CL_PROFILING_COMMAND_END>();
+        if (r > 0) bestMs = std::min(bestMs, (end - start) * 1.0e-6);  // r == 0 is warmup
+    }
+    return 2.0 * bytes / (bestMs * 1.0e6);
+}
+
+#endif
@@ -0,0 +1,80 @@
+// Host side of Vector_Foundations/kernels/epilogue.cl: which fused epilogue a tiled GEMM is built
+// with, the -D options that select it and the trailing kernel arguments it takes.
+// An inactive Epilogue adds no options and no arguments, so the kernel is the plain GEMM.
+#ifndef EPILOGUE_HPP
+#define EPILOGUE_HPP
+
+#include <string>
+
+#include "utils/utils.hpp"
+#include "utils/cl_runtime.hpp"
+
+enum class Activation { None, ReLU, GELU, SiLU };
+
+inline const char* activationName(Activation a) {
+    switch (a) {
+        case Activation::ReLU: return "relu";
+        case Activation::GELU: return "gelu";
+        case Activation::SiLU: return "silu";
+        default: return "none";
+    }
+}
+
+struct Epilogue {
+    bool scale = false;     // alpha * acc + beta * C_old
+    bool bias = false;      // + bias[col]
+    bool gated = false;     // act(gate[idx]) * v instead of act(v)
+    bool residual = false;  // + residual[idx], applied last
+    Activation act = Activation::None;
+    float alpha = 1.0f, beta = 0.0f;
+
+    bool active() const { return scale || bias || gated || residual || act != Activation::None; }
+
+    // Appended to buildOptions(TuneParams): program binaries are cached per option string
+    std::string buildOptions() const {
+        std::string opts;
+        if (scale) opts += " -DEPI_SCALE";
+        if (bias) opts += " -DEPI_BIAS";
+        if (gated) opts += " -DEPI_GATED";
+        if (residual) opts += " -DEPI_RESIDUAL";
+        if (act != Activation::None) opts += std::string(" -DEPI_ACT=ACT_") + (act == Activation::ReLU ? "RELU" : act == Activation::GELU ? "GELU" : "SILU");
+        return opts;
+    }
+
+    std::string name() const {
+        std::string s;
+        if (scale) s += "scale+";
+        if (bias) s += "bias+";
+        if (gated) s += std::string("gate(") + activationName(act) + ")+";
+        else if (act != Activation::None) s += std::string(activationName(act)) + "+";
+        if (residual) s += "residual+";
+        return s.empty() ? "none" : s.substr(0, s.size() - 1);
+    }
+
+    // The up projection of a SwiGLU MLP: C = silu(gate) * (x * W_up)
+    static Epilogue swiglu() {
+        Epilogue e;
+        e.gated = true;
+        e.act = Activation::SiLU;
+        return e;
+    }
+};
+
+// epilogue.cl followed by the GEMM kernel source. Kernels built from the bare source are unchanged.
+inline std::string withEpilogue(const std::string& kernelSrc) {
+    return readKernelFile("Vector_Foundations/kernels/epilogue.cl") + "\n" + kernelSrc;
+}
+
+// Binds (bias, residual, gate, alpha, beta) starting at argument 'first'. Buffers the epilogue
+// does not read may be default-constructed cl::Buffer objects, which bind as NULL.
+inline void setEpilogueArgs(cl::Kernel& kernel, cl_uint first, const Epilogue& e, const cl::Buffer& bias,
+                            const cl::Buffer& residual, const cl::Buffer& gate) {
+    if (!e.active()) return;
+    kernel.setArg(first + 0, bias);
+    kernel.setArg(first + 1, residual);
+    kernel.setArg(first + 2, gate);
+    kernel.setArg(first + 3, e.alpha);
+    kernel.setArg(first + 4, e.beta);
+}
+
+#endif
@@ -0,0 +1,133 @@
+// Kernel sources compiled into the binary. cmake/EmbedKernels.cmake turns every
+// <module>/kernels/*.cl into a constexpr table (embedded_kernels.hpp in the build tree) with the
+// file's __kernel entry points and its specialization parameters (the -D options it reads,
+// with their in-file defaults). Lookups take the repo-relative path, the file name, or the name
+// of any __kernel in it, so "gemm.cl", "Vector_Foundations/kernels/gemm.cl" and "gemm_nt" all
+// resolve to the same source.
+//
+// Set OCL_KERNEL_DIR to a directory (usually the repo root) to load kernels from disk instead:
+// a file found there under the same relative path, or by file name, wins over the embedded copy,
+// so kernel edits take effect without rebuilding the host program.
+#ifndef KERNEL_REGISTRY_HPP
+#define KERNEL_REGISTRY_HPP
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+struct EmbeddedKernelParam {
+    const char* name;
+    const char* fallback;  // The #define in the file, used when no -D overrides it
+};
+
+struct EmbeddedKernelFile {
+    const char* path;            // Relative to the repo root, '/'-separated
+    const char* source;
+    const char* const* kernels;  // nullptr-terminated
+    int numKernels;
+    const EmbeddedKernelParam* params;  // {nullptr, nullptr}-terminated
+    int numParams;
+};
+
+// Builds configured without CMake (no generated header) fall back to reading files
+#if defined(__has_include)
+#if __has_include("embedded_kernels.hpp")
+#include "embedded_kernels.hpp"
+#define HAVE_EMBEDDED_KERNELS 1
+#endif
+#endif
+#ifndef HAVE_EMBEDDED_KERNELS
+constexpr EmbeddedKernelFile kEmbeddedKernels[] = {{nullptr, nullptr, nullptr, 0, nullptr, 0}};
+constexpr int kNumEmbeddedKernels = 0;
+#endif
+
+// "Vector_Foundations\\kernels\\gemm.cl" -> "Vector_Foundations/kernels/gemm.cl"
+inline std::string normalizeKernelPath(std::string path) {
+    for (char& c : path) {
+        if (c == '\\') c = '/';
+    }
+    while (path.compare(0, 2, "./") == 0) path.erase(0, 2);
+    return path;
+}
+
+inline std::string kernelFileName(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Path, file name, or __kernel name; nullptr when nothing matches
+inline const EmbeddedKernelFile* findEmbeddedKernel(const std::string& name) {
+    std::string key = normalizeKernelPath(name);
+    for (int i = 0; i < kNumEmbeddedKernels; i++) {
+        if (key == kEmbeddedKernels[i].path) return &kEmbeddedKernels[i];
+    }
+    for (int i = 0; i < kNumEmbeddedKernels; i++) {
+        if (key == kernelFileName(kEmbeddedKernels[i].path)) return &kEmbeddedKernels[i];
+    }
+    for (int i = 0; i < kNumEmbeddedKernels; i++) {
+        for (int k = 0; k < kEmbeddedKernels[i].numKernels; k++) {
+            if (key == kEmbeddedKernels[i].kernels[k]) return &kEmbeddedKernels[i];
+        }
+    }
+    return nullptr;
+}
+
+inline bool readFileIfExists(const std::string& path, std::string& out) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) return false;
+    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+// $OCL_KERNEL_DIR/<path>, then $OCL_KERNEL_DIR/<file name>
+inline bool readKernelOverride(const std::string& path, std::string& out) {
+    const char* dir = std::getenv("OCL_KERNEL_DIR");
+    if (!dir || !*dir) return false;
+    std::string root = normalizeKernelPath(dir);
+    if (root.back() != '/') root += '/';
+    return readFileIfExists(root + path, out) || readFileIfExists(root + kernelFileName(path), out);
+}
+
+// Source for a kernel file: the override directory, then the embedded table, then the path as
+// given (relative to the working directory, for builds without the generated table).
+inline bool findKernelSource(const std::string& name, std::string& out) {
+    const EmbeddedKernelFile* entry = findEmbeddedKernel(name);
+    std::string path = entry ? entry->path : normalizeKernelPath(name);
+    if (readKernelOverride(path, out)) return true;
+    if (entry) {
+        out = entry->source;
+        return true;
+    }
+    return readFileIfExists(path, out);
+}
+
+// Specialization parameters a kernel file understands, e.g. gemm.cl -> TSM=64, TSN=64, ...
+inline std::vector<EmbeddedKernelParam> kernelParams(const std::string& name) {
+    std::vector<EmbeddedKernelParam> params;
+    if (const EmbeddedKernelFile* entry = findEmbeddedKernel(name)) params.assign(entry->params, entry->params + entry->numParams);
+    return params;
+}
+
+// Table of every embedded file, its entry points and parameters (cl_info --kernels)
+inline void printKernelRegistry(std::ostream& os = std::cout) {
+    os << "Embedded kernel files: " << kNumEmbeddedKernels
+       << (std::getenv("OCL_KERNEL_DIR") ? std::string(" (override dir: ") + std::getenv("OCL_KERNEL_DIR") + ")" : "")
+       << std::endl;
+    for (int i = 0; i < kNumEmbeddedKernels; i++) {
+        const EmbeddedKernelFile& f = kEmbeddedKernels[i];
+        os << "  " << f.path << " (" << std::strlen(f.source) << " bytes)" << std::endl;
+        os << "    kernels:";
+        for (int k = 0; k < f.numKernels; k++) os << " " << f.kernels[k];
+        os << std::endl;
+        if (f.numParams == 0) continue;
+        os << "    params :";
+        for (int p = 0; p < f.numParams; p++) os << " " << f.params[p].name << "=" << f.params[p].fallback;
+        os << std::endl;
+    }
+}
+
+#endif
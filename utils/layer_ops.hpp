@@ -0,0 +1,53 @@
+// Build configuration for Inference/kernels/layer_ops.cl: work-group size, sub-group reductions
+// and whether a row of D floats can be staged in local memory.
+#ifndef LAYER_OPS_HPP
+#define LAYER_OPS_HPP
+
+#include <string>
+
+#include "utils/cl_runtime.hpp"
+
+struct LayerOpsConfig {
+    int wgSize = 256;
+    bool subgroups = false;     // sub_group_reduce_* available and enabled
+    bool subgroupsKhr = false;  // ...through cl_khr_subgroups (needs the pragma)
+    int rowCache = 0;           // Floats of the row staged in __local memory; 0 = re-read from global
+
+    std::string buildOptions() const {
+        std::string opts = "-cl-std=CL2.0 -DWG_SIZE=" + std::to_string(wgSize) + " -DROW_CACHE=" + std::to_string(rowCache);
+        if (subgroups) opts += " -DUSE_SUBGROUPS";
+        if (subgroupsKhr) opts += " -DSUBGROUPS_KHR";
+        return opts;
+    }
+
+    std::string name() const { return std::string(subgroups ? "subgroup" : "local") + (rowCache ? "+cache" : ""); }
+};
+
+// cl_khr_subgroups, or cl_intel_subgroups (same reduce built-ins, no pragma needed)
+inline bool hasSubgroups(const cl::Device& device, bool* khr = nullptr) {
+    std::string ext = device.getInfo<CL_DEVICE_EXTENSIONS>();
+    bool k = ext.find("cl_khr_subgroups") != std::string::npos;
+    if (khr) *khr = k;
+    return k || ext.find("cl_intel_subgroups") != std::string::npos;
+}
+
+// Largest power-of-two work-group up to 256, sub-groups if requested and supported, and a row
+// cache when D floats plus the reduction scratch fit in half the local memory (leaving room for
+// a second resident work-group per compute unit).
+inline LayerOpsConfig layerOpsConfig(const cl::Device& device, int D, bool useSubgroups = true) {
+    LayerOpsConfig cfg;
+    size_t maxWG = device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    while ((size_t)cfg.wgSize > maxWG) cfg.wgSize /= 2;
+
+    bool khr = false;
+    if (useSubgroups && hasSubgroups(device, &khr)) {
+        cfg.subgroups = true;
+        cfg.subgroupsKhr = khr;
+    }
+
+    cl_ulong localMem = device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    if (sizeof(float) * ((size_t)D + cfg.wgSize) <= localMem / 2) cfg.rowCache = D;
+    return cfg;
+}
+
+#endif
@@ -0,0 +1,326 @@
+// Heterogeneous GEMM: one GEMM (or a batch) split into C tiles and run on every OpenCL device on
+// the machine at once - GPUs, the CPU device, and equal-sized sub-devices of it
+// (clCreateSubDevices), which also lets a CPU-only POCL install exercise the scheduler.
+//
+// Each device gets its own context, a dedicated host thread (std::thread, so device loops never
+// queue behind each other on a shared pool), and a gemm_nt kernel tuned for it (tuning database,
+// key "gemm_nt"). B is passed transposed ([N][K], like model weights) so
+// a tile's operands are contiguous row panels of A and Bt: a device uploads a panel the first time
+// one of its tiles needs it and keeps it for the rest of the run, and tiles are dealt in row-major
+// runs so consecutive tiles share their A panel. Finished tiles are read straight into place in
+// the host C with a non-blocking enqueueReadBufferRect on a second in-order queue, from one of two
+// output buffers: tile i's download overlaps tile i+1's kernel, and a kernel only waits (through
+// its event wait list) for the download that last used its output buffer.
+//
+// Scheduling: every device starts with a contiguous share of the tiles in its own deque, sized by
+// the throughput it measured on the previous run (compute units x clock before that). It takes
+// work from the front of its deque; once that is empty it steals from the back of the fullest
+// other deque, so a faster device ends up doing more tiles and no device idles while work remains.
+#ifndef MULTI_DEVICE_GEMM_HPP
+#define MULTI_DEVICE_GEMM_HPP
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "utils/cl_runtime.hpp"
+#include "utils/trace.hpp"
+#include "utils/tuning.hpp"
+
+// One GEMM of a batch: C[M][N] = A[M][K] * Bt[N][K]^T, all row-major host arrays
+struct GemmJob {
+    const float* A;
+    const float* Bt;
+    float* C;
+    int M, N, K;
+};
+
+struct HeteroDevice {
+    cl::Device device;
+    std::string name;  // Device name, plus "[i/n]" for a sub-device
+};
+
+struct HeteroWorkerStats {
+    std::string name;
+    int tiles = 0;                 // Tiles executed, including stolen ones
+    int stolen = 0;                // Tiles taken from another device's deque
+    double flops = 0.0;
+    double busyMs = 0.0;           // Wall time from the device's first tile to its last download
+    double kernelMs = 0.0;         // Profiled kernel time
+    size_t uploadedBytes = 0;      // Panels copied to the device
+
+    double gflops() const { return busyMs > 0 ? flops / (busyMs * 1.0e6) : 0.0; }
+};
+
+// Every device of every platform. With cpuParts > 1 each CPU device is replaced by sub-devices of
+// CU / cpuParts compute units each (CL_DEVICE_PARTITION_EQUALLY), when the driver can partition it.
+inline std::vector<HeteroDevice> heterogeneousDevices(int cpuParts = 1) {
+    std::vector<HeteroDevice> out;
+    for (cl::Device& d : listDevices(CL_DEVICE_TYPE_ALL)) {
+        std::string name = d.getInfo<CL_DEVICE_NAME>();
+        bool isCpu = d.getInfo<CL_DEVICE_TYPE>() & CL_DEVICE_TYPE_CPU;
+        cl_uint cu = d.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+
+        std::vector<cl::Device> subs;
+        if (isCpu && cpuParts > 1 && cu >= (cl_uint)cpuParts) {
+            std::vector<cl_device_partition_property> supported = d.getInfo<CL_DEVICE_PARTITION_PROPERTIES>();
+            if (std::find(supported.begin(), supported.end(), (cl_device_partition_property)CL_DEVICE_PARTITION_EQUALLY) !=
+                supported.end()) {
+                const cl_device_partition_property props[] = {CL_DEVICE_PARTITION_EQUALLY,
+                                                              (cl_device_partition_property)(cu / cpuParts), 0};
+                if (d.createSubDevices(props, &subs) != CL_SUCCESS) subs.clear();
+            }
+        }
+        if (subs.empty()) {
+            out.push_back({d, name});
+            continue;
+        }
+        for (size_t i = 0; i < subs.size(); i++) {
+            out.push_back({subs[i], name + " [" + std::to_string(i + 1) + "/" + std::to_string(subs.size()) + "]"});
+        }
+    }
+    return out;
+}
+
+class MultiDeviceGemm {
+public:
+    // 'gemmSrc' is gemm.cl; each device builds gemm_nt from it with its own tuned parameters
+    MultiDeviceGemm(const std::vector<HeteroDevice>& devices, const std::string& gemmSrc, const TuningDB& db,
+                    int tileM = 512, int tileN = 512)
+        : src_(gemmSrc), db_(db), tileM_(tileM), tileN_(tileN) {
+        for (const HeteroDevice& d : devices) {
+            auto w = std::make_unique<Worker>();
+            w->dev = d;
+            w->context = cl::Context(d.device);
+            w->queue = cl::CommandQueue(w->context, d.device, CL_QUEUE_PROFILING_ENABLE);
+            w->downloads = cl::CommandQueue(w->context, d.device, CL_QUEUE_PROFILING_ENABLE);
+            w->weight = (double)d.device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>() *
+                        std::max<cl_uint>(1, d.device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>());
+            w->stats.name = d.name;
+            workers_.push_back(std::move(w));
+        }
+    }
+
+    int workers() const { return (int)workers_.size(); }
+
+    // Runs every job to completion across all devices and returns the wall time in ms. With
+    // steal = false each device runs exactly its initial share (the static-partition baseline).
+    double run(const std::vector<GemmJob>& jobs, bool steal = true) {
+        tiles_.clear();
+        for (int j = 0; j < (int)jobs.size(); j++) {
+            for (int r = 0; r < jobs[j].M; r += tileM_) {
+                for (int c = 0; c < jobs[j].N; c += tileN_) {
+                    tiles_.push_back({j, r, c, std::min(tileM_, jobs[j].M - r), std::min(tileN_, jobs[j].N - c)});
+                }
+            }
+        }
+        deal();
+
+        // Build (or load from the binary cache) every kernel up front, outside the timed region
+        for (auto& w : workers_) {
+            for (const GemmJob& job : jobs) kernelFor(*w, job.K);
+        }
+
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (auto& w : workers_) threads.emplace_back([&, worker = w.get()] { drive(*worker, jobs, steal); });
+        for (std::thread& t : threads) t.join();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+
+        // Measured throughput sizes the next run's initial shares (a device that got no tiles
+        // is assumed as slow as the slowest measured one); panels are per-run
+        double slowest = 0.0;
+        for (auto& w : workers_) {
+            double g = w->stats.gflops();
+            if (g > 0 && (slowest == 0.0 || g < slowest)) slowest = g;
+        }
+        for (auto& w : workers_) {
+            if (slowest > 0) w->weight = w->stats.gflops() > 0 ? w->stats.gflops() : slowest;
+            w->aPanels.clear();
+            w->bPanels.clear();
+        }
+        return ms;
+    }
+
+    // Per-device counters of the last run()
+    std::vector<HeteroWorkerStats> stats() const {
+        std::vector<HeteroWorkerStats> s;
+        for (auto& w : workers_) s.push_back(w->stats);
+        return s;
+    }
+
+private:
+    struct Tile {
+        int job, row, col, rows, cols;
+    };
+
+    struct Worker {
+        HeteroDevice dev;
+        cl::Context context;
+        cl::CommandQueue queue;      // Panel uploads and kernels
+        cl::CommandQueue downloads;  // Tile read-backs, overlapping the next kernel
+        std::map<std::string, cl::Kernel> kernels;               // By build options
+        std::map<std::pair<int, int>, cl::Buffer> aPanels, bPanels;  // (job, first row) -> device copy
+        std::array<cl::Buffer, 2> out;                           // Alternating tile outputs
+        std::array<size_t, 2> outBytes = {0, 0};
+        std::array<cl::Event, 2> outFree;                        // Last download from each output
+        int nextOut = 0;
+        std::vector<cl::Event> kernelEvents;                     // Profiled once the run drains
+        double weight = 1.0;
+        std::mutex mutex;       // Guards 'queued'
+        std::deque<int> queued;  // Tile indices; owner pops the front, thieves the back
+        HeteroWorkerStats stats;
+    };
+
+    // Contiguous runs of tiles in proportion to each device's weight
+    void deal() {
+        double total = 0.0;
+        for (auto& w : workers_) total += w->weight;
+        size_t next = 0;
+        double acc = 0.0;
+        for (size_t i = 0; i < workers_.size(); i++) {
+            Worker& w = *workers_[i];
+            acc += w.weight;
+            size_t end = i + 1 == workers_.size() ? tiles_.size() : (size_t)(tiles_.size() * acc / total + 0.5);
+            w.queued.clear();
+            for (; next < end; next++) w.queued.push_back((int)next);
+            std::string name = w.stats.name;
+            w.stats = HeteroWorkerStats();
+            w.stats.name = name;
+        }
+    }
+
+    int take(Worker& self, bool steal) {
+        {
+            std::lock_guard<std::mutex> lock(self.mutex);
+            if (!self.queued.empty()) {
+                int t = self.queued.front();
+                self.queued.pop_front();
+                return t;
+            }
+        }
+        while (steal) {
+            Worker* victim = nullptr;
+            size_t most = 0;
+            for (auto& w : workers_) {
+                if (w.get() == &self) continue;
+                std::lock_guard<std::mutex> lock(w->mutex);
+                if (w->queued.size() > most) {
+                    most = w->queued.size();
+                    victim = w.get();
+                }
+            }
+            if (!victim) return -1;
+            std::lock_guard<std::mutex> lock(victim->mutex);
+            if (victim->queued.empty()) continue;  // Drained since we looked; pick again
+            int t = victim->queued.back();
+            victim->queued.pop_back();
+            self.stats.stolen++;
+            return t;
+        }
+        return -1;
+    }
+
+    void drive(Worker& w, const std::vector<GemmJob>& jobs, bool steal) {
+        auto t0 = std::chrono::steady_clock::now();
+        bool any = false;
+        for (int t; (t = take(w, steal)) >= 0;) {
+            TraceSpan span("tile");
+            runTile(w, jobs[tiles_[t].job], tiles_[t]);
+            any = true;
+        }
+        w.queue.finish();
+        w.downloads.finish();
+        if (any) w.stats.busyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        for (cl::Event& ev : w.kernelEvents) {
+            w.stats.kernelMs += (ev.getProfilingInfo<CL_PROFILING_COMMAND_END>() - ev.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+        }
+        w.kernelEvents.clear();
+        w.outFree = {};
+    }
+
+    cl::Buffer panel(Worker& w, std::map<std::pair<int, int>, cl::Buffer>& cache, int job, int row, int rows,
+                     const float* host, int K) {
+        auto key = std::make_pair(job, row);
+        auto it = cache.find(key);
+        if (it != cache.end()) return it->second;
+        size_t bytes = sizeof(float) * rows * K;
+        cl::Buffer buf(w.context, CL_MEM_READ_ONLY, bytes);
+        TraceEvent te(nullptr);
+        w.queue.enqueueWriteBuffer(buf, CL_FALSE, 0, bytes, host + (size_t)row * K, nullptr, te.get());
+        te.record(w.queue, "panel upload");
+        w.stats.uploadedBytes += bytes;
+        return cache[key] = buf;
+    }
+
+    // gemm_nt tuned for this device at tile size and depth K
+    std::pair<cl::Kernel*, TuneParams> kernelFor(Worker& w, int K) {
+        TuneParams p = matmulParams(db_, w.dev.device, "gemm_nt", tileM_, tileN_, K);
+        std::string options = buildOptions(p);
+        auto it = w.kernels.find(options);
+        if (it == w.kernels.end()) {
+            cl::Program program = buildProgram(w.context, w.dev.device, src_, options);
+            it = w.kernels.emplace(options, cl::Kernel(program, "gemm_nt")).first;
+        }
+        return {&it->second, p};
+    }
+
+    void runTile(Worker& w, const GemmJob& job, const Tile& t) {
+        auto [kp, p] = kernelFor(w, job.K);
+        cl::Kernel& kernel = *kp;
+
+        cl::Buffer a = panel(w, w.aPanels, t.job, t.row, t.rows, job.A, job.K);
+        cl::Buffer b = panel(w, w.bPanels, t.job, t.col, t.cols, job.Bt, job.K);
+        // Alternate output buffers; a kernel writing one waits only for that buffer's last download
+        int slot = w.nextOut;
+        w.nextOut ^= 1;
+        std::vector<cl::Event> waitFor;
+        if (w.outFree[slot]()) waitFor.push_back(w.outFree[slot]);
+        size_t outBytes = sizeof(float) * t.rows * t.cols;
+        if (outBytes > w.outBytes[slot]) {
+            w.out[slot] = cl::Buffer(w.context, CL_MEM_WRITE_ONLY, outBytes);  // Old one lives until its read completes
+            w.outBytes[slot] = outBytes;
+        }
+
+        kernel.setArg(0, a);
+        kernel.setArg(1, b);
+        kernel.setArg(2, w.out[slot]);
+        kernel.setArg(3, t.rows);
+        kernel.setArg(4, t.cols);
+        kernel.setArg(5, job.K);
+        cl::Event ev;
+        w.queue.enqueueNDRangeKernel(kernel, cl::NullRange, matmulGlobalSize("gemm_nt", p, t.rows, t.cols),
+                                     cl::NDRange(p.localX, p.localY), waitFor.empty() ? nullptr : &waitFor, &ev);
+        traceCommand(w.queue, ev, "gemm_nt tile");
+        w.queue.flush();  // The download queue waits on 'ev'; make sure it is submitted
+
+        // Tile [rows][cols] -> C at (row, col), row pitch N. Non-blocking: tiles write disjoint
+        // regions of C, and drive() drains both queues before returning.
+        const size_t F = sizeof(float);
+        std::vector<cl::Event> kernelDone = {ev};
+        w.downloads.enqueueReadBufferRect(w.out[slot], CL_FALSE, {0, 0, 0}, {t.col * F, (size_t)t.row, 0},
+                                          {t.cols * F, (size_t)t.rows, 1}, t.cols * F, 0, job.N * F, 0, job.C,
+                                          &kernelDone, &w.outFree[slot]);
+        traceCommand(w.downloads, w.outFree[slot], "tile download");
+
+        w.stats.tiles++;
+        w.stats.flops += 2.0 * t.rows * t.cols * job.K;
+        w.kernelEvents.push_back(ev);
+    }
+
+    std::string src_;
+    const TuningDB& db_;
+    int tileM_, tileN_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<Tile> tiles_;
+};
+
+#endif
@@ -0,0 +1,212 @@
+// Paged KV-cache: a preallocated pool of fixed-size K/V blocks plus a block table per sequence.
+// Pairs with Inference/kernels/paged_attention.cl (paged_kv_append / paged_attention_decode).
+#ifndef PAGED_KV_CACHE_HPP
+#define PAGED_KV_CACHE_HPP
+
+#include "utils/cl_runtime.hpp"
+
+#include <iostream>
+#include <vector>
+
+class PagedKVCache {
+public:
+    // Pool layout: [numBlocks][numKVHeads][blockSize][headDim] floats, one pool for K and one for V.
+    PagedKVCache(const cl::Context& context, int numKVHeads, int headDim, int blockSize, int numBlocks,
+                 int maxSeqs, int maxBlocksPerSeq)
+        : context_(context), numKVHeads_(numKVHeads), headDim_(headDim), blockSize_(blockSize),
+          numBlocks_(numBlocks), maxSeqs_(maxSeqs), maxBlocksPerSeq_(maxBlocksPerSeq),
+          tables_((size_t)maxSeqs * maxBlocksPerSeq, 0), lengths_(maxSeqs, 0), active_(maxSeqs, false) {
+        size_t poolBytes = sizeof(float) * blockElements() * numBlocks;
+        keyPool_ = cl::Buffer(context, CL_MEM_READ_WRITE, poolBytes);
+        valuePool_ = cl::Buffer(context, CL_MEM_READ_WRITE, poolBytes);
+        blockTables_ = cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(int) * tables_.size());
+        contextLens_ = cl::Buffer(context, CL_MEM_READ_ONLY, sizeof(int) * maxSeqs);
+
+        // Hand out low block ids first
+        for (int b = numBlocks - 1; b >= 0; b--) freeBlocks_.push_back(b);
+    }
+
+    // Claims a sequence slot. Returns -1 when every slot is in use.
+    int addSequence() {
+        for (int s = 0; s < maxSeqs_; s++) {
+            if (!active_[s]) {
+                active_[s] = true;
+                lengths_[s] = 0;
+                dirty_ = true;
+                return s;
+            }
+        }
+        return -1;
+    }
+
+    // Returns the sequence's blocks to the pool.
+    void freeSequence(int seq) {
+        for (int b = 0; b < blocksUsed(seq); b++) freeBlocks_.push_back(tables_[(size_t)seq * maxBlocksPerSeq_ + b]);
+        lengths_[seq] = 0;
+        active_[seq] = false;
+        dirty_ = true;
+    }
+
+    // Scatters 'numTokens' new K/V rows ([numTokens][numKVHeads][headDim], already on the device)
+    // onto the end of 'seq', claiming blocks as needed. Returns false, with the cache unchanged, if
+    // the pool or table is full.
+    bool appendTokens(const cl::CommandQueue& queue, cl::Kernel& appendKernel, int seq,
+                      const cl::Buffer& kNew, const cl::Buffer& vNew, int numTokens) {
+        if (!fits(std::vector<int>(1, seq), numTokens)) return false;
+        std::vector<int> slots;
+        for (int t = 0; t < numTokens; t++) slots.push_back(claimSlot(seq));
+        enqueueScatter(queue, appendKernel, kNew, vNew, slots);
+        return true;
+    }
+
+    // One decode step for a batch: row i of kNew/vNew is the new token of seqs[i].
+    bool appendDecode(const cl::CommandQueue& queue, cl::Kernel& appendKernel, const std::vector<int>& seqs,
+                      const cl::Buffer& kNew, const cl::Buffer& vNew) {
+        if (!fits(seqs, 1)) return false;
+        std::vector<int> slots;
+        for (int seq : seqs) slots.push_back(claimSlot(seq));
+        enqueueScatter(queue, appendKernel, kNew, vNew, slots);
+        return true;
+    }
+
+    // Uploads block tables and context lengths if they changed since the last sync. The writes are
+    // non-blocking from a staging copy, so the queue keeps running; a staging copy is only reused
+    // once the writes from two syncs ago have completed.
+    void syncTables(const cl::CommandQueue& queue) {
+        if (!dirty_) return;
+        Staging& s = nextStaging();
+        s.tables = tables_;
+        s.lengths = lengths_;
+        s.pending.resize(2);
+        queue.enqueueWriteBuffer(blockTables_, CL_FALSE, 0, sizeof(int) * s.tables.size(), s.tables.data(), nullptr,
+                                 &s.pending[0]);
+        queue.enqueueWriteBuffer(contextLens_, CL_FALSE, 0, sizeof(int) * s.lengths.size(), s.lengths.data(), nullptr,
+                                 &s.pending[1]);
+        dirty_ = false;
+    }
+
+    // Binds the cache arguments of paged_attention_decode (all but Q, O and numHeads/scale).
+    void setDecodeArgs(cl::Kernel& decodeKernel) const {
+        decodeKernel.setArg(1, keyPool_);
+        decodeKernel.setArg(2, valuePool_);
+        decodeKernel.setArg(3, blockTables_);
+        decodeKernel.setArg(4, contextLens_);
+        decodeKernel.setArg(7, numKVHeads_);
+        decodeKernel.setArg(8, maxBlocksPerSeq_);
+    }
+
+    int length(int seq) const { return lengths_[seq]; }
+    int blocksUsed(int seq) const { return (lengths_[seq] + blockSize_ - 1) / blockSize_; }
+    int freeBlockCount() const { return (int)freeBlocks_.size(); }
+    int numBlocks() const { return numBlocks_; }
+    int blockSize() const { return blockSize_; }
+    int maxBlocksPerSeq() const { return maxBlocksPerSeq_; }
+    size_t blockElements() const { return (size_t)numKVHeads_ * blockSize_ * headDim_; }
+    const int* blockTable(int seq) const { return &tables_[(size_t)seq * maxBlocksPerSeq_]; }
+
+    // Slots reserved in claimed blocks but not yet filled (the only waste in a paged cache).
+    size_t internalFragmentation() const {
+        size_t wasted = 0;
+        for (int s = 0; s < maxSeqs_; s++) {
+            if (active_[s]) wasted += (size_t)blocksUsed(s) * blockSize_ - lengths_[s];
+        }
+        return wasted;
+    }
+
+    const cl::Buffer& keyPool() const { return keyPool_; }
+    const cl::Buffer& valuePool() const { return valuePool_; }
+    const cl::Buffer& blockTables() const { return blockTables_; }
+    const cl::Buffer& contextLens() const { return contextLens_; }
+
+private:
+    // True if every sequence in 'seqs' can take 'tokensEach' more tokens (a sequence may appear more
+    // than once). Checked before any state changes, so a failed append claims nothing.
+    bool fits(const std::vector<int>& seqs, int tokensEach) const {
+        std::vector<int> added(maxSeqs_, 0);
+        for (int seq : seqs) added[seq] += tokensEach;
+        size_t needed = 0;
+        for (int s = 0; s < maxSeqs_; s++) {
+            if (!added[s]) continue;
+            int blocksAfter = (lengths_[s] + added[s] + blockSize_ - 1) / blockSize_;
+            if (blocksAfter > maxBlocksPerSeq_) {
+                std::cerr << "Error: KV cache block table full for sequence " << s << std::endl;
+                return false;
+            }
+            needed += blocksAfter - blocksUsed(s);
+        }
+        if (needed > freeBlocks_.size()) {
+            std::cerr << "Error: KV cache exhausted (" << needed << " blocks needed, " << freeBlocks_.size()
+                      << " free)" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    // Next free slot of 'seq' (block * blockSize + offset), claiming a fresh block on a boundary.
+    // Callers check fits() first.
+    int claimSlot(int seq) {
+        int pos = lengths_[seq];
+        int logical = pos / blockSize_;
+        if (pos % blockSize_ == 0) {
+            tables_[(size_t)seq * maxBlocksPerSeq_ + logical] = freeBlocks_.back();
+            freeBlocks_.pop_back();
+        }
+        lengths_[seq]++;
+        dirty_ = true;
+        return tables_[(size_t)seq * maxBlocksPerSeq_ + logical] * blockSize_ + pos % blockSize_;
+    }
+
+    // Host copies handed to non-blocking writes, alternated so one can be refilled while the
+    // other's writes are still in flight.
+    struct Staging {
+        std::vector<int> tables, lengths, slots;
+        std::vector<cl::Event> pending;
+    };
+
+    Staging& nextStaging() {
+        Staging& s = staging_[stagingIndex_];
+        stagingIndex_ ^= 1;
+        if (!s.pending.empty()) cl::Event::waitForEvents(s.pending);
+        s.pending.clear();
+        return s;
+    }
+
+    void enqueueScatter(const cl::CommandQueue& queue, cl::Kernel& appendKernel, const cl::Buffer& kNew,
+                        const cl::Buffer& vNew, const std::vector<int>& slots) {
+        if (slots.empty()) return;
+        if (slots.size() > slotCapacity_) {
+            slotCapacity_ = slots.size();
+            slotBuffer_ = cl::Buffer(context_, CL_MEM_READ_ONLY, sizeof(int) * slotCapacity_);
+        }
+        Staging& s = nextStaging();
+        s.slots = slots;
+        s.pending.resize(1);
+        queue.enqueueWriteBuffer(slotBuffer_, CL_FALSE, 0, sizeof(int) * s.slots.size(), s.slots.data(), nullptr,
+                                 &s.pending[0]);
+
+        appendKernel.setArg(0, kNew);
+        appendKernel.setArg(1, vNew);
+        appendKernel.setArg(2, keyPool_);
+        appendKernel.setArg(3, valuePool_);
+        appendKernel.setArg(4, slotBuffer_);
+        appendKernel.setArg(5, numKVHeads_);
+        queue.enqueueNDRangeKernel(appendKernel, cl::NullRange, cl::NDRange(headDim_, numKVHeads_, slots.size()));
+    }
+
+    cl::Context context_;
+    int numKVHeads_, headDim_, blockSize_, numBlocks_, maxSeqs_, maxBlocksPerSeq_;
+
+    cl::Buffer keyPool_, valuePool_, blockTables_, contextLens_;
+    cl::Buffer slotBuffer_;
+    size_t slotCapacity_ = 0;
+
+    std::vector<int> tables_;   // Host mirror of blockTables_
+    std::vector<int> lengths_;  // Host mirror of contextLens_
+    std::vector<bool> active_;
+    std::vector<int> freeBlocks_;
+    bool dirty_ = true;
+    Staging staging_[2];
+    int stagingIndex_ = 0;
+};
+
+#endif
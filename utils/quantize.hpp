@@ -0,0 +1,138 @@
+// Host-side weight quantizer for Inference/kernels/quant_matmul.cl.
+// Asymmetric (min/max) quantization to int8 or packed int4, one scale + zero point per group of
+// 'groupSize' consecutive K values of each output row.
+#ifndef QUANTIZE_HPP
+#define QUANTIZE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+struct QuantizedWeights {
+    int bits = 8, N = 0, K = 0, groupSize = 64;
+    std::vector<uint8_t> q;       // bits == 8: [N][K]; bits == 4: [N][K / 2], low nibble = even k
+    std::vector<float> scales;    // [N][K / groupSize]
+    std::vector<uint8_t> zeros;   // [N][K / groupSize]
+
+    size_t bytes() const { return q.size() + scales.size() * sizeof(float) + zeros.size(); }
+};
+
+// W is [N][K] row-major. K must be a multiple of groupSize (and groupSize of 8 for the kernels).
+inline QuantizedWeights quantizeWeights(const float* W, int N, int K, int bits, int groupSize) {
+    QuantizedWeights qw;
+    qw.bits = bits;
+    qw.N = N;
+    qw.K = K;
+    qw.groupSize = groupSize;
+
+    int groups = K / groupSize;
+    int qmax = (1 << bits) - 1;
+    qw.q.assign(bits == 4 ? (size_t)N * K / 2 : (size_t)N * K, 0);
+    qw.scales.resize((size_t)N * groups);
+    qw.zeros.resize((size_t)N * groups);
+
+    for (int n = 0; n < N; n++) {
+        for (int g = 0; g < groups; g++) {
+            const float* w = W + (size_t)n * K + (size_t)g * groupSize;
+            float lo = *std::min_element(w, w + groupSize);
+            float hi = *std::max_element(w, w + groupSize);
+            lo = std::min(lo, 0.0f);  // Keep 0.0 exactly representable
+            hi = std::max(hi, 0.0f);
+
+            float scale = (hi > lo) ? (hi - lo) / qmax : 1.0f;
+            int zero = std::clamp((int)std::lround(-lo / scale), 0, qmax);
+            qw.scales[(size_t)n * groups + g] = scale;
+            qw.zeros[(size_t)n * groups + g] = (uint8_t)zero;
+
+            for (int i = 0; i < groupSize; i++) {
+                int q = std::clamp((int)std::lround(w[i] / scale) + zero, 0, qmax);
+                size_t k = (size_t)g * groupSize + i;
+                if (bits == 4) {
+                    uint8_t& b = qw.q[((size_t)n * K + k) / 2];
+                    b |= (k & 1) ? (uint8_t)(q << 4) : (uint8_t)q;
+                } else {
+                    qw.q[(size_t)n * K + k] = (uint8_t)q;
+                }
+            }
+        }
+    }
+    return qw;
+}
+
+// Inverse of quantizeWeights: the exact weights the kernels see, as [N][K] floats.
+inline std::vector<float> dequantizeWeights(const QuantizedWeights& qw) {
+    std::vector<float> W((size_t)qw.N * qw.K);
+    int groups = qw.K / qw.groupSize;
+    for (int n = 0; n < qw.N; n++) {
+        for (int k = 0; k < qw.K; k++) {
+            size_t idx = (size_t)n * qw.K + k;
+            int q = (qw.bits == 4) ? ((k & 1) ? qw.q[idx / 2] >> 4 : qw.q[idx / 2] & 0xF) : qw.q[idx];
+            size_t gi = (size_t)n * groups + k / qw.groupSize;
+            W[idx] = (q - qw.zeros[gi]) * qw.scales[gi];
+        }
+    }
+    return W;
+}
+
+// IEEE half <-> float for FP16 activation buffers (round to nearest even, no NaN payloads).
+inline uint16_t floatToHalf(float f) {
+    uint32_t x;
+    std::memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    int32_t exp = (int32_t)((x >> 23) & 0xFF) - 127 + 15;
+    uint32_t mant = x & 0x7FFFFF;
+
+    if (((x >> 23) & 0xFF) == 0xFF) return (uint16_t)(sign | 0x7C00 | (mant ? 0x200 : 0));  // Inf / NaN
+    if (exp >= 31) return (uint16_t)(sign | 0x7C00);                                          // Overflow
+    if (exp <= 0) {
+        if (exp < -10) return (uint16_t)sign;  // Underflow to zero
+        mant |= 0x800000;                      // Subnormal: shift in the implicit bit
+        uint32_t shift = (uint32_t)(14 - exp);
+        uint32_t h = mant >> shift;
+        uint32_t rem = mant & ((1u << shift) - 1);
+        uint32_t half = 1u << (shift - 1);
+        if (rem > half || (rem == half && (h & 1))) h++;
+        return (uint16_t)(sign | h);
+    }
+    uint32_t h = sign | ((uint32_t)exp << 10) | (mant >> 13);
+    uint32_t rem = mant & 0x1FFF;
+    if (rem > 0x1000 || (rem == 0x1000 && (h & 1))) h++;  // May carry into the exponent, which is correct
+    return (uint16_t)h;
+}
+
+inline float halfToFloat(uint16_t h) {
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t exp = (h >> 10) & 0x1F;
+    uint32_t mant = h & 0x3FF;
+    uint32_t x;
+    if (exp == 0) {
+        if (mant == 0) {
+            x = sign;
+        } else {
+            // Normalize the subnormal
+            exp = 127 - 15 + 1;
+            while (!(mant & 0x400)) {
+                mant <<= 1;
+                exp--;
+            }
+            x = sign | (exp << 23) | ((mant & 0x3FF) << 13);
+        }
+    } else if (exp == 31) {
+        x = sign | 0x7F800000 | (mant << 13);
+    } else {
+        x = sign | ((exp + 127 - 15) << 23) | (mant << 13);
+    }
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+inline std::vector<uint16_t> toHalf(const std::vector<float>& v) {
+    std::vector<uint16_t> h(v.size());
+    for (size_t i = 0; i < v.size(); i++) h[i] = floatToHalf(v[i]);
+    return h;
+}
+
+#endif
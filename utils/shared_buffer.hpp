@@ -0,0 +1,267 @@
+// Host/device buffers with a selectable transfer strategy: explicit copies for discrete GPUs,
+// zero-copy host-pointer / map-unmap buffers or SVM for unified-memory (UMA) devices.
+#ifndef SHARED_BUFFER_HPP
+#define SHARED_BUFFER_HPP
+
+#include "utils/cl_runtime.hpp"
+#include "utils/device_arena.hpp"
+#include "utils/trace.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+enum class BufferMode {
+    Copy,          // Device buffer + host staging; enqueueWriteBuffer / enqueueReadBuffer
+    HostPtr,       // Page-aligned host allocation wrapped with CL_MEM_USE_HOST_PTR; map/unmap for sync
+    AllocHostPtr,  // Runtime-allocated host-visible memory (CL_MEM_ALLOC_HOST_PTR); map/unmap for access
+    SVMCoarse,     // Coarse-grained SVM (OpenCL 2.0); enqueueMapSVM / enqueueUnmapSVM
+    SVMFine,       // Fine-grained SVM; host and device share the pointer, no map needed
+};
+
+inline const char* bufferModeName(BufferMode mode) {
+    switch (mode) {
+        case BufferMode::Copy: return "Copy";
+        case BufferMode::HostPtr: return "UseHostPtr";
+        case BufferMode::AllocHostPtr: return "AllocHostPtr";
+        case BufferMode::SVMCoarse: return "SVM Coarse";
+        case BufferMode::SVMFine: return "SVM Fine";
+    }
+    return "?";
+}
+
+// Same probe as cl_info.cpp. CPU devices always share host memory.
+inline bool isUnifiedMemory(const cl::Device& device) {
+    cl_bool unifiedMem = CL_FALSE;
+    device.getInfo(CL_DEVICE_HOST_UNIFIED_MEMORY, &unifiedMem);  // Deprecated in 2.0; failure leaves NO
+    return unifiedMem || device.getInfo<CL_DEVICE_TYPE>() == CL_DEVICE_TYPE_CPU;
+}
+
+inline cl_device_svm_capabilities svmCapabilities(const cl::Device& device) {
+    cl_device_svm_capabilities caps = 0;
+    std::string version = device.getInfo<CL_DEVICE_VERSION>();  // "OpenCL <major>.<minor> ..."
+    if (version.size() > 7 && version[7] >= '2') device.getInfo(CL_DEVICE_SVM_CAPABILITIES, &caps);
+    return caps;
+}
+
+inline bool supportsBufferMode(const cl::Device& device, BufferMode mode) {
+    if (mode == BufferMode::SVMCoarse) return svmCapabilities(device) & CL_DEVICE_SVM_COARSE_GRAIN_BUFFER;
+    if (mode == BufferMode::SVMFine) return svmCapabilities(device) & CL_DEVICE_SVM_FINE_GRAIN_BUFFER;
+    return true;
+}
+
+// Discrete devices copy; UMA devices use fine-grained SVM when available, otherwise page-aligned
+// host pointers. OCL_BUFFER_MODE=copy|hostptr|allochost|svm|svmfine overrides the choice; an
+// unknown value, or a mode the device can't do, is reported once and the default is used.
+inline BufferMode chooseBufferMode(const cl::Device& device) {
+    const char* env = std::getenv("OCL_BUFFER_MODE");
+    if (env && *env) {
+        static bool warned = false;
+        std::string m = toLower(env);
+        bool known = true;
+        BufferMode forced = BufferMode::Copy;
+        if (m == "copy") forced = BufferMode::Copy;
+        else if (m == "hostptr") forced = BufferMode::HostPtr;
+        else if (m == "allochost") forced = BufferMode::AllocHostPtr;
+        else if (m == "svm") forced = BufferMode::SVMCoarse;
+        else if (m == "svmfine") forced = BufferMode::SVMFine;
+        else known = false;
+
+        if (known && supportsBufferMode(device, forced)) return forced;
+        if (!warned) {
+            warned = true;
+            if (!known) {
+                std::cerr << "Warning: OCL_BUFFER_MODE=" << env
+                          << " is not one of copy|hostptr|allochost|svm|svmfine; using the default" << std::endl;
+            } else {
+                std::cerr << "Warning: OCL_BUFFER_MODE=" << env << " (" << bufferModeName(forced)
+                          << ") is not supported by this device; using the default" << std::endl;
+            }
+        }
+    }
+    if (!isUnifiedMemory(device)) return BufferMode::Copy;
+    if (supportsBufferMode(device, BufferMode::SVMFine)) return BufferMode::SVMFine;
+    return BufferMode::HostPtr;
+}
+
+// Page alignment satisfies CL_DEVICE_MEM_BASE_ADDR_ALIGN everywhere we run and is what
+// Intel/ARM drivers require before they will skip the copy for CL_MEM_USE_HOST_PTR.
+constexpr size_t kPageSize = 4096;
+
+// Exits with the size on failure, so callers never carry a null host pointer into map() or a kernel.
+inline void* alignedAlloc(size_t bytes) {
+    size_t size = ((bytes + kPageSize - 1) / kPageSize) * kPageSize;
+    if (size == 0) size = kPageSize;  // A zero-byte request may legitimately return null
+#ifdef _WIN32
+    void* p = _aligned_malloc(size, kPageSize);
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, kPageSize, size) != 0) p = nullptr;
+#endif
+    if (!p) {
+        std::cerr << "Error: failed to allocate " << size << " bytes of page-aligned host memory" << std::endl;
+        exit(1);
+    }
+    return p;
+}
+
+inline void alignedFree(void* p) {
+#ifdef _WIN32
+    _aligned_free(p);
+#else
+    free(p);
+#endif
+}
+
+// A buffer the host fills/reads and kernels consume, with the transfer strategy hidden behind
+// mapWrite/unmapWrite (host -> device) and mapRead/unmapRead (device -> host). Pass an event
+// pointer to profile the command behind each step (none is enqueued for fine-grained SVM); with
+// OCL_TRACE set every step is also recorded on the trace timeline (utils/trace.hpp).
+class SharedBuffer {
+public:
+    SharedBuffer(const cl::Context& context, size_t bytes, BufferMode mode, cl_mem_flags access = CL_MEM_READ_WRITE)
+        : context_(context), bytes_(bytes), mode_(mode) {
+        allocate(access);
+    }
+
+    // Copy mode takes its device buffer from 'arena' and hands it back on destruction, so a loop
+    // that recreates same-sized buffers reuses one slab region instead of reallocating.
+    // The zero-copy modes allocate exactly as above.
+    SharedBuffer(DeviceArena& arena, size_t bytes, BufferMode mode, cl_mem_flags access = CL_MEM_READ_WRITE)
+        : context_(arena.context()), bytes_(bytes), mode_(mode) {
+        if (mode != BufferMode::Copy) {
+            allocate(access);
+            return;
+        }
+        arena_ = &arena;
+        block_ = arena.allocate(bytes, access);
+        host_ = alignedAlloc(bytes);
+        buffer_ = block_.buffer;
+    }
+
+    ~SharedBuffer() {
+        if (arena_) arena_->release(block_);
+        if (svm_) clSVMFree(context_(), svm_);
+        if (host_) alignedFree(host_);
+    }
+
+    SharedBuffer(const SharedBuffer&) = delete;
+    SharedBuffer& operator=(const SharedBuffer&) = delete;
+
+    BufferMode mode() const { return mode_; }
+    size_t bytes() const { return bytes_; }
+
+    // Host pointer to write inputs into. Contents are undefined until written.
+    template <typename T>
+    T* mapWrite(const cl::CommandQueue& queue, cl::Event* ev = nullptr) {
+        return static_cast<T*>(map(queue, CL_MAP_WRITE_INVALIDATE_REGION, ev));
+    }
+
+    // Makes the host writes visible to the device. In Copy mode this is the HRAM upload.
+    void unmapWrite(const cl::CommandQueue& queue, cl::Event* ev = nullptr) {
+        if (mode_ == BufferMode::Copy) {
+            TraceEvent te(ev);
+            queue.enqueueWriteBuffer(buffer_, CL_FALSE, 0, bytes_, host_, nullptr, te.get());
+            te.record(queue, "SharedBuffer write");
+            return;
+        }
+        unmap(queue, ev);
+    }
+
+    // Host pointer with the device's results. In Copy mode this is the HRAM download. Blocks.
+    template <typename T>
+    const T* mapRead(const cl::CommandQueue& queue, cl::Event* ev = nullptr) {
+        if (mode_ == BufferMode::Copy) {
+            TraceEvent te(ev);
+            queue.enqueueReadBuffer(buffer_, CL_TRUE, 0, bytes_, host_, nullptr, te.get());
+            te.record(queue, "SharedBuffer read");
+            return static_cast<const T*>(host_);
+        }
+        return static_cast<const T*>(map(queue, CL_MAP_READ, ev));
+    }
+
+    void unmapRead(const cl::CommandQueue& queue, cl::Event* ev = nullptr) {
+        if (mode_ != BufferMode::Copy) unmap(queue, ev);
+    }
+
+    void setArg(cl::Kernel& kernel, cl_uint index) const {
+        if (svm_) kernel.setArg(index, svm_);
+        else kernel.setArg(index, buffer_);
+    }
+
+private:
+    void allocate(cl_mem_flags access) {
+        switch (mode_) {
+            case BufferMode::Copy:
+                host_ = alignedAlloc(bytes_);
+                buffer_ = cl::Buffer(context_, access, bytes_);
+                break;
+            case BufferMode::HostPtr:
+                host_ = alignedAlloc(bytes_);
+                buffer_ = cl::Buffer(context_, access | CL_MEM_USE_HOST_PTR, bytes_, host_);
+                break;
+            case BufferMode::AllocHostPtr:
+                buffer_ = cl::Buffer(context_, access | CL_MEM_ALLOC_HOST_PTR, bytes_);
+                break;
+            case BufferMode::SVMCoarse:
+                svm_ = clSVMAlloc(context_(), CL_MEM_READ_WRITE, bytes_, 0);
+                break;
+            case BufferMode::SVMFine:
+                svm_ = clSVMAlloc(context_(), CL_MEM_READ_WRITE | CL_MEM_SVM_FINE_GRAIN_BUFFER, bytes_, 0);
+                break;
+        }
+        if ((mode_ == BufferMode::SVMCoarse || mode_ == BufferMode::SVMFine) && !svm_) {
+            std::cerr << "Error: clSVMAlloc of " << bytes_ << " bytes failed (" << bufferModeName(mode_) << ")" << std::endl;
+            exit(1);
+        }
+    }
+
+    void* map(const cl::CommandQueue& queue, cl_map_flags flags, cl::Event* ev) {
+        TraceEvent te(ev);
+        switch (mode_) {
+            case BufferMode::Copy:
+                return host_;
+            case BufferMode::HostPtr:
+            case BufferMode::AllocHostPtr:
+                mapped_ = queue.enqueueMapBuffer(buffer_, CL_TRUE, flags, 0, bytes_, nullptr, te.get());
+                te.record(queue, "SharedBuffer map");
+                return mapped_;
+            case BufferMode::SVMCoarse:
+                queue.enqueueMapSVM(svm_, CL_TRUE, flags, bytes_, nullptr, te.get());
+                te.record(queue, "SharedBuffer map");
+                return svm_;
+            case BufferMode::SVMFine:
+                queue.finish();  // Device writes are visible once the producing commands complete
+                return svm_;
+        }
+        return nullptr;
+    }
+
+    void unmap(const cl::CommandQueue& queue, cl::Event* ev) {
+        TraceEvent te(ev);
+        if (mode_ == BufferMode::HostPtr || mode_ == BufferMode::AllocHostPtr) {
+            queue.enqueueUnmapMemObject(buffer_, mapped_, nullptr, te.get());
+            te.record(queue, "SharedBuffer unmap");
+            mapped_ = nullptr;
+        } else if (mode_ == BufferMode::SVMCoarse) {
+            queue.enqueueUnmapSVM(svm_, nullptr, te.get());
+            te.record(queue, "SharedBuffer unmap");
+        }
+    }
+
+    cl::Context context_;
+    size_t bytes_;
+    BufferMode mode_;
+    cl::Buffer buffer_;
+    void* host_ = nullptr;    // Staging (Copy) or backing store (HostPtr)
+    void* svm_ = nullptr;
+    void* mapped_ = nullptr;
+    DeviceArena* arena_ = nullptr;  // Owner of block_ (Copy mode from an arena)
+    DeviceArena::Block block_;
+};
+
+#endif
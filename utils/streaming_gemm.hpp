@@ -0,0 +1,163 @@
+// Out-of-core GEMM: C = A * B with A [M][K], B [K][N] and C [M][N] left in host memory.
+// The output is produced in T x T blocks; for each block the T x T panels of A and B along K are
+// streamed through two device slots and accumulated with register_matmul (-DACCUMULATE).
+// Pipelined mode uses three in-order queues (upload, compute, download) ordered only by events,
+// so panel i+1 uploads while panel i computes and block j downloads while block j+1 computes.
+#ifndef STREAMING_GEMM_HPP
+#define STREAMING_GEMM_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+#include "utils/trace.hpp"
+#include "utils/tuning.hpp"
+
+struct StreamingStats {
+    double wallMs = 0.0;
+    double uploadMs = 0.0;    // Sum of H2D command times
+    double computeMs = 0.0;   // Sum of kernel times
+    double downloadMs = 0.0;  // Sum of D2H command times
+    int panels = 0;           // (A, B) panel pairs uploaded
+
+    // > 1 when transfers overlapped compute: the busy time of all three engines over the wall time
+    double overlap() const { return wallMs > 0 ? (uploadMs + computeMs + downloadMs) / wallMs : 0.0; }
+};
+
+// Largest block edge whose device footprint fits 'budgetBytes': two (A, B) panel slots plus two
+// C blocks = 6 T^2 floats. Rounded down to 'align' (TileSize * WPT) and capped by the problem size.
+inline int streamingTile(size_t budgetBytes, size_t maxAlloc, int M, int N, int K, int align) {
+    size_t t = (size_t)std::sqrt((double)budgetBytes / (6.0 * sizeof(float)));
+    t = std::min(t, (size_t)std::sqrt((double)maxAlloc / sizeof(float)));
+    t = std::max((t / align) * align, (size_t)align);
+    return (int)std::min(t, roundUp(std::max({M, N, K}), align));
+}
+
+class StreamingGemm {
+public:
+    // 'overwrite' / 'accumulate' are register_matmul built with 'p' without / with -DACCUMULATE.
+    // pipelined = false runs the same blocking on one queue with one slot (write -> kernel -> read).
+    StreamingGemm(const cl::Context& context, const cl::Device& device, const cl::Kernel& overwrite,
+                  const cl::Kernel& accumulate, const TuneParams& p, int tile, bool pipelined)
+        : overwrite_(overwrite), accumulate_(accumulate), params_(p), tile_(tile) {
+        int nq = pipelined ? 3 : 1;
+        for (int i = 0; i < nq; i++) queues_.emplace_back(context, device, CL_QUEUE_PROFILING_ENABLE);
+
+        size_t blockBytes = sizeof(float) * tile * tile;
+        int nslots = pipelined ? 2 : 1;
+        for (int i = 0; i < nslots; i++) {
+            panels_.push_back({cl::Buffer(context, CL_MEM_READ_ONLY, blockBytes),
+                               cl::Buffer(context, CL_MEM_READ_ONLY, blockBytes), cl::Event()});
+            outputs_.push_back({cl::Buffer(context, CL_MEM_WRITE_ONLY, blockBytes), cl::Event()});
+        }
+    }
+
+    int tile() const { return tile_; }
+    size_t deviceBytes() const { return (2 * panels_.size() + outputs_.size()) * sizeof(float) * tile_ * tile_; }
+
+    StreamingStats run(const float* A, const float* B, float* C, int M, int N, int K) {
+        cl::CommandQueue& upload = queues_[0];
+        cl::CommandQueue& compute = queues_[queues_.size() > 1 ? 1 : 0];
+        cl::CommandQueue& download = queues_[queues_.size() > 1 ? 2 : 0];
+        const size_t F = sizeof(float);
+        const int T = tile_;
+
+        std::vector<cl::Event> upEvents, kernelEvents, downEvents;
+        StreamingStats stats;
+        size_t slot = 0, cslot = 0;
+        TraceSpan span("StreamingGemm::run");
+        auto t0 = std::chrono::high_resolution_clock::now();
+
+        for (int i0 = 0; i0 < M; i0 += T) {
+            int mb = std::min(T, M - i0);
+            for (int j0 = 0; j0 < N; j0 += T) {
+                int nb = std::min(T, N - j0);
+                OutputSlot& out = outputs_[cslot];
+
+                for (int k0 = 0; k0 < K; k0 += T) {
+                    int kb = std::min(T, K - k0);
+                    PanelSlot& s = panels_[slot];
+
+                    // WAR: don't overwrite the slot until the kernel that last read it has finished
+                    std::vector<cl::Event> free;
+                    if (s.consumed()) free.push_back(s.consumed);
+
+                    // Strided sub-blocks straight from the host matrices into compact device panels
+                    cl::Event upA, upB;
+                    upload.enqueueWriteBufferRect(s.a, CL_FALSE, {0, 0, 0}, {(size_t)k0 * F, (size_t)i0, 0},
+                                                  {(size_t)kb * F, (size_t)mb, 1}, kb * F, 0, K * F, 0, A, &free, &upA);
+                    upload.enqueueWriteBufferRect(s.b, CL_FALSE, {0, 0, 0}, {(size_t)j0 * F, (size_t)k0, 0},
+                                                  {(size_t)nb * F, (size_t)kb, 1}, nb * F, 0, N * F, 0, B, &free, &upB);
+                    upload.flush();
+                    traceCommand(upload, upA, "stream upload A");
+                    traceCommand(upload, upB, "stream upload B");
+
+                    // The first K panel overwrites the C block, so it must wait for that block's last download
+                    std::vector<cl::Event> ready = {upA, upB};
+                    if (k0 == 0 && out.drained()) ready.push_back(out.drained);
+
+                    cl::Kernel& kernel = (k0 == 0) ? overwrite_ : accumulate_;
+                    kernel.setArg(0, s.a); kernel.setArg(1, s.b); kernel.setArg(2, out.c);
+                    kernel.setArg(3, mb); kernel.setArg(4, nb); kernel.setArg(5, kb);
+                    compute.enqueueNDRangeKernel(kernel, cl::NullRange, matmulGlobalSize("register_matmul", params_, mb, nb),
+                                                 cl::NDRange(params_.localX, params_.localY), &ready, &s.consumed);
+                    compute.flush();
+                    traceCommand(compute, s.consumed, k0 == 0 ? "stream matmul" : "stream matmul accumulate");
+
+                    upEvents.push_back(upA);
+                    upEvents.push_back(upB);
+                    kernelEvents.push_back(s.consumed);
+                    stats.panels++;
+                    slot = (slot + 1) % panels_.size();
+                }
+
+                // Block result back into its place in the host C once the last K panel is done
+                std::vector<cl::Event> done = {kernelEvents.back()};
+                download.enqueueReadBufferRect(out.c, CL_FALSE, {0, 0, 0}, {(size_t)j0 * F, (size_t)i0, 0},
+                                               {(size_t)nb * F, (size_t)mb, 1}, nb * F, 0, N * F, 0, C, &done, &out.drained);
+                download.flush();
+                traceCommand(download, out.drained, "stream download C");
+                downEvents.push_back(out.drained);
+                cslot = (cslot + 1) % outputs_.size();
+            }
+        }
+        for (auto& q : queues_) q.finish();
+        auto t1 = std::chrono::high_resolution_clock::now();
+
+        auto total = [](std::vector<cl::Event>& events) {
+            double ms = 0.0;
+            for (auto& e : events)
+                ms += (e.getProfilingInfo<CL_PROFILING_COMMAND_END>() - e.getProfilingInfo<CL_PROFILING_COMMAND_START>()) * 1.0e-6;
+            return ms;
+        };
+        stats.wallMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+        stats.uploadMs = total(upEvents);
+        stats.computeMs = total(kernelEvents);
+        stats.downloadMs = total(downEvents);
+
+        // Reset the slot events so a second run() starts unconstrained
+        for (auto& s : panels_) s.consumed = cl::Event();
+        for (auto& o : outputs_) o.drained = cl::Event();
+        return stats;
+    }
+
+private:
+    struct PanelSlot {
+        cl::Buffer a, b;
+        cl::Event consumed;  // Kernel that last read this slot
+    };
+    struct OutputSlot {
+        cl::Buffer c;
+        cl::Event drained;  // Download that last read this block
+    };
+
+    cl::Kernel overwrite_, accumulate_;
+    TuneParams params_;
+    int tile_;
+    std::vector<cl::CommandQueue> queues_;
+    std::vector<PanelSlot> panels_;
+    std::vector<OutputSlot> outputs_;
+};
+
+#endif
@@ -0,0 +1,114 @@
+// Fixed-size pool of host worker threads for the CPU backends. run(tasks, fn) hands task indices
+// 0..tasks-1 out dynamically (an atomic counter, so uneven tasks balance themselves), the calling
+// thread works alongside the pool, and the call returns once every task is done.
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+public:
+    // threads = 0: $OCL_CPU_THREADS if set, otherwise every hardware thread
+    explicit ThreadPool(int threads = 0) {
+        if (threads <= 0) {
+            const char* env = std::getenv("OCL_CPU_THREADS");
+            threads = env ? std::atoi(env) : (int)std::thread::hardware_concurrency();
+        }
+        size_ = threads > 0 ? threads : 1;
+        for (int w = 1; w < size_; w++) workers_.emplace_back([this, w] { loop(w); });
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& t : workers_) t.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Participants, including the calling thread. Worker ids passed to 'fn' are 0..size()-1.
+    int size() const { return size_; }
+
+    // fn(task, worker) for every task. Not reentrant: 'fn' must not call run() on the same pool.
+    void run(int tasks, const std::function<void(int task, int worker)>& fn) {
+        if (tasks <= 0) return;
+        if (size_ == 1 || tasks == 1) {
+            for (int t = 0; t < tasks; t++) fn(t, 0);
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            job_ = &fn;
+            tasks_ = tasks;
+            next_ = 0;
+            pending_ = tasks;
+            generation_++;
+        }
+        wake_.notify_all();
+        work(&fn, 0);
+
+        // Also wait for workers to leave work(), so none can carry this job into the next run()
+        std::unique_lock<std::mutex> lock(mutex_);
+        done_.wait(lock, [this] { return pending_ == 0 && busy_ == 0; });
+        job_ = nullptr;
+    }
+
+private:
+    void loop(int worker) {
+        size_t seen = 0;
+        for (;;) {
+            const std::function<void(int, int)>* job;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+                job = job_;
+                if (!job) continue;  // Woke after that run() already returned
+                busy_++;
+            }
+            work(job, worker);
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (--busy_ == 0 && pending_ == 0) done_.notify_all();
+        }
+    }
+
+    void work(const std::function<void(int, int)>* job, int worker) {
+        int finished = 0;
+        for (int t; (t = next_.fetch_add(1)) < tasks_; finished++) (*job)(t, worker);
+        if (finished == 0) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_ -= finished;
+    }
+
+    int size_ = 1;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_, done_;
+    const std::function<void(int, int)>* job_ = nullptr;
+    int tasks_ = 0;
+    std::atomic<int> next_{0};
+    int pending_ = 0;  // Tasks not yet finished
+    int busy_ = 0;     // Workers inside work()
+    size_t generation_ = 0;
+    bool stop_ = false;
+};
+
+// Shared pool for code that doesn't manage its own (sized once, on first use)
+inline ThreadPool& defaultThreadPool() {
+    static ThreadPool pool;
+    return pool;
+}
+
+#endif
@@ -0,0 +1,353 @@
+// Timeline tracing: every command enqueued through the project's helpers (with all four profiling
+// timestamps) plus host-side spans, written as Chrome trace-event JSON that chrome://tracing and
+// ui.perfetto.dev open directly. Enabled by OCL_TRACE=<output.json>; when it is unset every hook
+// is a single branch on a cached flag and nothing is recorded.
+//
+// The timeline has one process per device and one thread (track) per command queue, with host
+// spans on a "Host" process, one track per thread. Each command is an execution slice
+// (START..END) whose args carry its queued->submit and submit->start latencies and the idle time
+// since the previous command on that queue; the QUEUED..START wait is drawn as an async "pending"
+// slice so overlapping waits stay visible. The queues must be created with
+// CL_QUEUE_PROFILING_ENABLE; commands from queues without it are counted and left out.
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#ifndef CL_HPP_TARGET_OPENCL_VERSION
+#define CL_HPP_TARGET_OPENCL_VERSION 200
+#endif
+#include <CL/opencl.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+inline const char* tracePath() {
+    static const char* path = [] {
+        const char* env = std::getenv("OCL_TRACE");
+        return env && *env && std::string(env) != "0" ? env : nullptr;
+    }();
+    return path;
+}
+
+inline bool traceEnabled() {
+    static const bool enabled = tracePath() != nullptr;
+    return enabled;
+}
+
+// Nanoseconds on the host timeline (steady clock)
+inline int64_t traceNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+class Tracer {
+public:
+    ~Tracer() {
+        if (traceEnabled()) write(tracePath());
+    }
+
+    // 'event' must belong to a command just enqueued on 'queue'
+    void command(const cl::CommandQueue& queue, const cl::Event& event, const char* name) {
+        int64_t hostNs = traceNowNs();
+        if (!event()) return;
+        std::lock_guard<std::mutex> lock(mutex_);
+        Command c;
+        c.event = event;
+        c.name = name;
+        c.track = track(queue);
+        c.hostNs = hostNs;
+        commands_.push_back(std::move(c));
+        if (commands_.size() >= sweepAt_) sweep();
+    }
+
+    void span(const std::string& name, const char* category, int64_t beginNs, int64_t endNs) {
+        int thread = threadIndex();
+        std::lock_guard<std::mutex> lock(mutex_);
+        spans_.push_back({name, category, thread, beginNs, endNs});
+        threads_ = std::max(threads_, thread + 1);
+    }
+
+    // Resolves every recorded command and writes the timeline; called at exit when tracing is on
+    bool write(const std::string& path) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& c : commands_) resolve(c);
+
+        // Device counters -> host clock. The enqueue returned after QUEUED was stamped, so the
+        // smallest (host - queued) over a device's commands is the tightest estimate of the offset.
+        std::map<cl_device_id, int64_t> offset;
+        for (auto& c : commands_) {
+            if (!c.valid) continue;
+            cl_device_id dev = tracks_[c.track].device;
+            int64_t o = c.hostNs - (int64_t)c.queued;
+            auto it = offset.find(dev);
+            if (it == offset.end() || o < it->second) offset[dev] = o;
+        }
+
+        int64_t origin = std::numeric_limits<int64_t>::max();
+        for (auto& s : spans_) origin = std::min(origin, s.beginNs);
+        for (auto& c : commands_) {
+            if (c.valid) origin = std::min(origin, (int64_t)c.queued + offset[tracks_[c.track].device]);
+        }
+        auto us = [&](int64_t ns) { return (ns - origin) * 1.0e-3; };
+
+        std::ofstream out(path);
+        if (!out) {
+            std::cerr << "Warning: could not write trace " << path << std::endl;
+            return false;
+        }
+        out << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        auto sep = [&]() -> std::ostream& {
+            out << (first ? "" : ",\n");
+            first = false;
+            return out;
+        };
+
+        // --- Track names ---
+        sep() << R"({"name":"process_name","ph":"M","pid":0,"args":{"name":"Host"}})";
+        sep() << R"({"name":"process_sort_index","ph":"M","pid":0,"args":{"sort_index":0}})";
+        for (int t = 0; t < threads_; t++) {
+            sep() << R"({"name":"thread_name","ph":"M","pid":0,"tid":)" << t << R"(,"args":{"name":"Thread )" << t << "\"}}";
+        }
+        std::vector<cl_device_id> devices;
+        for (auto& tr : tracks_) {
+            if (std::find(devices.begin(), devices.end(), tr.device) != devices.end()) continue;
+            devices.push_back(tr.device);
+            int pid = (int)devices.size();
+            sep() << R"({"name":"process_name","ph":"M","pid":)" << pid << R"(,"args":{"name":"Device )" << pid - 1
+                  << ": " << escape(tr.deviceName) << "\"}}";
+            sep() << R"({"name":"process_sort_index","ph":"M","pid":)" << pid << R"(,"args":{"sort_index":)" << pid << "}}";
+        }
+        std::vector<int> pidOf(tracks_.size()), tidOf(tracks_.size());
+        std::map<cl_device_id, int> queuesOnDevice;
+        for (size_t t = 0; t < tracks_.size(); t++) {
+            pidOf[t] = (int)(std::find(devices.begin(), devices.end(), tracks_[t].device) - devices.begin()) + 1;
+            tidOf[t] = queuesOnDevice[tracks_[t].device]++;
+            sep() << R"({"name":"thread_name","ph":"M","pid":)" << pidOf[t] << R"(,"tid":)" << tidOf[t]
+                  << R"(,"args":{"name":"Queue )" << tidOf[t] << "\"}}";
+        }
+
+        // --- Host spans ---
+        for (auto& s : spans_) {
+            sep() << R"({"name":")" << escape(s.name) << R"(","cat":")" << s.category << R"(","ph":"X","pid":0,"tid":)"
+                  << s.thread << R"(,"ts":)" << us(s.beginNs) << R"(,"dur":)" << (s.endNs - s.beginNs) * 1.0e-3 << "}";
+        }
+
+        // --- Device commands, in start order per queue so idle gaps can be measured ---
+        std::vector<size_t> order;
+        for (size_t i = 0; i < commands_.size(); i++) {
+            if (commands_[i].valid) order.push_back(i);
+        }
+        std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            const Command& x = commands_[a];
+            const Command& y = commands_[b];
+            return x.track != y.track ? x.track < y.track : x.start < y.start;
+        });
+        int64_t prevEnd = 0;
+        int prevTrack = -1;
+        for (size_t n = 0; n < order.size(); n++) {
+            const Command& c = commands_[order[n]];
+            int64_t off = offset[tracks_[c.track].device];
+            double idle = c.track == prevTrack && (int64_t)c.start > prevEnd ? ((int64_t)c.start - prevEnd) * 1.0e-3 : 0.0;
+            if (c.track != prevTrack || (int64_t)c.end > prevEnd) prevEnd = (int64_t)c.end;
+            prevTrack = c.track;
+
+            int pid = pidOf[c.track], tid = tidOf[c.track];
+            sep() << R"({"name":")" << escape(c.name) << R"(","cat":")" << commandCategory(c.type)
+                  << R"(","ph":"X","pid":)" << pid << R"(,"tid":)" << tid << R"(,"ts":)" << us((int64_t)c.start + off)
+                  << R"(,"dur":)" << (c.end - c.start) * 1.0e-3 << R"(,"args":{"queued_to_submit_us":)"
+                  << (c.submit - c.queued) * 1.0e-3 << R"(,"submit_to_start_us":)" << (c.start - c.submit) * 1.0e-3
+                  << R"(,"idle_before_us":)" << idle << "}}";
+            if (c.start > c.queued) {
+                sep() << R"({"name":")" << escape(c.name) << R"(","cat":"pending","ph":"b","id":)" << n
+                      << R"(,"pid":)" << pid << R"(,"tid":)" << tid << R"(,"ts":)" << us((int64_t)c.queued + off) << "}";
+                sep() << R"({"name":")" << escape(c.name) << R"(","cat":"pending","ph":"e","id":)" << n
+                      << R"(,"pid":)" << pid << R"(,"tid":)" << tid << R"(,"ts":)" << us((int64_t)c.start + off) << "}";
+            }
+        }
+        out << "\n]}\n";
+
+        std::cerr << "Trace: " << order.size() << " commands, " << spans_.size() << " host spans -> " << path;
+        if (order.size() < commands_.size()) std::cerr << " (" << commands_.size() - order.size() << " commands without profiling data skipped)";
+        std::cerr << std::endl;
+        return true;
+    }
+
+private:
+    struct Track {
+        cl::CommandQueue queue;  // Held so the handle can't be reused by another queue
+        cl_device_id device;
+        std::string deviceName;
+    };
+
+    struct Command {
+        cl::Event event;  // Released once the timestamps have been read
+        std::string name;
+        int track = 0;
+        int64_t hostNs = 0;  // Host time just after the enqueue returned
+        cl_ulong queued = 0, submit = 0, start = 0, end = 0;
+        cl_command_type type = 0;
+        bool resolved = false, valid = false;
+    };
+
+    struct Span {
+        std::string name;
+        const char* category;
+        int thread;
+        int64_t beginNs, endNs;
+    };
+
+    int track(const cl::CommandQueue& queue) {
+        for (size_t t = 0; t < tracks_.size(); t++) {
+            if (tracks_[t].queue() == queue()) return (int)t;
+        }
+        cl::Device device = queue.getInfo<CL_QUEUE_DEVICE>();
+        tracks_.push_back({queue, device(), device.getInfo<CL_DEVICE_NAME>()});
+        return (int)tracks_.size() - 1;
+    }
+
+    static int threadIndex() {
+        static std::atomic<int> next{0};
+        thread_local int index = next++;
+        return index;
+    }
+
+    // Reads the timestamps of a finished command and drops the event; false while it's in flight
+    bool resolve(Command& c) {
+        if (c.resolved) return true;
+        cl_int status = c.event.getInfo<CL_EVENT_COMMAND_EXECUTION_STATUS>();
+        if (status > CL_COMPLETE) return false;
+        c.resolved = true;
+        if (status == CL_COMPLETE) {
+            cl_int err[4] = {};
+            c.queued = c.event.getProfilingInfo<CL_PROFILING_COMMAND_QUEUED>(&err[0]);
+            c.submit = c.event.getProfilingInfo<CL_PROFILING_COMMAND_SUBMIT>(&err[1]);
+            c.start = c.event.getProfilingInfo<CL_PROFILING_COMMAND_START>(&err[2]);
+            c.end = c.event.getProfilingInfo<CL_PROFILING_COMMAND_END>(&err[3]);
+            c.type = c.event.getInfo<CL_EVENT_COMMAND_TYPE>();
+            c.valid = err[0] == CL_SUCCESS && err[1] == CL_SUCCESS && err[2] == CL_SUCCESS && err[3] == CL_SUCCESS &&
+                      c.queued <= c.submit && c.submit <= c.start && c.start <= c.end;
+        }
+        c.event = cl::Event();
+        return true;
+    }
+
+    // Long runs would otherwise hold every event alive until exit
+    void sweep() {
+        size_t pending = 0;
+        for (auto& c : commands_) pending += !resolve(c);
+        sweepAt_ = commands_.size() + std::max<size_t>(4096, pending);
+    }
+
+    static const char* commandCategory(cl_command_type type) {
+        switch (type) {
+            case CL_COMMAND_NDRANGE_KERNEL: return "kernel";
+            case CL_COMMAND_WRITE_BUFFER:
+            case CL_COMMAND_WRITE_BUFFER_RECT: return "upload";
+            case CL_COMMAND_READ_BUFFER:
+            case CL_COMMAND_READ_BUFFER_RECT: return "download";
+            case CL_COMMAND_COPY_BUFFER:
+            case CL_COMMAND_COPY_BUFFER_RECT: return "copy";
+            case CL_COMMAND_FILL_BUFFER: return "fill";
+            case CL_COMMAND_MAP_BUFFER:
+            case CL_COMMAND_UNMAP_MEM_OBJECT:
+            case CL_COMMAND_SVM_MAP:
+            case CL_COMMAND_SVM_UNMAP: return "map";
+            default: return "command";
+        }
+    }
+
+    static std::string escape(const std::string& s) {
+        std::string out;
+        for (char c : s) {
+            if (c == '"' || c == '\\') out += '\\';
+            if ((unsigned char)c < 0x20) continue;
+            out += c;
+        }
+        return out;
+    }
+
+    std::mutex mutex_;
+    std::vector<Track> tracks_;
+    std::vector<Command> commands_;
+    std::vector<Span> spans_;
+    size_t sweepAt_ = 4096;
+    int threads_ = 0;  // Host threads that recorded a span
+};
+
+inline Tracer& tracer() {
+    static Tracer t;
+    return t;
+}
+
+// Records a command enqueued on 'queue' with 'event'. No-op (one branch) when tracing is off.
+inline void traceCommand(const cl::CommandQueue& queue, const cl::Event& event, const char* name) {
+    if (traceEnabled()) tracer().command(queue, event, name);
+}
+
+inline void traceCommand(const cl::CommandQueue& queue, const cl::Event& event, const std::string& name) {
+    if (traceEnabled()) tracer().command(queue, event, name.c_str());
+}
+
+// For code that holds only the event: its queue is looked up from the event
+inline void traceCommand(const cl::Event& event, const std::string& name) {
+    if (traceEnabled() && event()) tracer().command(event.getInfo<CL_EVENT_COMMAND_QUEUE>(), event, name.c_str());
+}
+
+// Event to pass to an enqueue from a helper whose caller may not want one: the caller's event
+// if given, otherwise a local one while tracing is on, so the command is recorded either way.
+class TraceEvent {
+public:
+    explicit TraceEvent(cl::Event* user) : user_(user) {}
+
+    cl::Event* get() { return user_ ? user_ : (traceEnabled() ? &local_ : nullptr); }
+
+    void record(const cl::CommandQueue& queue, const char* name) {
+        if (traceEnabled()) tracer().command(queue, *get(), name);
+    }
+
+private:
+    cl::Event* user_;
+    cl::Event local_;
+};
+
+// Host-side span from construction to destruction, on the calling thread's track
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, const char* category = "host") : on_(traceEnabled()) {
+        if (on_) begin(name, category);
+    }
+    explicit TraceSpan(const std::string& name, const char* category = "host") : on_(traceEnabled()) {
+        if (on_) begin(name.c_str(), category);
+    }
+
+    ~TraceSpan() {
+        if (on_) tracer().span(name_, category_, beginNs_, traceNowNs());
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    void begin(const char* name, const char* category) {
+        name_ = name;
+        category_ = category;
+        beginNs_ = traceNowNs();
+    }
+
+    bool on_;
+    std::string name_;
+    const char* category_ = "host";
+    int64_t beginNs_ = 0;
+};
+
+#endif
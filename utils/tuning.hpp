@@ -0,0 +1,275 @@
+// Kernel auto-tuning support: build-time parameter sets, a persisted per-device tuning database,
+// and the candidate/launch rules for the tiled matmul kernels.
+#ifndef TUNING_HPP
+#define TUNING_HPP
+
+#include "utils/cl_runtime.hpp"
+
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// One point in a kernel's tuning space: the -D macros it is built with and its work-group shape.
+struct TuneParams {
+    std::map<std::string, int> defines;
+    size_t localX = 0, localY = 0;
+    double gflops = 0.0;  // Measured by the tuner; 0 for untuned defaults
+
+    int get(const std::string& name, int fallback = 0) const {
+        auto it = defines.find(name);
+        return it == defines.end() ? fallback : it->second;
+    }
+};
+
+inline std::string buildOptions(const TuneParams& p, const std::string& base = "-cl-std=CL2.0") {
+    std::string opts = base;
+    for (auto& d : p.defines) opts += " -D" + d.first + "=" + std::to_string(d.second);
+    return opts;
+}
+
+// "TileSize=16;WPT=4" <-> defines. Semicolons keep the field CSV-safe.
+inline std::string encodeDefines(const std::map<std::string, int>& defines) {
+    std::string s;
+    for (auto& d : defines) s += (s.empty() ? "" : ";") + d.first + "=" + std::to_string(d.second);
+    return s;
+}
+
+inline std::map<std::string, int> decodeDefines(const std::string& s) {
+    std::map<std::string, int> defines;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ';')) {
+        size_t eq = item.find('=');
+        if (eq != std::string::npos) defines[item.substr(0, eq)] = std::stoi(item.substr(eq + 1));
+    }
+    return defines;
+}
+
+// Problem sizes are tuned per power-of-two bucket so one entry covers e.g. every K in (1024, 2048].
+inline int sizeBucket(int x) {
+    int b = 1;
+    while (b < x) b <<= 1;
+    return b;
+}
+
+inline size_t roundUp(size_t x, size_t multiple) {
+    return ((x + multiple - 1) / multiple) * multiple;
+}
+
+inline std::string tuningDBPath() {
+    const char* env = std::getenv("OCL_TUNING_DB");
+    return env ? std::string(env) : std::string("tuning_db.csv");
+}
+
+// Fastest known configuration per (device, kernel, M bucket, N bucket, K bucket), stored as CSV.
+class TuningDB {
+public:
+    struct Entry {
+        std::string device, kernel;
+        int mBucket, nBucket, kBucket;
+        TuneParams params;
+    };
+
+    explicit TuningDB(const std::string& path = tuningDBPath()) : path_(path) { load(); }
+
+    const std::string& path() const { return path_; }
+
+    // Exact bucket match if present, otherwise the nearest tuned bucket for this device and kernel.
+    bool lookup(const std::string& device, const std::string& kernel, int M, int N, int K, TuneParams& out) const {
+        int mb = sizeBucket(M), nb = sizeBucket(N), kb = sizeBucket(K);
+        const Entry* best = nullptr;
+        double bestDist = 0.0;
+        for (auto& e : entries_) {
+            if (e.device != device || e.kernel != kernel) continue;
+            double dist = std::fabs(std::log2((double)e.mBucket / mb)) +
+                          std::fabs(std::log2((double)e.nBucket / nb)) +
+                          std::fabs(std::log2((double)e.kBucket / kb));
+            if (!best || dist < bestDist) {
+                best = &e;
+                bestDist = dist;
+            }
+        }
+        if (best) out = best->params;
+        return best != nullptr;
+    }
+
+    // Keeps only the faster of the existing and new result for the bucket.
+    void record(const std::string& device, const std::string& kernel, int M, int N, int K, const TuneParams& params) {
+        int mb = sizeBucket(M), nb = sizeBucket(N), kb = sizeBucket(K);
+        for (auto& e : entries_) {
+            if (e.device == device && e.kernel == kernel && e.mBucket == mb && e.nBucket == nb && e.kBucket == kb) {
+                if (params.gflops > e.params.gflops) e.params = params;
+                return;
+            }
+        }
+        entries_.push_back({device, kernel, mb, nb, kb, params});
+    }
+
+    bool save() const {
+        std::ofstream file(path_);
+        if (!file.is_open()) return false;
+        file << "device,kernel,m_bucket,n_bucket,k_bucket,params,local_x,local_y,gflops\n";
+        for (auto& e : entries_) {
+            file << e.device << "," << e.kernel << "," << e.mBucket << "," << e.nBucket << "," << e.kBucket << ","
+                 << encodeDefines(e.params.defines) << "," << e.params.localX << "," << e.params.localY << ","
+                 << e.params.gflops << "\n";
+        }
+        return (bool)file;
+    }
+
+private:
+    void load() {
+        std::ifstream file(path_);
+        if (!file.is_open()) return;  // No database yet: every lookup falls back to defaults
+        std::string line;
+        std::getline(file, line);  // Header
+        while (std::getline(file, line)) {
+            std::vector<std::string> f;
+            std::stringstream ss(line);
+            std::string field;
+            while (std::getline(ss, field, ',')) f.push_back(field);
+            if (f.size() != 9) continue;
+            Entry e;
+            e.device = f[0];
+            e.kernel = f[1];
+            e.mBucket = std::stoi(f[2]);
+            e.nBucket = std::stoi(f[3]);
+            e.kBucket = std::stoi(f[4]);
+            e.params.defines = decodeDefines(f[5]);
+            e.params.localX = std::stoul(f[6]);
+            e.params.localY = std::stoul(f[7]);
+            e.params.gflops = std::stod(f[8]);
+            entries_.push_back(e);
+        }
+    }
+
+    std::string path_;
+    std::vector<Entry> entries_;
+};
+
+// --- Tiled MatMul Tuning Space ---
+// matmul.cl:          TileSize x TileSize work-group, two TileSize^2 float tiles in local memory.
+// register_matmul.cl: TileSize x TileSize work-group, TileSize^2 + TileSize^2 * WPT floats in local memory.
+// gemm.cl (gemm, gemm_nt): (TSN / WPTN) x (TSM / WPTM) work-group, each work-item a WPTM x WPTN register
+//                    tile; two ping-pong TSK x (TSM + 1) and TSK x (TSN + 1) float tiles in local memory.
+
+struct DeviceLimits {
+    size_t maxWGSize;
+    std::vector<size_t> maxItems;
+    cl_ulong localMem;
+};
+
+inline DeviceLimits queryLimits(const cl::Device& device) {
+    return {device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>(), device.getInfo<CL_DEVICE_MAX_WORK_ITEM_SIZES>(),
+            device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>()};
+}
+
+inline bool fitsDevice(const DeviceLimits& lim, size_t localX, size_t localY, size_t localBytes) {
+    return localX * localY <= lim.maxWGSize && localX <= lim.maxItems[0] && localY <= lim.maxItems[1] &&
+           localBytes <= lim.localMem;
+}
+
+inline bool isGemmKernel(const std::string& kernel) { return kernel == "gemm" || kernel == "gemm_nt"; }
+
+inline size_t matmulLocalBytes(const std::string& kernel, const TuneParams& p) {
+    if (isGemmKernel(kernel)) return sizeof(float) * 2 * p.get("TSK") * (p.get("TSM") + 1 + p.get("TSN") + 1);
+    size_t ts = p.get("TileSize");
+    if (kernel == "register_matmul") return sizeof(float) * ts * ts * (1 + p.get("WPT", 1));
+    return sizeof(float) * 2 * ts * ts;
+}
+
+inline TuneParams makeMatmulParams(const std::string& kernel, int tileSize, int wpt) {
+    TuneParams p;
+    p.defines["TileSize"] = tileSize;
+    if (kernel == "register_matmul") p.defines["WPT"] = wpt;
+    p.localX = tileSize;
+    p.localY = tileSize;
+    return p;
+}
+
+inline TuneParams makeGemmParams(int tsm, int tsn, int tsk, int wptm, int wptn) {
+    TuneParams p;
+    p.defines = {{"TSM", tsm}, {"TSN", tsn}, {"TSK", tsk}, {"WPTM", wptm}, {"WPTN", wptn}};
+    p.localX = tsn / wptn;
+    p.localY = tsm / wptm;
+    return p;
+}
+
+// Shape rules of gemm.cl: whole register tiles, whole float4 K-loads, and tile loads that
+// divide evenly over the work-group.
+inline bool gemmParamsValid(const TuneParams& p) {
+    int tsm = p.get("TSM"), tsn = p.get("TSN"), tsk = p.get("TSK"), wptm = p.get("WPTM"), wptn = p.get("WPTN");
+    if (!tsm || !tsn || !tsk || !wptm || !wptn || tsm % wptm || tsn % wptn || tsk % 4) return false;
+    int threads = (tsm / wptm) * (tsn / wptn);
+    return (tsm * tsk / 4) % threads == 0 && (tsn * tsk / 4) % threads == 0;
+}
+
+// Every configuration that fits the device's work-group and local-memory limits.
+inline std::vector<TuneParams> matmulCandidates(const std::string& kernel, const DeviceLimits& lim) {
+    std::vector<TuneParams> out;
+    if (isGemmKernel(kernel)) {
+        for (int ts : {32, 64, 128}) {
+            for (int tsk : {8, 16, 32}) {
+                for (auto [wptm, wptn] : {std::pair{4, 4}, {4, 8}, {8, 4}, {8, 8}}) {
+                    TuneParams p = makeGemmParams(ts, ts, tsk, wptm, wptn);
+                    if (gemmParamsValid(p) && fitsDevice(lim, p.localX, p.localY, matmulLocalBytes(kernel, p))) out.push_back(p);
+                }
+            }
+        }
+        return out;
+    }
+    std::vector<int> wpts = (kernel == "register_matmul") ? std::vector<int>{1, 2, 4, 8} : std::vector<int>{1};
+    for (int ts : {4, 8, 16, 32, 64}) {
+        for (int wpt : wpts) {
+            TuneParams p = makeMatmulParams(kernel, ts, wpt);
+            if (fitsDevice(lim, ts, ts, matmulLocalBytes(kernel, p))) out.push_back(p);
+        }
+    }
+    return out;
+}
+
+// The historical 16x16 / WPT=4 configuration, shrunk until it fits the device.
+// gemm: 64x64 block of 8x8 register tiles (an 8x8 work-group), halved until it fits.
+inline TuneParams matmulDefaults(const std::string& kernel, const DeviceLimits& lim) {
+    if (isGemmKernel(kernel)) {
+        TuneParams p = makeGemmParams(64, 64, 16, 8, 8);
+        for (int ts = 32; ts >= 8 && !fitsDevice(lim, p.localX, p.localY, matmulLocalBytes(kernel, p)); ts /= 2) {
+            p = makeGemmParams(ts, ts, 8, 4, 4);
+        }
+        return p;
+    }
+    int ts = 16, wpt = 4;
+    while (ts > 1 && !fitsDevice(lim, ts, ts, matmulLocalBytes(kernel, makeMatmulParams(kernel, ts, wpt)))) ts /= 2;
+    return makeMatmulParams(kernel, ts, wpt);
+}
+
+// Tuned parameters for this problem if the database has them, otherwise the defaults.
+inline TuneParams matmulParams(const TuningDB& db, const cl::Device& device, const std::string& kernel, int M, int N, int K) {
+    DeviceLimits lim = queryLimits(device);
+    TuneParams p;
+    if (db.lookup(deviceKey(device), kernel, M, N, K, p) &&
+        fitsDevice(lim, p.localX, p.localY, matmulLocalBytes(kernel, p)) && (!isGemmKernel(kernel) || gemmParamsValid(p))) {
+        return p;
+    }
+    return matmulDefaults(kernel, lim);
+}
+
+// Global size rounded up so partial edge tiles are still launched; the kernels bounds-check.
+inline cl::NDRange matmulGlobalSize(const std::string& kernel, const TuneParams& p, int M, int N) {
+    if (isGemmKernel(kernel)) {
+        size_t tsm = p.get("TSM"), tsn = p.get("TSN");
+        return cl::NDRange((N + tsn - 1) / tsn * p.localX, (M + tsm - 1) / tsm * p.localY);
+    }
+    size_t ts = p.get("TileSize");
+    if (kernel == "register_matmul") {
+        size_t groupsX = (N + ts * p.get("WPT", 1) - 1) / (ts * p.get("WPT", 1));
+        return cl::NDRange(groupsX * ts, roundUp(M, ts));
+    }
+    return cl::NDRange(roundUp(N, ts), roundUp(M, ts));
+}
+
+#endif
@@ -3,21 +3,20 @@
 #define UTILS_HPP
 
 #include <string>
-#include <fstream>
-#include <streambuf>
 #include <iostream>
 
-// Helper to load kernel file with basic error checking
+#include "utils/kernel_registry.hpp"
+
+// Kernel source by repo-relative path (either slash direction), file name or __kernel name.
+// Comes from the binary unless OCL_KERNEL_DIR overrides it (see utils/kernel_registry.hpp).
 inline std::string readKernelFile(const std::string& filename) {
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open kernel file at " << filename << std::endl;
-        std::cerr << "Check your relative paths!" << std::endl;
+    std::string source;
+    if (!findKernelSource(filename, source)) {
+        std::cerr << "Error: Kernel " << filename << " is not embedded and could not be opened" << std::endl;
+        std::cerr << "Re-run CMake after adding kernel files, or set OCL_KERNEL_DIR to the repo root" << std::endl;
         exit(1);
     }
-    
-    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return source;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,482 @@
+// Model weight container (.oclw) and its loader.
+//
+// File layout (little-endian):
+//   header   64 bytes : "OCLW", u32 version, u32 tensorCount, u32 metaCount, u32 alignment,
+//                       u32 reserved, u64 dataOffset, u64 fileBytes, zero padding
+//   metadata          : per entry u16 keyLen, key, f64 value (model hyperparameters)
+//   tensor table      : per entry u16 nameLen, name, u8 dtype, u8 ndim, u64 dims[ndim],
+//                       u64 offset (from the start of the file), u64 bytes
+//   data              : tensors in table order, each at an 'alignment' byte offset (default
+//                       kPageSize, so every tensor starts on a page of the mapping)
+//
+// MappedWeightFile maps the file copy-on-write and validates the table; tensor data is never copied
+// on the host. loadWeights() then creates one device buffer per tensor: on unified-memory devices
+// it wraps page-aligned tensors' mapped pages with CL_MEM_USE_HOST_PTR (zero-copy), otherwise it
+// streams them up in chunks, asking the OS to read the next chunk ahead while the current one is
+// being written.
+#ifndef WEIGHT_FILE_HPP
+#define WEIGHT_FILE_HPP
+
+#include "utils/cl_runtime.hpp"
+#include "utils/shared_buffer.hpp"
+#include "utils/trace.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+enum class DType : uint8_t { F32 = 0, F16 = 1, I32 = 2, U8 = 3 };
+
+inline size_t dtypeSize(DType t) {
+    switch (t) {
+        case DType::F32: return 4;
+        case DType::F16: return 2;
+        case DType::I32: return 4;
+        case DType::U8: return 1;
+    }
+    return 0;
+}
+
+inline const char* dtypeName(DType t) {
+    switch (t) {
+        case DType::F32: return "f32";
+        case DType::F16: return "f16";
+        case DType::I32: return "i32";
+        case DType::U8: return "u8";
+    }
+    return "?";
+}
+
+struct WeightTensor {
+    std::string name;
+    DType dtype = DType::F32;
+    std::vector<uint64_t> shape;
+    uint64_t offset = 0;  // From the start of the file
+    uint64_t bytes = 0;
+
+    uint64_t elements() const {
+        uint64_t n = 1;
+        for (uint64_t d : shape) n *= d;
+        return n;
+    }
+
+    std::string shapeString() const {
+        std::string s = "[";
+        for (size_t i = 0; i < shape.size(); i++) s += (i ? "x" : "") + std::to_string(shape[i]);
+        return s + "]";
+    }
+};
+
+constexpr uint32_t kWeightFileVersion = 1;
+constexpr size_t kWeightHeaderBytes = 64;
+
+// --- Writer ---
+
+class WeightFileWriter {
+public:
+    // Page alignment (the default) lets loadWeights map every tensor zero-copy; smaller values
+    // give a denser file whose unaligned tensors are streamed instead.
+    explicit WeightFileWriter(uint32_t alignment = kPageSize) : alignment_(alignment) {}
+
+    void setMeta(const std::string& key, double value) { meta_.push_back({key, value}); }
+
+    // 'data' must stay valid until write()
+    void addTensor(const std::string& name, DType dtype, std::vector<uint64_t> shape, const void* data) {
+        Pending p;
+        p.info.name = name;
+        p.info.dtype = dtype;
+        p.info.shape = std::move(shape);
+        p.info.bytes = p.info.elements() * dtypeSize(dtype);
+        p.data = data;
+        tensors_.push_back(std::move(p));
+    }
+
+    bool write(const std::string& path) {
+        // Table size first: it decides where the data section starts
+        size_t tableBytes = 0;
+        for (auto& m : meta_) tableBytes += 2 + m.first.size() + 8;
+        for (auto& t : tensors_) tableBytes += 2 + t.info.name.size() + 2 + 8 * t.info.shape.size() + 16;
+        uint64_t offset = alignUp(kWeightHeaderBytes + tableBytes);
+        uint64_t dataOffset = offset;
+        for (auto& t : tensors_) {
+            t.info.offset = offset;
+            offset = alignUp(offset + t.info.bytes);
+        }
+
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            std::cerr << "Error: could not write weight file " << path << std::endl;
+            return false;
+        }
+        std::vector<char> header(kWeightHeaderBytes, 0);
+        std::memcpy(header.data(), "OCLW", 4);
+        put32(header.data() + 4, kWeightFileVersion);
+        put32(header.data() + 8, (uint32_t)tensors_.size());
+        put32(header.data() + 12, (uint32_t)meta_.size());
+        put32(header.data() + 16, alignment_);
+        put64(header.data() + 24, dataOffset);
+        put64(header.data() + 32, offset);
+        out.write(header.data(), header.size());
+
+        std::string table;
+        for (auto& m : meta_) {
+            putString(table, m.first);
+            char v[8];
+            std::memcpy(v, &m.second, 8);
+            table.append(v, 8);
+        }
+        for (auto& t : tensors_) {
+            putString(table, t.info.name);
+            table += (char)t.info.dtype;
+            table += (char)t.info.shape.size();
+            for (uint64_t d : t.info.shape) append64(table, d);
+            append64(table, t.info.offset);
+            append64(table, t.info.bytes);
+        }
+        out.write(table.data(), table.size());
+
+        uint64_t pos = kWeightHeaderBytes + table.size();
+        std::vector<char> zeros(alignment_, 0);
+        for (auto& t : tensors_) {
+            out.write(zeros.data(), t.info.offset - pos);
+            out.write(static_cast<const char*>(t.data), t.info.bytes);
+            pos = t.info.offset + t.info.bytes;
+        }
+        out.write(zeros.data(), offset - pos);
+        if (!out) {
+            std::cerr << "Error: write failed for weight file " << path << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+private:
+    struct Pending {
+        WeightTensor info;
+        const void* data = nullptr;
+    };
+
+    uint64_t alignUp(uint64_t x) const { return (x + alignment_ - 1) / alignment_ * alignment_; }
+    static void put32(char* p, uint32_t v) { std::memcpy(p, &v, 4); }
+    static void put64(char* p, uint64_t v) { std::memcpy(p, &v, 8); }
+    static void append64(std::string& s, uint64_t v) {
+        char b[8];
+        put64(b, v);
+        s.append(b, 8);
+    }
+    static void putString(std::string& s, const std::string& str) {
+        uint16_t n = (uint16_t)str.size();
+        s.append(reinterpret_cast<const char*>(&n), 2);
+        s += str;
+    }
+
+    uint32_t alignment_;
+    std::vector<std::pair<std::string, double>> meta_;
+    std::vector<Pending> tensors_;
+};
+
+// --- Reader ---
+
+class MappedWeightFile {
+public:
+    MappedWeightFile() = default;
+    ~MappedWeightFile() { close(); }
+
+    MappedWeightFile(const MappedWeightFile&) = delete;
+    MappedWeightFile& operator=(const MappedWeightFile&) = delete;
+
+    // Maps 'path' and parses its table. On failure prints why and returns false.
+    bool open(const std::string& path) {
+        close();
+        path_ = path;
+#ifdef _WIN32
+        file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                            FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file_ == INVALID_HANDLE_VALUE) return fail("cannot open");
+        LARGE_INTEGER size;
+        GetFileSizeEx(file_, &size);
+        size_ = (size_t)size.QuadPart;
+        if (size_ < kWeightHeaderBytes) return fail("too small for a header");
+        // Copy-on-write view, for the same reason as the POSIX mapping below
+        mapping_ = CreateFileMappingA(file_, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+        if (!mapping_) return fail("CreateFileMapping failed");
+        data_ = static_cast<const char*>(MapViewOfFile(mapping_, FILE_MAP_COPY, 0, 0, 0));
+        if (!data_) return fail("MapViewOfFile failed");
+#else
+        fd_ = ::open(path.c_str(), O_RDONLY);
+        if (fd_ < 0) return fail("cannot open");
+        struct stat st;
+        if (fstat(fd_, &st) != 0) return fail("cannot stat");
+        size_ = (size_t)st.st_size;
+        if (size_ < kWeightHeaderBytes) return fail("too small for a header");
+        // Writable but private: a driver that wraps these pages with CL_MEM_USE_HOST_PTR may write
+        // its copy back on sync, even for a READ_ONLY buffer. That would fault on PROT_READ pages;
+        // with MAP_PRIVATE it only dirties a private page copy and the file is never modified.
+        void* p = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) return fail("mmap failed");
+        data_ = static_cast<const char*>(p);
+        madvise(p, size_, MADV_SEQUENTIAL);
+#endif
+        return parse();
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<char*>(data_), size_);
+        if (fd_ >= 0) ::close(fd_);
+        fd_ = -1;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        tensors_.clear();
+        meta_.clear();
+    }
+
+    const std::string& path() const { return path_; }
+    size_t fileBytes() const { return size_; }
+    uint32_t alignment() const { return alignment_; }
+    const std::vector<WeightTensor>& tensors() const { return tensors_; }
+
+    const WeightTensor* find(const std::string& name) const {
+        for (auto& t : tensors_) {
+            if (t.name == name) return &t;
+        }
+        return nullptr;
+    }
+
+    // Exits if the tensor is missing or doesn't have the expected element count
+    const WeightTensor& require(const std::string& name, uint64_t elements) const {
+        const WeightTensor* t = find(name);
+        if (!t || t->elements() != elements) {
+            std::cerr << "Error: " << path_ << ": tensor '" << name << "' "
+                      << (t ? "has " + std::to_string(t->elements()) + " elements, expected " + std::to_string(elements)
+                            : std::string("is missing"))
+                      << std::endl;
+            exit(1);
+        }
+        return *t;
+    }
+
+    const void* data(const WeightTensor& t) const { return data_ + t.offset; }
+
+    template <typename T>
+    const T* as(const WeightTensor& t) const { return reinterpret_cast<const T*>(data_ + t.offset); }
+
+    double meta(const std::string& key, double fallback) const {
+        auto it = meta_.find(key);
+        return it == meta_.end() ? fallback : it->second;
+    }
+    const std::map<std::string, double>& metadata() const { return meta_; }
+
+    // Hints the OS to start reading [offset, offset + bytes) in the background
+    void prefetch(uint64_t offset, uint64_t bytes) const {
+#ifndef _WIN32
+        const uint64_t page = 4096;
+        uint64_t begin = offset / page * page;
+        uint64_t end = std::min<uint64_t>(offset + bytes, size_);
+        if (end > begin) madvise(const_cast<char*>(data_) + begin, end - begin, MADV_WILLNEED);
+#else
+        (void)offset;
+        (void)bytes;
+#endif
+    }
+
+private:
+    bool fail(const char* why) {
+        std::cerr << "Error: weight file " << path_ << ": " << why << std::endl;
+        close();
+        return false;
+    }
+
+    bool parse() {
+        if (std::memcmp(data_, "OCLW", 4) != 0) return fail("bad magic (not an .oclw file)");
+        uint32_t version = get32(4), tensorCount = get32(8), metaCount = get32(12);
+        alignment_ = get32(16);
+        uint64_t dataOffset = get64(24), fileBytes = get64(32);
+        if (version != kWeightFileVersion) return fail("unsupported version");
+        if (fileBytes != size_ || dataOffset > size_ || dataOffset < kWeightHeaderBytes) return fail("truncated");
+        if (alignment_ == 0 || (alignment_ & (alignment_ - 1))) return fail("alignment is not a power of two");
+
+        size_t pos = kWeightHeaderBytes;
+        auto need = [&](size_t n) { return pos + n <= dataOffset; };
+        for (uint32_t i = 0; i < metaCount; i++) {
+            std::string key;
+            if (!readString(pos, dataOffset, key) || !need(8)) return fail("corrupt metadata");
+            double v;
+            std::memcpy(&v, data_ + pos, 8);
+            pos += 8;
+            meta_[key] = v;
+        }
+        for (uint32_t i = 0; i < tensorCount; i++) {
+            WeightTensor t;
+            if (!readString(pos, dataOffset, t.name) || !need(2)) return fail("corrupt tensor table");
+            uint8_t dtype = (uint8_t)data_[pos], ndim = (uint8_t)data_[pos + 1];
+            pos += 2;
+            if (dtype > (uint8_t)DType::U8 || !need(8 * (size_t)ndim + 16)) return fail("corrupt tensor table");
+            t.dtype = (DType)dtype;
+            for (int d = 0; d < ndim; d++, pos += 8) t.shape.push_back(get64(pos));
+            t.offset = get64(pos);
+            t.bytes = get64(pos + 8);
+            pos += 16;
+            // Written so no sum or product can wrap: a hostile table must not pass as in bounds
+            uint64_t elements = 1;
+            bool sizeOk = true;
+            for (uint64_t d : t.shape) {
+                if (d != 0 && elements > UINT64_MAX / d) sizeOk = false;
+                else elements *= d;
+            }
+            sizeOk = sizeOk && elements <= UINT64_MAX / dtypeSize(t.dtype) && t.bytes == elements * dtypeSize(t.dtype);
+            if (!sizeOk || t.offset % alignment_ || t.offset < dataOffset || t.offset > size_ || t.bytes > size_ - t.offset) {
+                std::cerr << "Error: weight file " << path_ << ": tensor '" << t.name << "' is out of bounds" << std::endl;
+                close();
+                return false;
+            }
+            tensors_.push_back(std::move(t));
+        }
+        return true;
+    }
+
+    bool readString(size_t& pos, size_t limit, std::string& out) const {
+        if (pos + 2 > limit) return false;
+        uint16_t n;
+        std::memcpy(&n, data_ + pos, 2);
+        if (pos + 2 + n > limit) return false;
+        out.assign(data_ + pos + 2, n);
+        pos += 2 + n;
+        return true;
+    }
+
+    uint32_t get32(size_t pos) const {
+        uint32_t v;
+        std::memcpy(&v, data_ + pos, 4);
+        return v;
+    }
+    uint64_t get64(size_t pos) const {
+        uint64_t v;
+        std::memcpy(&v, data_ + pos, 8);
+        return v;
+    }
+
+    std::string path_;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    uint32_t alignment_ = 64;
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#else
+    int fd_ = -1;
+#endif
+    std::vector<WeightTensor> tensors_;
+    std::map<std::string, double> meta_;
+};
+
+// --- Device Loader ---
+
+struct WeightLoadStats {
+    size_t bytes = 0;
+    int tensors = 0;
+    int zeroCopy = 0;       // Page-aligned tensors wrapped in place with CL_MEM_USE_HOST_PTR
+    double uploadMs = 0.0;  // Wall time to create / fill every buffer, including the final finish()
+
+    double gbs() const { return uploadMs > 0 ? bytes / (uploadMs * 1.0e6) : 0.0; }
+};
+
+// Device copies of every tensor in a mapped file. Holds the file open: zero-copy buffers alias
+// its pages.
+class DeviceWeights {
+public:
+    const cl::Buffer& operator[](const std::string& name) const {
+        auto it = buffers_.find(name);
+        if (it == buffers_.end()) {
+            std::cerr << "Error: tensor '" << name << "' was not loaded" << std::endl;
+            exit(1);
+        }
+        return it->second;
+    }
+
+    const WeightLoadStats& stats() const { return stats_; }
+    const MappedWeightFile& file() const { return *file_; }
+
+private:
+    friend DeviceWeights loadWeights(const cl::Context&, const cl::CommandQueue&, const cl::Device&,
+                                     std::shared_ptr<const MappedWeightFile>, size_t);
+
+    std::shared_ptr<const MappedWeightFile> file_;
+    std::map<std::string, cl::Buffer> buffers_;
+    WeightLoadStats stats_;
+};
+
+// Zero-copy when chooseBufferMode() picks a shared-memory mode for 'device' (OCL_BUFFER_MODE=copy
+// forces streaming). Otherwise each tensor gets its own device buffer, filled from the mapped file
+// in 'chunkBytes' pieces; the non-blocking writes read straight from the page cache.
+inline DeviceWeights loadWeights(const cl::Context& context, const cl::CommandQueue& queue, const cl::Device& device,
+                                 std::shared_ptr<const MappedWeightFile> file, size_t chunkBytes = 8u << 20) {
+    TraceSpan span("loadWeights", "load");
+    DeviceWeights w;
+    w.file_ = file;
+    bool zeroCopy = chooseBufferMode(device) != BufferMode::Copy;
+    auto t0 = std::chrono::steady_clock::now();
+
+    const auto& tensors = file->tensors();
+    for (size_t i = 0; i < tensors.size(); i++) {
+        const WeightTensor& t = tensors[i];
+        size_t bytes = std::max<size_t>(t.bytes, 1);
+        void* src = const_cast<void*>(file->data(t));
+        w.stats_.bytes += t.bytes;
+        w.stats_.tensors++;
+
+        // Drivers only skip the copy for page-aligned host pointers (see shared_buffer.hpp). An
+        // empty tensor has no pages of its own to wrap (its offset may be the end of the file), so
+        // it always gets the 1-byte placeholder below, with nothing to upload.
+        if (zeroCopy && t.bytes > 0 && reinterpret_cast<uintptr_t>(src) % kPageSize == 0) {
+            cl_int err = CL_SUCCESS;
+            cl::Buffer buf(context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, bytes, src, &err);
+            if (err == CL_SUCCESS) {
+                w.buffers_[t.name] = buf;
+                w.stats_.zeroCopy++;
+                continue;
+            }
+            // Fall through: this driver rejected the pointer, copy instead
+        }
+
+        cl::Buffer buf(context, CL_MEM_READ_ONLY, bytes);
+        for (uint64_t off = 0; off < t.bytes; off += chunkBytes) {
+            uint64_t n = std::min<uint64_t>(chunkBytes, t.bytes - off);
+            // Read-ahead for the next chunk (or the start of the next tensor) while this one copies
+            uint64_t next = off + n < t.bytes ? t.offset + off + n : (i + 1 < tensors.size() ? tensors[i + 1].offset : 0);
+            if (next) file->prefetch(next, chunkBytes);
+            TraceEvent te(nullptr);
+            queue.enqueueWriteBuffer(buf, CL_FALSE, off, n, static_cast<const char*>(src) + off, nullptr, te.get());
+            te.record(queue, t.name.c_str());
+        }
+        w.buffers_[t.name] = buf;
+    }
+    queue.finish();
+    w.stats_.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    return w;
+}
+
+#endif